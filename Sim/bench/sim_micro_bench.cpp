@@ -0,0 +1,66 @@
+/** Micro benchmarks for the Sim/ engine hot paths
+ *
+ * ns/op (median of --reps repetitions) for:
+ *   telemetry.log   — one CSV row
+ *   engine.tick     — solar → battery → bus ticks plus the telemetry row
+ *
+ * std::cout goes to a null buffer while timing (the subsystems print every tick, so the
+ * formatting cost stays in the number, the terminal does not); CSVs go to the temp dir.
+ *
+ * Run command:
+ *    ./sim_micro_bench [--json results.json] [--label <commit>] [--reps n] [--min-ms ms] [--filter text]
+ */
+
+#include "MicroBench.hpp"
+
+#include "SimulationEngine.hpp"
+#include "TelemetryLogger.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <streambuf>
+#include <string>
+
+namespace {
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c == EOF ? 0 : c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const microbench::Options opts = microbench::Options::parse(argc, argv);
+    namespace fs = std::filesystem;
+    const fs::path scratch = fs::temp_directory_path() / "spaceforge_sim_micro_bench";
+    fs::create_directories(scratch);
+
+    microbench::Suite suite("Sim", opts);
+    NullBuffer nullBuffer;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&nullBuffer);
+
+    {
+        TelemetryLogger logger((scratch / "telemetry_log.csv").string());
+        int tick = 0;
+        suite.run("telemetry.log", [&]() {
+            const double t = 0.1 * tick;
+            logger.log(tick, t, 500.0 - t, 200.0, 150.0 + t);
+            ++tick;
+        });
+    }
+
+    {
+        SimulationEngine engine((scratch / "telemetry_engine.csv").string());
+        engine.initialize();
+        engine.setTickStep(0.1);
+        suite.run("engine.tick", [&]() { engine.tick(); });
+        engine.shutdown();
+    }
+
+    std::cout.rdbuf(coutBuffer);
+    const bool ok = suite.finish();
+    fs::remove_all(scratch);
+    return ok ? 0 : 1;
+}
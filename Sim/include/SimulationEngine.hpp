@@ -1,8 +1,10 @@
 #pragma once
 #include "Subsystem.hpp"
 #include <vector>
+#include <string>
 #include "TickContext.hpp"
 #include "TelemetryLogger.hpp"
+#include "../../cpp_core/include/TickLatency.hpp"   // by path: cpp_core/include has its own PowerBus.hpp
 
 class Battery;
 class SolarArray;
@@ -10,14 +12,19 @@ class PowerBus;
 
 class SimulationEngine {
 public:
+    explicit SimulationEngine(const std::string& telemetryPath = "../../data/raw/telemetry.csv");
+
     void addSubsystem(Subsystem* subsystem);
     void initialize();
     void tick();
     void shutdown();
     void setTickStep(double dt);
 
+    // per-tick wall time (monotonic), split into subsystem phases; see TickLatency.hpp
+    const TickRecorder& tickLatency() const { return tick_latency_; }
+
 private:
-    TelemetryLogger logger_{"../../data/raw/telemetry.csv"};
+    TelemetryLogger logger_;
     std::vector<Subsystem*> subsystems_;
 
     Battery* battery_ = nullptr;
@@ -28,4 +35,6 @@ private:
     int tick_count_ = 0;
     double sim_time_ = 0.0;
     double tick_step_ = 0.1;
+
+    TickRecorder tick_latency_;
 };
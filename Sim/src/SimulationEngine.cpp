@@ -5,6 +5,8 @@
 #include "TelemetryLogger.hpp"
 #include <iostream>
 
+SimulationEngine::SimulationEngine(const std::string& telemetryPath) : logger_(telemetryPath) {}
+
 void SimulationEngine::addSubsystem(Subsystem* subsystem) {
     subsystems_.push_back(subsystem);
 }
@@ -27,6 +29,7 @@ void SimulationEngine::initialize() {
 }
 
 void SimulationEngine::tick() {
+    tick_latency_.beginTick(tick_count_);
     TickContext ctx {
         .tick_index = tick_count_,
         .time = sim_time_,
@@ -34,12 +37,18 @@ void SimulationEngine::tick() {
     };
 
     std::cout << "[Tick " << tick_count_ << "] t = " << sim_time_ << " s\n";
+    tick_latency_.mark("console");
     // Run all subsystem updates
     solar_->tick(ctx);     // generate
+    tick_latency_.mark("solar");
     battery_->tick(ctx);   // consume
+    tick_latency_.mark("battery");
     powerbus_->tick(ctx);  // reset
+    tick_latency_.mark("powerbus");
 
     logger_.log(tick_count_, sim_time_, battery_->getCharge(), solar_->getLastOutput(), powerbus_->getAvailablePower());
+    tick_latency_.mark("telemetry");   // a slow one here is the ofstream flushing its buffer
+    tick_latency_.endTick();
 
     // Advance sim time
     tick_count_++;
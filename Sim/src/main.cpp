@@ -2,6 +2,7 @@
 #include "Battery.hpp"
 #include "SolarArray.hpp"
 #include "PowerBus.hpp"
+#include <iostream>
 
 int main() {
     PowerBus bus;
@@ -21,5 +22,7 @@ int main() {
     for (int i = 0; i < 50; ++i)
     engine.tick(); 
 
+    engine.tickLatency().report(std::cout);
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,214 @@
+#ifndef MICRO_BENCH_HPP
+#define MICRO_BENCH_HPP
+
+/** Minimal micro-benchmark harness (header-only, shared by cpp_core/bench and Sim/bench)
+ *
+ * Each case is calibrated so one repetition runs for at least --min-ms, then repeated
+ * --reps times. ns/op is reported as median (the comparison number), mean, stddev, min
+ * and max over the repetitions, so a noisy machine shows up as spread instead of a bias.
+ *
+ * Common options:
+ *    --json <file>    also write the results as JSON ("-" for stdout)
+ *    --label <text>   stored in the JSON (e.g. the commit hash) for comparing runs
+ *    --reps <n>       repetitions per case (default 15)
+ *    --min-ms <ms>    minimum wall time per repetition (default 20)
+ *    --filter <text>  only run cases whose name contains <text>
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace microbench {
+
+/// Keeps the compiler from discarding a value whose only use is the benchmark.
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct Result {
+    std::string name;
+    std::uint64_t itersPerRep = 0;
+    int reps = 0;
+    double medianNs = 0.0, meanNs = 0.0, stddevNs = 0.0, minNs = 0.0, maxNs = 0.0;
+};
+
+struct Options {
+    std::string jsonPath;
+    std::string label;
+    std::string filter;
+    int reps = 15;
+    double minRepMs = 20.0;
+
+    /// Consumes the common options; anything else is left in `rest` for the caller.
+    static Options parse(int argc, char** argv, std::vector<std::string>* rest = nullptr) {
+        Options o;
+        for (int i = 1; i < argc; ++i) {
+            const std::string a = argv[i];
+            auto next = [&]() { return (i + 1 < argc) ? std::string(argv[++i]) : std::string(); };
+            if      (a == "--json")   o.jsonPath = next();
+            else if (a == "--label")  o.label = next();
+            else if (a == "--filter") o.filter = next();
+            else if (a == "--reps")   o.reps = std::max(1, std::stoi(next()));
+            else if (a == "--min-ms") o.minRepMs = std::stod(next());
+            else if (rest) rest->push_back(a);
+        }
+        return o;
+    }
+};
+
+class Suite {
+public:
+    /// The report goes to whatever std::cout writes to *now*, so callers may silence std::cout afterwards.
+    Suite(std::string name, Options opts)
+        : name_(std::move(name)), opts_(std::move(opts)), report_(std::cout.rdbuf()) {
+        report_ << std::setw(40) << std::left << "case" << std::right
+                << std::setw(12) << "median ns" << std::setw(10) << "mean"
+                << std::setw(10) << "stddev" << std::setw(10) << "min"
+                << std::setw(14) << "iters/rep" << "\n";
+    }
+
+    bool enabled(const std::string& caseName) const {
+        return opts_.filter.empty() || caseName.find(opts_.filter) != std::string::npos;
+    }
+
+    /**
+     * @brief Times `op()` (one operation per call).
+     *
+     * State that drifts with repetition (a draining battery, a finishing task) is reset
+     * inside `op` itself; that reset is part of the measured cost and kept cheap.
+     */
+    template <typename Op>
+    void run(const std::string& caseName, Op&& op) {
+        if (!enabled(caseName)) return;
+
+        // calibrate: double the batch until one batch takes minRepMs
+        std::uint64_t iters = 1;
+        for (;;) {
+            const double ms = timeBatch(op, iters) * 1e-6;
+            if (ms >= opts_.minRepMs || iters >= (1ull << 40)) break;
+            const double scale = ms > 0.0 ? opts_.minRepMs / ms : 16.0;
+            iters = std::max<std::uint64_t>(iters * 2, static_cast<std::uint64_t>(iters * std::min(scale * 1.2, 16.0)));
+        }
+
+        std::vector<double> samples(opts_.reps);
+        for (double& s : samples) s = timeBatch(op, iters) / static_cast<double>(iters);
+        record(caseName, iters, samples);
+    }
+
+    const std::vector<Result>& results() const { return results_; }
+
+    /// Writes --json if requested; returns false if the file could not be opened.
+    bool finish() {
+        if (opts_.jsonPath.empty()) return true;
+        if (opts_.jsonPath == "-") { writeJson(report_); return true; }
+        std::ofstream out(opts_.jsonPath);
+        if (!out.is_open()) {
+            std::cerr << "Error opening JSON output: " << opts_.jsonPath << "\n";
+            return false;
+        }
+        writeJson(out);
+        report_ << "Wrote " << opts_.jsonPath << "\n";
+        return true;
+    }
+
+    void writeJson(std::ostream& out) const {
+        out << "{\n"
+            << "  \"suite\": \"" << escape(name_) << "\",\n"
+            << "  \"label\": \"" << escape(opts_.label) << "\",\n"
+            << "  \"timestamp\": " << static_cast<long long>(std::time(nullptr)) << ",\n"
+            << "  \"compiler\": \"" << escape(compiler()) << "\",\n"
+#ifdef NDEBUG
+            << "  \"assertions\": false,\n"
+#else
+            << "  \"assertions\": true,\n"
+#endif
+            << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+            << "  \"reps\": " << opts_.reps << ",\n"
+            << "  \"min_rep_ms\": " << opts_.minRepMs << ",\n"
+            << "  \"results\": [\n";
+        for (std::size_t i = 0; i < results_.size(); ++i) {
+            const Result& r = results_[i];
+            out << std::setprecision(6)
+                << "    {\"name\": \"" << escape(r.name) << "\", \"unit\": \"ns/op\""
+                << ", \"median\": " << r.medianNs << ", \"mean\": " << r.meanNs
+                << ", \"stddev\": " << r.stddevNs << ", \"min\": " << r.minNs << ", \"max\": " << r.maxNs
+                << ", \"iters_per_rep\": " << r.itersPerRep << ", \"reps\": " << r.reps << "}"
+                << (i + 1 < results_.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+    }
+
+private:
+    template <typename Op>
+    static double timeBatch(Op& op, std::uint64_t iters) {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (std::uint64_t i = 0; i < iters; ++i) op();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    void record(const std::string& caseName, std::uint64_t iters, std::vector<double> samples) {
+        Result r;
+        r.name = caseName;
+        r.itersPerRep = iters;
+        r.reps = static_cast<int>(samples.size());
+        std::sort(samples.begin(), samples.end());
+        const std::size_t n = samples.size();
+        r.medianNs = (n % 2) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+        r.minNs = samples.front();
+        r.maxNs = samples.back();
+        for (double s : samples) r.meanNs += s;
+        r.meanNs /= static_cast<double>(n);
+        for (double s : samples) r.stddevNs += (s - r.meanNs) * (s - r.meanNs);
+        r.stddevNs = n > 1 ? std::sqrt(r.stddevNs / static_cast<double>(n - 1)) : 0.0;
+
+        report_ << std::setw(40) << std::left << r.name << std::right << std::fixed << std::setprecision(1)
+                << std::setw(12) << r.medianNs << std::setw(10) << r.meanNs
+                << std::setw(10) << r.stddevNs << std::setw(10) << r.minNs
+                << std::setw(14) << r.itersPerRep << "\n";
+        report_.unsetf(std::ios::fixed);
+        results_.push_back(r);
+    }
+
+    static std::string escape(const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+    static std::string compiler() {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#else
+        return "unknown";
+#endif
+    }
+
+    std::string name_;
+    Options opts_;
+    std::vector<Result> results_;
+    std::ostream report_;
+};
+
+}  // namespace microbench
+
+#endif  // MICRO_BENCH_HPP
@@ -0,0 +1,118 @@
+/** Span-level defect sampling: equivalence + speed
+ *
+ * Draws the time to first defect of one phase N times with
+ *   (a) a Bernoulli draw per minute   — the old runOneMinute model
+ *   (b) DefectSampler::firstDefect    — one geometric / exponential draw per span
+ * and compares the two distributions (two-sample χ² over minute bins + a "no defect" bin,
+ * and the Kolmogorov–Smirnov distance), plus ns per simulated phase for both.
+ *
+ * A pass means χ²/dof ≈ 1 and KS D below the 1% critical value 1.63·sqrt(2/N).
+ *
+ * Run command:
+ *    ./defect_bench [trials]
+ */
+
+#include "DefectModel.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// hazard that doubles in eclipse, like a wafer exposed while the heaters sag
+class EclipseHazard : public DefectHazard {
+public:
+    explicit EclipseHazard(double p) : p_(p) {}
+    double probability(int minute) const override { return (minute % 90 < 45) ? p_ : 2.0 * p_; }
+
+private:
+    double p_;
+};
+
+struct Case {
+    std::string name;
+    int span;
+    const DefectHazard* hazard;
+};
+
+struct Result {
+    std::vector<std::uint64_t> bins;   // [0, span) first-defect minute, [span] no defect
+    double nsPerPhase = 0.0;
+};
+
+template <typename Draw>
+Result run(int span, std::uint64_t trials, Draw draw) {
+    Result r;
+    r.bins.assign(span + 1, 0);
+    const auto t0 = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < trials; ++i) {
+        const int k = draw();
+        r.bins[k == DefectSampler::NO_DEFECT ? span : k]++;
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    r.nsPerPhase = ns / static_cast<double>(trials);
+    return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const std::uint64_t trials = argc > 1 ? std::stoull(argv[1]) : 1'000'000;
+
+    // defectChance values loadTasksFromFile assigns to each phase
+    const ConstantHazard depo(0.010), ion(0.001), crystal(0.025);
+    const EclipseHazard eclipse(0.010);
+    const Case cases[] = {
+        {"deposition p=0.010", 60,  &depo},
+        {"ion        p=0.001", 20,  &ion},
+        {"crystal    p=0.025", 120, &crystal},
+        {"eclipse-varying",    120, &eclipse},
+    };
+
+    std::cout << std::fixed
+              << std::setw(20) << "case" << std::setw(12) << "ns/minute" << std::setw(12) << "ns/span"
+              << std::setw(10) << "speedup" << std::setw(12) << "chi2/dof" << std::setw(10) << "KS D"
+              << std::setw(10) << "KS crit" << std::setw(7) << "ok" << "\n";
+
+    bool allOk = true;
+    for (const Case& c : cases) {
+        DefectSampler perMinute(11), perSpan(29);
+        const int start = 30;   // starts 15 min before eclipse, so the varying case crosses it
+
+        const Result a = run(c.span, trials, [&]() {
+            for (int k = 0; k < c.span; ++k)
+                if (perMinute.drawMinute(c.hazard->probability(start + k))) return k;
+            return DefectSampler::NO_DEFECT;
+        });
+        const Result b = run(c.span, trials, [&]() { return perSpan.firstDefect(start, c.span, *c.hazard); });
+
+        // two-sample χ² over non-empty bins, and KS on the CDFs
+        double chi2 = 0.0, d = 0.0, ca = 0.0, cb = 0.0;
+        int dof = -1;
+        for (int k = 0; k <= c.span; ++k) {
+            const double x = static_cast<double>(a.bins[k]), y = static_cast<double>(b.bins[k]);
+            if (x + y > 0.0) { chi2 += (x - y) * (x - y) / (x + y); ++dof; }
+            ca += x; cb += y;
+            d = std::max(d, std::fabs(ca - cb) / static_cast<double>(trials));
+        }
+        const double crit = 1.63 * std::sqrt(2.0 / static_cast<double>(trials));
+        const double chi2PerDof = dof > 0 ? chi2 / dof : 0.0;
+        const bool ok = d < crit && chi2PerDof < 1.5;
+        allOk = allOk && ok;
+
+        std::cout << std::setw(20) << c.name
+                  << std::setw(12) << std::setprecision(1) << a.nsPerPhase
+                  << std::setw(12) << b.nsPerPhase
+                  << std::setw(9)  << a.nsPerPhase / b.nsPerPhase << "x"
+                  << std::setw(12) << std::setprecision(3) << chi2PerDof
+                  << std::setw(10) << std::setprecision(5) << d
+                  << std::setw(10) << crit
+                  << std::setw(7)  << (ok ? "yes" : "NO") << "\n";
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,345 @@
+/** Micro benchmarks for the per-minute hot paths of the deposition simulator
+ *
+ * ns/op (median of --reps repetitions) for:
+ *   power.update / power.canSatisfyDemand / power.consumePower
+ *   faults.advance/idle    — 64 scheduled faults, none due: what main pays every minute between events
+ *   faults.advance/event   — a panel string that fails and is repaired every other minute (one event per op)
+ *   deposition.update      — one chamber, one wafer that never finishes, power refilled each op
+ *   deposition.update/journal — the same, recording to a journal (turns + a checkpoint per op)
+ *   logger.log             — one CSV row into a scratch file
+ *   orbit.getPhase
+ *   plan.earliestWindow    — one-week calendar, 8 chambers, 2 000 bookings; any chamber, 30 min at 150 W
+ *   plan.reserve+cancel    — book and free a window in the same calendar
+ *   plan.repair / plan.replan — one minute of a 200-wafer, 4-chamber plan that the chambers follow,
+ *                            but chamber 0 runs 7 min late on every carrier: local repair vs full replan
+ *                            (most minutes need no repair; this is the per-minute cost a run pays)
+ *   plan.repair/late       — the same plan; the earliest planned wafer misses its start, so every op
+ *                            is a real repair (the plan is rebuilt when the week runs out of wafers)
+ *   plan.replan/full       — the same plan, every waiting window cancelled and booked again
+ *   tick.handshake/<n>     — TickBarrier publish → n workers wake and arrive → main resumes
+ *
+ * Module output (std::cout, debugLogs/) is kept, but redirected: std::cout goes to a null
+ * buffer (formatting is still paid) and files go to a scratch directory under the temp dir.
+ *
+ * Run command:
+ *    ./micro_bench [--json results.json] [--label <commit>] [--reps n] [--min-ms ms] [--filter text]
+ */
+
+#include "MicroBench.hpp"
+
+#include "DepositionModule.hpp"
+#include "FaultInjector.hpp"
+#include "Journal.hpp"
+#include "Logger.hpp"
+#include "OrbitModel.hpp"
+#include "Planner.hpp"
+#include "PowerBus.hpp"
+#include "ReservationCalendar.hpp"
+#include "Task.hpp"
+#include "TickBarrier.hpp"
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// swallows everything written to it (keeps std::cout formatting cost, drops the terminal I/O)
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c == EOF ? 0 : c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+constexpr int DEPO_CALIBRATION_MINUTES = 3;   // as main.cpp with SPACEFORGE_CHAMBER_TIMING=3,5
+constexpr int DEPO_COOLDOWN_MINUTES    = 5;
+
+const std::string SUNLIGHT = "sunlight";
+const std::string ECLIPSE  = "eclipse";
+
+const std::string& phaseOf(int t) { return (t % 90 < 45) ? SUNLIGHT : ECLIPSE; }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    microbench::Options opts = microbench::Options::parse(argc, argv);
+
+    // scratch dir: runOneMinute appends to debugLogs/ relative to the working directory
+    namespace fs = std::filesystem;
+    const fs::path scratch = fs::temp_directory_path() / "spaceforge_micro_bench";
+    fs::create_directories(scratch / "debugLogs");
+    if (!opts.jsonPath.empty() && opts.jsonPath != "-") opts.jsonPath = fs::absolute(opts.jsonPath).string();
+    fs::current_path(scratch);
+
+    microbench::Suite suite("cpp_core", opts);
+    NullBuffer nullBuffer;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&nullBuffer);
+
+    /* ---------- PowerModule ---------- */
+    {
+        PowerModule power(250000, 300, 0);
+        int t = 0;
+        suite.run("power.update", [&]() {
+            power.update(t, phaseOf(t));
+            ++t;
+            microbench::doNotOptimize(power);
+        });
+
+        power.update(0, SUNLIGHT);
+        volatile int demand = 300;   // opaque, so the check is not hoisted out of the loop
+        suite.run("power.canSatisfyDemand", [&]() {
+            microbench::doNotOptimize(power.canSatisfyDemand(demand));
+        });
+
+        int k = 0;
+        suite.run("power.consumePower", [&]() {
+            power.consumePower(demand);
+            if ((++k & 1023) == 0) power.update(0, SUNLIGHT);   // keep the budget from wrapping
+            microbench::doNotOptimize(power);
+        });
+    }
+
+    /* ---------- FaultInjector ---------- */
+    {
+        PowerModule power(250000, 300, 0);
+        std::vector<faults::FaultSpec> scheduled(64);
+        for (std::size_t i = 0; i < scheduled.size(); ++i) {
+            scheduled[i].target = static_cast<int>(i % 8);
+            scheduled[i].at = (1 << 20) + static_cast<int>(i);   // never reached: t wraps at 1024
+            scheduled[i].repair = 30;
+        }
+        faults::FaultInjector idle(scheduled, 1);
+        int k = 0;
+        suite.run("faults.advance/idle", [&]() {
+            idle.advance(k++ & 1023);
+            microbench::doNotOptimize(idle);
+        });
+
+        faults::FaultSpec panel;
+        panel.kind = faults::FaultKind::Panel;
+        panel.mtbf = 1.0;
+        panel.repair = 1.0;
+        faults::FaultInjector busy({panel}, 1);
+        busy.attachPower(&power);
+        int t = 0;
+        suite.run("faults.advance/event", [&]() {
+            busy.advance(t);
+            t = busy.nextEventAt();
+            microbench::doNotOptimize(power);
+        });
+    }
+
+    /* ---------- DepositionModule ---------- */
+    {
+        PowerModule power(250000, 300, 0);
+        Logger logger((scratch / "deposition_log.csv").string());
+        ProfiledMutex powerMutex("power_mutex");
+        std::atomic<int> orbitState(0);
+
+        Task wafer;
+        wafer.id = "bench";
+        wafer.phase[0].requiredTime = INT_MAX / 2;   // stays on the chamber for the whole run
+        wafer.phase[0].defectChance = 0.01;
+
+        DepositionModule chamber;
+        chamber.seedDefects(1);
+        chamber.enqueue(&wafer);
+        int t = 0;
+        chamber.update(t++, power, logger, &powerMutex, &orbitState);   // loads the carrier
+
+        suite.run("deposition.update", [&]() {
+            power.update(0, SUNLIGHT);   // refill the budget; see power.update for its share
+            chamber.update(t++, power, logger, &powerMutex, &orbitState);
+            if (wafer.phase[0].elapsedTime > INT_MAX / 4) wafer.phase[0].elapsedTime = 0;
+        });
+    }
+
+    /* ---------- DepositionModule, journal recording on ---------- */
+    if (suite.enabled("deposition.update/journal")) {
+        PowerModule power(250000, 300, 0);
+        Logger logger((scratch / "deposition_journal_log.csv").string());
+        ProfiledMutex powerMutex("power_mutex");
+        std::atomic<int> orbitState(0);
+
+        journal::Journal journal;
+        journal.startRecording((scratch / "bench.sfj").string(), journal::RunInputs{});
+        journal::Checkpoint checkpoint;
+        checkpoint.rngDraws.resize(1);
+
+        Task wafer;
+        wafer.id = "bench";
+        wafer.phase[0].requiredTime = INT_MAX / 2;
+        wafer.phase[0].defectChance = 0.01;
+
+        DepositionModule chamber;
+        chamber.seedDefects(1);
+        chamber.attachJournal(&journal);
+        chamber.enqueue(&wafer);
+        int t = 0;
+        chamber.update(t++, power, logger, &powerMutex, &orbitState);
+
+        suite.run("deposition.update/journal", [&]() {
+            power.update(0, SUNLIGHT);
+            chamber.update(t, power, logger, &powerMutex, &orbitState);
+            checkpoint.rngDraws[0] = chamber.defectDraws();
+            journal.endMinute(t++, checkpoint);
+            if (wafer.phase[0].elapsedTime > INT_MAX / 4) wafer.phase[0].elapsedTime = 0;
+        });
+    }
+
+    /* ---------- Logger ---------- */
+    {
+        Logger logger((scratch / "logger_bench.csv").string());
+        const std::string module = "Deposition", taskId = "W42", action = "run";
+        int t = 0;
+        suite.run("logger.log", [&]() {
+            logger.log(t, module, taskId, 0, true, false, 0, t % 60, 60, 300 * (t % 60),
+                       200, 300, false, false, phaseOf(t), action, 0.0f);
+            ++t;
+        });
+    }
+
+    /* ---------- OrbitModel ---------- */
+    {
+        OrbitModel orbit;
+        int t = 0;
+        suite.run("orbit.getPhase", [&]() {
+            microbench::doNotOptimize(orbit.getPhase(t++));
+        });
+    }
+
+    /* ---------- ReservationCalendar (one week, 2 000 bookings) ---------- */
+    {
+        constexpr int WEEK = 7 * 1440;
+        plan::ReservationCalendar calendar(8, plan::orbitPowerProfile(WEEK));
+        std::uint32_t lcg = 12345;   // scattered 10-minute, 100 W bookings
+        while (calendar.active() < 2000) {
+            lcg = lcg * 1103515245u + 12345u;
+            calendar.reserve(static_cast<int>((lcg >> 4) % 8), static_cast<int>((lcg >> 8) % WEEK), 10, 100);
+        }
+        int from = 0;
+        suite.run("plan.earliestWindow", [&]() {
+            int chamber = 0;
+            microbench::doNotOptimize(calendar.earliestWindowAny(from, 30, 150, chamber));
+            from = (from + 61) % WEEK;
+        });
+        suite.run("plan.reserve+cancel", [&]() {
+            int chamber = 0;
+            const int start = calendar.earliestWindowAny(from, 30, 150, chamber);
+            if (start >= 0) calendar.cancel(calendar.reserve(chamber, start, 30, 150));
+            from = (from + 61) % WEEK;
+        });
+    }
+
+    /* ---------- Planner (SPACEFORGE_PLAN) ---------- */
+    std::vector<std::unique_ptr<Task>> planWafers;
+    std::vector<Task*> planned;
+    for (int i = 0; i < 200; ++i) {
+        planWafers.push_back(std::make_unique<Task>());
+        planWafers.back()->id = "W" + std::to_string(i);
+        planWafers.back()->phase[0].requiredTime = 60;
+        planned.push_back(planWafers.back().get());
+    }
+    plan::Planner::Config planConfig;
+    planConfig.setupMinutes = DEPO_CALIBRATION_MINUTES;
+    planConfig.cooldownMinutes = DEPO_COOLDOWN_MINUTES;
+
+    for (const bool alwaysReplan : {false, true}) {
+        const std::string caseName = alwaysReplan ? "plan.replan" : "plan.repair";
+        if (!suite.enabled(caseName)) continue;
+
+        plan::Planner::Config config = planConfig;
+        config.alwaysReplan = alwaysReplan;
+        plan::Planner planner(4, plan::orbitPowerProfile(7 * 1440), config);
+        planner.build(planned);
+
+        // chambers follow the plan, but chamber 0 loses PLAN_SLIP minutes on every carrier
+        constexpr int PLAN_SLIP = 7;
+        struct Chamber { Task* wafer = nullptr; int unload = 0; int until = 0; };
+        std::vector<Chamber> chambers(4);
+        int t = 0;
+        suite.run(caseName, [&]() {
+            bool busy = false;
+            for (int c = 0; c < 4; ++c) {
+                Chamber& ch = chambers[static_cast<std::size_t>(c)];
+                if (ch.wafer && t >= ch.unload) {
+                    planner.finished(ch.wafer, t);
+                    ch.wafer = nullptr;
+                }
+                int start = 0;
+                Task* next = planner.nextFor(c, start);
+                if (!ch.wafer && t >= ch.until && next && start <= t) {
+                    planner.started(next, c);
+                    ch.wafer = next;
+                    ch.unload = t + DEPO_CALIBRATION_MINUTES + next->phase[0].requiredTime + (c == 0 ? PLAN_SLIP : 0);
+                    ch.until = ch.unload + DEPO_COOLDOWN_MINUTES;
+                }
+                planner.pin(c, t + 1, ch.unload, ch.until, ch.wafer ? DepositionModule::REQUIRED_POWER : 0);
+                busy = busy || ch.wafer || next;
+            }
+            microbench::doNotOptimize(planner.repair(t + 1));
+            if (++t < 7 * 1440 && busy) return;
+            planner.build(planned);   // every wafer through (or a week gone): plan the campaign again
+            chambers.assign(4, Chamber());
+            t = 0;
+        });
+    }
+    if (suite.enabled("plan.repair/late")) {
+        plan::Planner planner(4, plan::orbitPowerProfile(7 * 1440), planConfig);
+        planner.build(planned);
+        suite.run("plan.repair/late", [&]() {
+            int first = INT_MAX;
+            for (int c = 0; c < 4; ++c) {
+                int start = 0;
+                if (planner.nextFor(c, start)) first = std::min(first, start);
+            }
+            if (first == INT_MAX) {
+                planner.build(planned);   // every window pushed past the week
+                return;
+            }
+            microbench::doNotOptimize(planner.repair(first + 1));
+        });
+    }
+    if (suite.enabled("plan.replan/full")) {
+        plan::Planner planner(4, plan::orbitPowerProfile(7 * 1440), planConfig);
+        planner.build(planned);
+        suite.run("plan.replan/full", [&]() {
+            planner.replan(1);
+            microbench::doNotOptimize(planner.planned());
+        });
+    }
+
+    /* ---------- TickBarrier (main.cpp minute handshake) ---------- */
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    for (int workers = 1; workers <= static_cast<int>(hw) && workers <= 8; workers *= 2) {
+        const std::string caseName = "tick.handshake/" + std::to_string(workers);
+        if (!suite.enabled(caseName)) continue;
+
+        TickBarrier barrier(workers);
+        std::vector<std::thread> threads;
+        for (int w = 0; w < workers; ++w) {
+            threads.emplace_back([&barrier]() {
+                int seen = 0;
+                while (barrier.waitForTick(seen)) barrier.arrive();
+            });
+        }
+        suite.run(caseName, [&]() {
+            barrier.publish();
+            barrier.waitAll();
+        });
+        barrier.stop();
+        for (auto& th : threads) th.join();
+    }
+
+    std::cout.rdbuf(coutBuffer);
+    const bool ok = suite.finish();
+    fs::remove_all(scratch);
+    return ok ? 0 : 1;
+}
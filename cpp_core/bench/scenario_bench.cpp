@@ -0,0 +1,428 @@
+/** Macro scenario benchmarks: whole deposition runs at the operating points we fly
+ *
+ *   day       — the current main.cpp run: 10 wafers, 1 chamber, 1440 minutes
+ *   year      — 365-day mission, 1 chamber, wafers always queued
+ *   campaign  — 10^6 wafers, 8 chambers with 4-wafer carriers on a fleet-sized bus
+ *   ensemble  — 256 independent day runs spread over a worker pool
+ *   faulted   — the ensemble under stochastic faults (FaultInjector.hpp): chamber outages, battery
+ *               trips, lost panel strings and cells; wafers finished next to `ensemble` is the robustness
+ *
+ * Every run uses the production loop (one thread per chamber, TickBarrier handshake,
+ * Logger CSV, runOneMinute debug log) without main.cpp's 10 ms pacing sleep.
+ * Each (scenario, cores) point runs in a forked child pinned to the first `cores` CPUs,
+ * so the reported peak RSS and bytes logged belong to that point alone:
+ *   wall s | simulated minutes / s | peak RSS | bytes logged | wafers finished | yield | cycle p99
+ * Yield and cycle time come from per-chamber YieldAnalytics sketches, merged per run and,
+ * for the ensemble, across members through their serialized form (as MPI ranks would).
+ * The ensemble uses `cores` pool threads; the others keep their chamber threads.
+ *
+ * --scale shrinks wafers, minutes and members (e.g. 0.01 for a quick check); at scale 1
+ * the campaign runs for minutes, not seconds.
+ *
+ * Run command:
+ *    ./scenario_bench [--scenario day|year|campaign|ensemble|faulted|all] [--cores 1,2,4] [--scale 1.0]
+ *                     [--json results.json] [--label <commit>]
+ */
+
+#include "DepositionModule.hpp"
+#include "FaultInjector.hpp"
+#include "Logger.hpp"
+#include "PowerBus.hpp"
+#include "StageQueue.hpp"
+#include "Task.hpp"
+#include "TickBarrier.hpp"
+#include "WaferMap.hpp"
+#include "WakeTracer.hpp"
+#include "YieldAnalytics.hpp"
+
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const int DEPO_CALIBRATION_MINUTES = 0;   // same chamber timing as main.cpp (SPACEFORGE_CHAMBER_TIMING unset)
+const int DEPO_COOLDOWN_MINUTES    = 0;
+
+struct Scenario {
+    std::string name;
+    long long wafers;      // queued at minute 0
+    long long minutes;     // simulated minutes (a cap when untilDone)
+    int chambers;
+    int carrier;
+    int maxBatchWait;
+    int members;           // > 1 ⇒ ensemble of independent runs
+    bool fleetPower;       // size the solar array to the chambers (otherwise main.cpp's 300 W bus)
+    bool untilDone;        // end as soon as every wafer is through (main.cpp always runs the full day)
+    bool faults;           // inject faultMix() (each member draws its own failures)
+};
+
+// what a child reports back through the pipe
+struct ChildResult {
+    double wallSec = 0.0;
+    long long simMinutes = 0;   // summed over ensemble members
+    long long wafers = 0;
+    long long wafersQueued = 0;
+    double yieldPct = 0.0;      // merged over chambers (and members)
+    double cycleP99 = 0.0;      // minutes from queued to unloaded
+};
+
+struct Row {
+    std::string scenario;
+    int cores = 0;
+    ChildResult run;
+    long peakRssKb = 0;
+    std::uintmax_t bytesLogged = 0;
+};
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c == EOF ? 0 : c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+std::vector<int> parseList(const std::string& s) {
+    std::vector<int> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) out.push_back(std::stoi(item));
+    return out;
+}
+
+long long scaled(long long v, double scale) {
+    return std::max(1LL, static_cast<long long>(std::llround(static_cast<double>(v) * scale)));
+}
+
+std::vector<Scenario> scenarios(double scale) {
+    return {
+        {"day",      10,                       1440,                       1, 1, 0,  1,   false, false, false},
+        {"year",     scaled(365 * 24, scale),  scaled(365 * 1440, scale),  1, 1, 0,  1,   false, false, false},
+        {"campaign", scaled(1'000'000, scale), scaled(100'000'000, scale), 8, 4, 30, 1,   true,  true,  false},
+        {"ensemble", 10,                       1440,                       1, 1, 0,
+                     static_cast<int>(scaled(256, scale)),                            false, false, false},
+        {"faulted",  10,                       1440,                       1, 1, 0,
+                     static_cast<int>(scaled(256, scale)),                            false, false, true},
+    };
+}
+
+// rates sized so a day-long member sees a few events: every chamber ~2 outages, the bus ~1 fault
+std::vector<faults::FaultSpec> faultMix(int chambers) {
+    std::vector<faults::FaultSpec> specs;
+    for (int c = 0; c < chambers; ++c) {
+        faults::FaultSpec outage;
+        outage.kind = faults::FaultKind::Chamber;
+        outage.target = c;
+        outage.mtbf = 720;
+        outage.repair = 60;
+        specs.push_back(outage);
+    }
+    faults::FaultSpec trip;
+    trip.kind = faults::FaultKind::BatteryTrip;
+    trip.mtbf = 2880;
+    trip.repair = 30;
+    specs.push_back(trip);
+    faults::FaultSpec panel;
+    panel.kind = faults::FaultKind::Panel;
+    panel.mtbf = 4320;
+    specs.push_back(panel);
+    faults::FaultSpec cell;
+    cell.kind = faults::FaultKind::Cell;
+    cell.mtbf = 4320;
+    specs.push_back(cell);
+    return specs;
+}
+
+struct StageRun {
+    long long minutes = 0;
+    long long completed = 0;
+    analytics::YieldAnalytics yield;
+};
+
+void fillYield(const analytics::YieldAnalytics& yield, ChildResult& result) {
+    const auto it = yield.recipes().find("default");
+    if (it == yield.recipes().end()) return;
+    result.yieldPct = 100.0 * it->second.yield();
+    result.cycleP99 = it->second.cycle.quantile(0.99);
+}
+
+/// One production-style run of the deposition stage (see main.cpp).
+StageRun runStage(const Scenario& sc, std::uint64_t seed, const fs::path& logPath, const FluxMap& flux) {
+    ChamberConfig config;
+    config.calibrationMinutes  = DEPO_CALIBRATION_MINUTES;
+    config.cooldownMinutes     = DEPO_COOLDOWN_MINUTES;
+    config.carrierSize         = sc.carrier;
+    config.maxBatchWaitMinutes = sc.maxBatchWait;
+
+    const int fleetWatts = sc.chambers * (DepositionModule::REQUIRED_POWER + (sc.carrier - 1) * config.extraWaferPower);
+    PowerModule power = sc.fleetPower ? PowerModule(250000, fleetWatts, fleetWatts) : PowerModule(250000, 300, 0);
+    Logger logger(logPath.string());
+
+    std::vector<std::unique_ptr<Task>> wafers;
+    wafers.reserve(static_cast<std::size_t>(sc.wafers));
+    StageQueue queue;
+    for (long long i = 0; i < sc.wafers; ++i) {
+        wafers.push_back(std::make_unique<Task>());
+        Task& task = *wafers.back();
+        task.id = "T_" + std::to_string(i + 1);
+        task.phase[0].requiredTime = 60;
+        task.phase[1].requiredTime = 20;
+        task.phase[2].requiredTime = 120;
+        task.phase[0].defectChance = 0.010;
+        task.phase[1].defectChance = 0.001;
+        task.phase[2].defectChance = 0.025;
+        queue.push(&task);
+    }
+
+    WaferMapArena arena(static_cast<std::size_t>(sc.chambers * sc.carrier));
+    std::vector<analytics::YieldAnalytics> chamberYield(static_cast<std::size_t>(sc.chambers));
+    std::vector<std::unique_ptr<DepositionModule>> chambers;
+    for (int c = 0; c < sc.chambers; ++c) {
+        chambers.push_back(std::make_unique<DepositionModule>(c, &queue, config));
+        chambers.back()->seedDefects(seed + static_cast<std::uint64_t>(c));
+        chambers.back()->attachWaferMaps(&arena, &flux);
+        chambers.back()->attachYieldAnalytics(&chamberYield[static_cast<std::size_t>(c)]);
+    }
+    faults::FaultInjector injector(sc.faults ? faultMix(sc.chambers) : std::vector<faults::FaultSpec>(),
+                                   seed + static_cast<std::uint64_t>(sc.chambers));
+    injector.attachPower(&power);
+    for (const auto& chamber : chambers) injector.attachChamber(chamber.get());
+
+    ProfiledMutex powerMutex("power_mutex");
+    std::atomic<int> simMinute(0), orbitState(0);
+    TickBarrier barrier(sc.chambers);
+    std::vector<std::thread> threads;
+    for (auto& chamber : chambers) {
+        DepositionModule* module = chamber.get();
+        threads.emplace_back([&, module]() {
+            int seen = 0;
+            while (barrier.waitForTick(seen)) {
+                module->update(simMinute.load(std::memory_order_relaxed), power, logger, &powerMutex, &orbitState);
+                barrier.arrive();
+            }
+        });
+    }
+
+    StageRun run;
+    for (long long t = 0; t < sc.minutes; ++t) {
+        simMinute.store(static_cast<int>(t), std::memory_order_relaxed);
+        orbitState.store((t % 90 < 45) ? 0 : 1, std::memory_order_relaxed);
+        injector.advance(static_cast<int>(t));
+        {
+            std::lock_guard<ProfiledMutex> powerLock(powerMutex);
+            power.update(static_cast<int>(t), orbitState.load(std::memory_order_relaxed) == 0 ? "sunlight" : "eclipse");
+        }
+        barrier.publish();
+        barrier.waitAll();
+        run.minutes = t + 1;
+
+        // the chambers unload a finished carrier on their next minute, so count what left
+        long long completed = 0;
+        for (const auto& chamber : chambers) completed += chamber->chamberStats().completed;
+        run.completed = completed;
+        if (sc.untilDone && completed >= sc.wafers) break;
+    }
+    barrier.stop();
+    for (auto& th : threads) th.join();
+    for (const auto& yield : chamberYield) run.yield.merge(yield);
+    return run;
+}
+
+ChildResult runScenario(const Scenario& sc, int cores, const fs::path& dir) {
+    // same shield as main.cpp (wafermap::shieldScene)
+    const FluxMap flux = FluxMap::fromShield();
+
+    ChildResult result;
+    const auto t0 = std::chrono::steady_clock::now();
+    if (sc.members <= 1) {
+        const StageRun run = runStage(sc, 1, dir / "logV1.csv", flux);
+        result.simMinutes = run.minutes;
+        result.wafers = run.completed;
+        result.wafersQueued = sc.wafers;
+        fillYield(run.yield, result);
+    } else {
+        std::atomic<int> next(0);
+        std::atomic<long long> minutes(0), wafers(0);
+        std::mutex yieldMutex;
+        analytics::YieldAnalytics ensembleYield;
+        std::vector<std::thread> pool;
+        for (int w = 0; w < cores; ++w) {
+            pool.emplace_back([&]() {
+                for (int m = next++; m < sc.members; m = next++) {
+                    const StageRun run = runStage(sc, 1000 + static_cast<std::uint64_t>(m),
+                                                  dir / ("logV1_" + std::to_string(m) + ".csv"), flux);
+                    minutes += run.minutes;
+                    wafers += run.completed;
+                    std::vector<std::uint8_t> blob;   // what a member would ship instead of raw wafers
+                    run.yield.serialize(blob);
+                    std::lock_guard<std::mutex> lock(yieldMutex);
+                    ensembleYield.deserialize(blob);
+                }
+            });
+        }
+        for (auto& th : pool) th.join();
+        result.simMinutes = minutes;
+        result.wafers = wafers;
+        result.wafersQueued = sc.wafers * sc.members;
+        fillYield(ensembleYield, result);
+    }
+    result.wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return result;
+}
+
+std::uintmax_t directoryBytes(const fs::path& dir) {
+    std::uintmax_t bytes = 0;
+    for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+        if (entry.is_regular_file()) bytes += entry.file_size();
+    }
+    return bytes;
+}
+
+/// Runs one point in a child pinned to `cores` CPUs; false if the child failed.
+bool runPoint(const Scenario& sc, int cores, const fs::path& scratch, Row& row) {
+    const fs::path dir = scratch / (sc.name + "_" + std::to_string(cores));
+    fs::create_directories(dir / "debugLogs");
+
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    const pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        close(fds[0]);
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c = 0; c < cores; ++c) CPU_SET(c, &set);
+        sched_setaffinity(0, sizeof(set), &set);
+
+        fs::current_path(dir);   // runOneMinute writes debugLogs/ relative to the working directory
+        NullBuffer nullBuffer;
+        std::cout.rdbuf(&nullBuffer);
+        const ChildResult result = runScenario(sc, cores, dir);
+        const bool written = write(fds[1], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+        close(fds[1]);
+        _exit(written ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ChildResult result;
+    const bool got = read(fds[0], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    rusage usage{};
+    wait4(pid, &status, 0, &usage);
+    if (!got || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return false;
+
+    row.scenario = sc.name;
+    row.cores = cores;
+    row.run = result;
+    row.peakRssKb = usage.ru_maxrss;   // kB on Linux
+    row.bytesLogged = directoryBytes(dir);
+    fs::remove_all(dir);
+    return true;
+}
+
+void writeJson(std::ostream& out, const std::vector<Row>& rows, const std::string& label, double scale) {
+    out << "{\n  \"suite\": \"scenario\",\n  \"label\": \"" << label << "\",\n"
+        << "  \"scale\": " << scale << ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        const Row& r = rows[i];
+        out << "    {\"scenario\": \"" << r.scenario << "\", \"cores\": " << r.cores
+            << ", \"wall_s\": " << r.run.wallSec
+            << ", \"sim_minutes\": " << r.run.simMinutes
+            << ", \"sim_minutes_per_s\": " << r.run.simMinutes / std::max(r.run.wallSec, 1e-9)
+            << ", \"peak_rss_kb\": " << r.peakRssKb
+            << ", \"bytes_logged\": " << r.bytesLogged
+            << ", \"wafers\": " << r.run.wafers << ", \"wafers_queued\": " << r.run.wafersQueued
+            << ", \"yield_pct\": " << r.run.yieldPct << ", \"cycle_p99_min\": " << r.run.cycleP99 << "}"
+            << (i + 1 < rows.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string only = "all", jsonPath, label;
+    double scale = 1.0;
+    std::vector<int> cores;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto next = [&]() { return (i + 1 < argc) ? std::string(argv[++i]) : std::string(); };
+        if      (a == "--scenario") only = next();
+        else if (a == "--cores")    cores = parseList(next());
+        else if (a == "--scale")    scale = std::stod(next());
+        else if (a == "--json")     jsonPath = next();
+        else if (a == "--label")    label = next();
+    }
+    const int hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (cores.empty()) {
+        for (int c = 1; c < hw; c *= 2) cores.push_back(c);
+        cores.push_back(hw);
+    }
+
+    const fs::path scratch = fs::temp_directory_path() / "spaceforge_scenario_bench";
+    fs::create_directories(scratch);
+
+    std::cout << std::setw(10) << "scenario" << std::setw(7) << "cores" << std::setw(11) << "wall s"
+              << std::setw(14) << "sim-min/s" << std::setw(10) << "speedup" << std::setw(13) << "peak RSS MB"
+              << std::setw(14) << "MB logged" << std::setw(20) << "wafers" << std::setw(9) << "yield %"
+              << std::setw(12) << "cycle p99" << "\n";
+
+    std::vector<Row> rows;
+    bool ok = true;
+    for (const Scenario& sc : scenarios(scale)) {
+        if (only != "all" && only != sc.name) continue;
+        double baseWall = 0.0;
+        for (int c : cores) {
+            Row row;
+            if (!runPoint(sc, c, scratch, row)) {
+                std::cerr << "Scenario " << sc.name << " failed on " << c << " cores\n";
+                ok = false;
+                continue;
+            }
+            if (baseWall == 0.0) baseWall = row.run.wallSec;
+            std::cout << std::fixed << std::setprecision(2)
+                      << std::setw(10) << row.scenario << std::setw(7) << row.cores
+                      << std::setw(11) << row.run.wallSec
+                      << std::setw(14) << std::setprecision(0) << row.run.simMinutes / std::max(row.run.wallSec, 1e-9)
+                      << std::setw(9) << std::setprecision(2) << baseWall / row.run.wallSec << "x"
+                      << std::setw(13) << std::setprecision(1) << row.peakRssKb / 1024.0
+                      << std::setw(14) << row.bytesLogged / (1024.0 * 1024.0)
+                      << std::setw(20) << (std::to_string(row.run.wafers) + "/" + std::to_string(row.run.wafersQueued))
+                      << std::setw(9) << row.run.yieldPct << std::setw(12) << std::setprecision(0) << row.run.cycleP99
+                      << "\n";
+            rows.push_back(row);
+        }
+    }
+    fs::remove_all(scratch);
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out.is_open()) {
+            std::cerr << "Error opening JSON output: " << jsonPath << "\n";
+            return 1;
+        }
+        writeJson(out, rows, label, scale);
+        std::cout << "Wrote " << jsonPath << "\n";
+    }
+    return ok ? 0 : 1;
+}
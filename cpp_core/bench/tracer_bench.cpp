@@ -0,0 +1,276 @@
+/** Tracer accuracy-vs-speed benchmark
+ *
+ * Re-traces the reference scenes in monte-carlo-sim/mc_data/mc_output{N}.csv with the
+ * native tracer (WakeTracer.hpp) at several ray budgets and sampling modes, and reports
+ *   • rays/s per core and thread-scaling efficiency (1 .. all cores)
+ *   • agreement with the Python reference: hit ratio, wake intrusion ratio, wafer flux
+ *   • grid L2 error against grids_mc{N}.csv (export it with monte-carlo-sim/export_grids.py;
+ *     the parquet files cannot be read from C++ without Arrow)
+ *
+ * Run command (from cpp_core/build, same relative layout as ./simulation):
+ *    ./tracer_bench --runs 1,5 --scenes 200 --budgets 1000,10000,100000
+ */
+
+#include "WakeTracer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct RefScene {
+    wake::Scene scene;
+    double hitRatio  = 0.0;
+    double wakeRatio = 0.0;
+    double flux      = 0.0;
+    std::vector<double> grid;   // empty if no grid export is available
+};
+
+struct Options {
+    std::string dataDir = "../../monte-carlo-sim/mc_data";
+    std::vector<int> runs = {1};
+    std::size_t scenes = 200;
+    std::vector<std::uint64_t> budgets = {1'000, 10'000, 100'000};
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::uint64_t seed = 20250814;
+    double waferRadius = 0.0;    // 0 ⇒ use the radius each reference run was generated with
+    std::uint64_t referenceRays = 10'000;   // batch_size used to produce the reference CSVs
+};
+
+std::vector<std::string> splitCsv(const std::string& line) {
+    std::vector<std::string> out;
+    std::stringstream ss(line);
+    std::string cell;
+    while (std::getline(ss, cell, ',')) out.push_back(cell);
+    return out;
+}
+
+template <typename T>
+std::vector<T> parseList(const std::string& s) {
+    std::vector<T> out;
+    for (const auto& tok : splitCsv(s)) out.push_back(static_cast<T>(std::stoull(tok)));
+    return out;
+}
+
+// WaferPlane radius used when mc_output{run}.csv was produced (mc1–mc4: 0.15 m, mc5: 0.30 m)
+double referenceWaferRadius(int run) {
+    return run >= 5 ? 0.30 : 0.15;
+}
+
+std::vector<RefScene> loadReference(const Options& opt, int run) {
+    const std::string csvPath  = opt.dataDir + "/mc_output" + std::to_string(run) + ".csv";
+    const std::string gridPath = opt.dataDir + "/grids_mc" + std::to_string(run) + ".csv";
+
+    std::ifstream in(csvPath);
+    if (!in.is_open()) {
+        std::cerr << "Error opening reference file: " << csvPath << std::endl;
+        return {};
+    }
+
+    std::string line;
+    std::getline(in, line);
+    const auto header = splitCsv(line);
+    auto col = [&](const std::string& name) {
+        const auto it = std::find(header.begin(), header.end(), name);
+        if (it == header.end()) {
+            std::cerr << "Missing column '" << name << "' in " << csvPath << std::endl;
+            std::exit(1);
+        }
+        return static_cast<std::size_t>(it - header.begin());
+    };
+    const std::size_t cProfile = col("profile"), cDim = col("primary_dim"), cShape = col("shape_param"),
+                      cCoat = col("coating_type"), cZ = col("z_offset"), cX = col("xy_offset_x"),
+                      cY = col("xy_offset_y"), cHit = col("hit_ratio"), cFlux = col("wafer_flux_m2s"),
+                      cWake = col("wake_intrusion_ratio"), cType = col("wake_type");
+
+    const double waferRadius = opt.waferRadius > 0.0 ? opt.waferRadius : referenceWaferRadius(run);
+    std::vector<RefScene> scenes;
+    while (scenes.size() < opt.scenes && std::getline(in, line)) {
+        const auto f = splitCsv(line);
+        if (f.size() < header.size()) continue;
+        RefScene r;
+        if (!wake::makeScene(f[cProfile], std::stod(f[cDim]), std::stod(f[cShape]), f[cCoat],
+                             std::stod(f[cZ]), std::stod(f[cX]), std::stod(f[cY]), f[cType],
+                             waferRadius, r.scene)) {
+            continue;
+        }
+        r.hitRatio  = std::stod(f[cHit]);
+        r.wakeRatio = std::stod(f[cWake]);
+        r.flux      = std::stod(f[cFlux]);
+        scenes.push_back(std::move(r));
+    }
+
+    // optional: per-scene grids (g0000 .. g2499), row order matches mc_output
+    std::ifstream gin(gridPath);
+    if (gin.is_open()) {
+        std::getline(gin, line);
+        const auto gHeader = splitCsv(line);
+        std::vector<std::size_t> gCols;
+        for (std::size_t i = 0; i < gHeader.size(); ++i)
+            if (gHeader[i].size() == 5 && gHeader[i][0] == 'g') gCols.push_back(i);
+        for (std::size_t s = 0; s < scenes.size() && std::getline(gin, line); ++s) {
+            const auto f = splitCsv(line);
+            if (gCols.size() != wake::GRID_N * wake::GRID_N) break;
+            scenes[s].grid.reserve(gCols.size());
+            for (std::size_t c : gCols) scenes[s].grid.push_back(std::stod(f[c]));
+        }
+    }
+    return scenes;
+}
+
+struct Agreement {
+    double hitMeanRef = 0.0, hitMean = 0.0;
+    double wakeMeanRef = 0.0, wakeMean = 0.0;
+    double fluxRatio = 0.0;          // Σ flux / Σ flux_ref
+    double hitAbsZ = 0.0;            // mean |z| of per-scene hit-ratio difference
+    double within3Sigma = 0.0;       // fraction of scenes with |z| ≤ 3
+    double gridL2 = -1.0;            // mean L2 of normalised grids (-1 ⇒ no grids)
+};
+
+struct Row {
+    double seconds = 0.0;
+    std::uint64_t rays = 0;
+    Agreement agree;
+};
+
+Row evaluate(const std::vector<RefScene>& scenes, std::uint64_t budget, wake::SamplingMode mode,
+             int threads, const Options& opt, bool measureAgreement) {
+    Row row;
+    double fluxSum = 0.0, fluxRefSum = 0.0, zSum = 0.0, l2Sum = 0.0;
+    std::size_t within = 0, l2Count = 0;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < scenes.size(); ++i) {
+        const RefScene& ref = scenes[i];
+        const wake::TraceResult res = wake::traceBatch(ref.scene, budget, opt.seed + i, mode, threads);
+        row.rays += res.rays;
+        if (!measureAgreement) continue;
+
+        Agreement& a = row.agree;
+        a.hitMeanRef  += ref.hitRatio;   a.hitMean  += res.hitRatio;
+        a.wakeMeanRef += ref.wakeRatio;  a.wakeMean += res.wakeIntrusionRatio;
+        fluxRefSum    += ref.flux;       fluxSum    += res.waferFluxM2s;
+
+        // two-sample binomial z-score on the hit ratio
+        const double nA = static_cast<double>(opt.referenceRays), nB = static_cast<double>(budget);
+        const double pooled = (ref.hitRatio * nA + res.hitRatio * nB) / (nA + nB);
+        const double se = std::sqrt(std::max(pooled * (1.0 - pooled), 1e-12) * (1.0 / nA + 1.0 / nB));
+        const double z = std::fabs(res.hitRatio - ref.hitRatio) / se;
+        zSum += z;
+        if (z <= 3.0) ++within;
+
+        if (!ref.grid.empty()) {
+            double sRef = 0.0, sOur = 0.0;
+            for (int k = 0; k < wake::GRID_N * wake::GRID_N; ++k) { sRef += ref.grid[k]; sOur += res.grid[k]; }
+            if (sRef > 0.0 && sOur > 0.0) {
+                double l2 = 0.0;
+                for (int k = 0; k < wake::GRID_N * wake::GRID_N; ++k) {
+                    const double d = res.grid[k] / sOur - ref.grid[k] / sRef;
+                    l2 += d * d;
+                }
+                l2Sum += std::sqrt(l2);
+                ++l2Count;
+            }
+        }
+    }
+    row.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (measureAgreement && !scenes.empty()) {
+        Agreement& a = row.agree;
+        const double n = static_cast<double>(scenes.size());
+        a.hitMeanRef /= n;  a.hitMean /= n;
+        a.wakeMeanRef /= n; a.wakeMean /= n;
+        a.fluxRatio    = fluxRefSum > 0.0 ? fluxSum / fluxRefSum : (fluxSum == 0.0 ? 1.0 : 0.0);
+        a.hitAbsZ      = zSum / n;
+        a.within3Sigma = static_cast<double>(within) / n;
+        a.gridL2       = l2Count ? l2Sum / static_cast<double>(l2Count) : -1.0;
+    }
+    return row;
+}
+
+void usage() {
+    std::cout << "usage: tracer_bench [--data DIR] [--runs 1,2,..] [--scenes N] [--budgets a,b,..]\n"
+                 "                    [--threads N] [--seed S] [--wafer-radius M]\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) { usage(); std::exit(1); }
+            return argv[++i];
+        };
+        if      (arg == "--data")         opt.dataDir = next();
+        else if (arg == "--runs")         opt.runs = parseList<int>(next());
+        else if (arg == "--scenes")       opt.scenes = std::stoul(next());
+        else if (arg == "--budgets")      opt.budgets = parseList<std::uint64_t>(next());
+        else if (arg == "--threads")      opt.threads = std::max(1, std::stoi(next()));
+        else if (arg == "--seed")         opt.seed = std::stoull(next());
+        else if (arg == "--wafer-radius") opt.waferRadius = std::stod(next());
+        else { usage(); return arg == "--help" ? 0 : 1; }
+    }
+
+    const wake::SamplingMode modes[] = {wake::SamplingMode::Uniform, wake::SamplingMode::Stratified};
+
+    std::cout << std::fixed;
+    for (int run : opt.runs) {
+        const auto scenes = loadReference(opt, run);
+        if (scenes.empty()) continue;
+        const bool haveGrids = !scenes.front().grid.empty();
+
+        std::cout << "\n=== mc_output" << run << " | " << scenes.size() << " scenes | "
+                  << opt.threads << " threads | grids: " << (haveGrids ? "yes" : "no (run export_grids.py)")
+                  << " ===\n";
+        std::cout << std::setw(10) << "budget" << std::setw(12) << "mode"
+                  << std::setw(14) << "rays/s/core" << std::setw(10) << "hit_ref" << std::setw(10) << "hit"
+                  << std::setw(10) << "|z|" << std::setw(9) << "<=3σ" << std::setw(10) << "wake_ref"
+                  << std::setw(10) << "wake" << std::setw(10) << "flux×" << std::setw(10) << "gridL2" << "\n";
+
+        for (std::uint64_t budget : opt.budgets) {
+            for (auto mode : modes) {
+                const Row r = evaluate(scenes, budget, mode, opt.threads, opt, true);
+                const double perCore = static_cast<double>(r.rays) / r.seconds / opt.threads;
+                const Agreement& a = r.agree;
+                std::cout << std::setw(10) << budget << std::setw(12) << wake::toString(mode)
+                          << std::setw(14) << std::setprecision(0) << perCore
+                          << std::setprecision(4)
+                          << std::setw(10) << a.hitMeanRef << std::setw(10) << a.hitMean
+                          << std::setw(10) << std::setprecision(2) << a.hitAbsZ
+                          << std::setw(9) << a.within3Sigma
+                          << std::setprecision(4)
+                          << std::setw(10) << a.wakeMeanRef << std::setw(10) << a.wakeMean
+                          << std::setw(10) << a.fluxRatio
+                          << std::setw(10) << (a.gridL2 < 0.0 ? std::string("n/a") : std::to_string(a.gridL2).substr(0, 6))
+                          << "\n";
+            }
+        }
+
+        // thread scaling at the largest budget: efficiency = T1 / (n · Tn)
+        const std::uint64_t budget = *std::max_element(opt.budgets.begin(), opt.budgets.end());
+        std::cout << "\n  scaling @ " << budget << " rays/scene (uniform)\n"
+                  << std::setw(10) << "threads" << std::setw(14) << "seconds"
+                  << std::setw(14) << "rays/s/core" << std::setw(12) << "efficiency" << "\n";
+        double t1 = 0.0;
+        for (int n = 1; n <= opt.threads; n = (n == opt.threads) ? n + 1 : std::min(n * 2, opt.threads)) {
+            const Row r = evaluate(scenes, budget, wake::SamplingMode::Uniform, n, opt, false);
+            if (n == 1) t1 = r.seconds;
+            std::cout << std::setw(10) << n << std::setw(14) << std::setprecision(3) << r.seconds
+                      << std::setw(14) << std::setprecision(0) << static_cast<double>(r.rays) / r.seconds / n
+                      << std::setw(12) << std::setprecision(3) << t1 / (n * r.seconds) << "\n";
+        }
+    }
+    return 0;
+}
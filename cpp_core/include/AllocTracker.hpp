@@ -0,0 +1,78 @@
+#ifndef ALLOC_TRACKER_HPP
+#define ALLOC_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief  Heap allocation accounting and the steady-state no-allocation check.
+ *
+ *  Built with SPACEFORGE_ALLOC_TRACKING (cmake -DSPACEFORGE_TRACK_ALLOCS=ON) the global
+ *  operator new / delete are replaced and every allocation is counted against the
+ *  subsystem tag of the calling thread:
+ *
+ *      { SF_ALLOC_SCOPE(alloc::Tag::Logger); ... }   // allocations in here count as Logger
+ *
+ *  No-alloc mode: once the run is warmed up, main calls alloc::enterSteadyState(). From then
+ *  on any allocation on a thread marked with setTickThread(true) is a violation; the first
+ *  few are kept with a stack sample, and with Policy::Abort the process aborts on the spot.
+ *
+ *  Without the define the hooks are not installed and everything here is a no-op.
+ */
+namespace alloc {
+
+enum class Tag : std::uint8_t { Other, Main, Deposition, Ion, Crystal, Logger, Power, Queue, Tracer, Count };
+
+const char* toString(Tag tag);
+
+enum class Policy { Report, Abort };
+
+struct TagStats {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t frees = 0;
+};
+
+bool enabled();   // true if the hooks are compiled in
+
+/// Tag of the calling thread (Other by default).
+Tag  currentTag();
+void setCurrentTag(Tag tag);
+
+/// Only tick-loop threads are checked in steady state (the introspection server may allocate).
+void setTickThread(bool isTickThread);
+
+void enterSteadyState(Policy policy = Policy::Report);
+void leaveSteadyState();
+
+TagStats stats(Tag tag);
+std::uint64_t steadyStateViolations();
+
+/// Per-tag table plus the captured violations (stack samples go straight to stderr).
+void report(std::ostream& out);
+
+/// Restores the previous tag on scope exit.
+class Scope {
+public:
+    explicit Scope(Tag tag) : previous_(currentTag()) { setCurrentTag(tag); }
+    ~Scope() { setCurrentTag(previous_); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    Tag previous_;
+};
+
+}  // namespace alloc
+
+#ifdef SPACEFORGE_ALLOC_TRACKING
+#define SF_ALLOC_CONCAT_INNER(a, b) a##b
+#define SF_ALLOC_CONCAT(a, b) SF_ALLOC_CONCAT_INNER(a, b)
+#define SF_ALLOC_SCOPE(tag) ::alloc::Scope SF_ALLOC_CONCAT(sfAllocScope_, __LINE__)(tag)
+#else
+#define SF_ALLOC_SCOPE(tag) ((void)0)
+#endif
+
+#endif  // ALLOC_TRACKER_HPP
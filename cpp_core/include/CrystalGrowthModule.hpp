@@ -0,0 +1,170 @@
+#ifndef CRYSTAL_GROWTH_MODULE_HPP
+#define CRYSTAL_GROWTH_MODULE_HPP
+
+#include "Task.hpp"
+#include "PowerBus.hpp"
+#include "Logger.hpp"
+#include "DefectModel.hpp"
+#include "StageQueue.hpp"
+#include "ProfiledMutex.hpp"
+#include "EnergyLedger.hpp"
+#include "QueueingAnalyzer.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief When the furnace pauses on its own, at a safe pause point.
+ *
+ *  Eclipse:    pause at a pause point when the next segment would not finish before the
+ *              eclipse (or the eclipse has begun); resume once the reheat and the next
+ *              segment both fit in the sunlight left; the battery only carries the hold.
+ *  RunThrough: never pause on purpose; grow on battery through the eclipse, pausing only
+ *              when the bus cannot feed the furnace.
+ */
+enum class PausePolicy { Eclipse, RunThrough };
+
+/**
+ * @brief Furnace, preemption and defect-risk settings.
+ *
+ *  Growth can stop safely every pausePointMinutes of growth. Paused, the melt is held at
+ *  holdPower; a pause that loses even that goes cold. Resuming costs reheatMinutes at
+ *  runPower without growth, plus reheatPerColdMinute for every cold minute.
+ *  The pause's defect risk grows with its length and is drawn once, on resume:
+ *      p = 1 - exp(-(heldRiskPerMinute · held + coldRiskPerMinute · cold)) (+ forcedPauseRisk)
+ *  A pause between pause points (the bus dropped the furnace mid-segment) adds forcedPauseRisk.
+ */
+struct GrowthConfig {
+    int runPower            = 200;    ///< W per growth (or reheat) minute
+    int holdPower           = 50;     ///< W per paused minute to keep the melt at temperature
+    int pausePointMinutes   = 15;     ///< growth minutes between safe pause points
+    int reheatMinutes       = 5;      ///< minutes at runPower after every pause, no growth
+    double reheatPerColdMinute = 0.25;   ///< extra reheat per minute paused without hold power
+    int cooldownMinutes     = 10;     ///< idle minutes after a wafer leaves
+    double heldRiskPerMinute = 0.001; ///< defect hazard per held pause minute
+    double coldRiskPerMinute = 0.01;  ///< defect hazard per cold pause minute
+    double forcedPauseRisk   = 0.05;  ///< extra defect chance of a pause between pause points
+    int sunlightMinutes     = 45;     ///< of every energy::ORBIT_MINUTES, as main drives the orbit
+    PausePolicy policy      = PausePolicy::RunThrough;
+};
+
+/**
+ * @brief Simulated-minute accounting for the furnace (read after the run).
+ */
+struct GrowthStats {
+    int completed          = 0;   ///< wafers grown
+    int growthMinutes      = 0;
+    int reheatMinutes      = 0;
+    int heldMinutes        = 0;   ///< paused with hold power
+    int coldMinutes        = 0;   ///< paused without it
+    int pauses             = 0;   ///< at pause points
+    int forcedPauses       = 0;   ///< between pause points
+    int pauseDefects       = 0;   ///< wafers the pause risk marked defective
+    int coolingMinutes     = 0;
+    int idleMinutes        = 0;
+    int heaterFailedMinutes = 0;  ///< heater out of service (FaultInjector.hpp)
+    long long holdEnergy   = 0;   ///< W·min spent holding
+    long long reheatEnergy = 0;   ///< W·min spent reheating
+    long long waferWaitMinutes = 0;   ///< Σ (load minute - Task::readyMinute)
+};
+
+/**
+ * @brief Single-wafer crystal growth furnace with stage-level preemption.
+ *
+ *  The 120-minute growth spans more than one 45-minute sunlight arc, so the furnace either
+ *  pauses at a safe pause point and holds the melt through the eclipse, or grows on battery.
+ *  The policy makes that trade: hold energy, reheat minutes and a pause risk that grows with
+ *  the pause, against eclipse power taken from the other stages. Growth progress
+ *  (PhaseInfo::elapsedTime) is never lost by a pause; PhaseInfo::pausedMinutes keeps the total.
+ *
+ *  main runs it after the chambers and before ion implantation, so it takes the power deposition
+ *  left; with SPACEFORGE_CRYSTAL_FIRST=1 it draws before the chambers and its hold is never
+ *  starved by them, at the cost of the chambers' eclipse minutes.
+ */
+class CrystalGrowthModule {
+public:
+    /**
+     * @param input Buffer the furnace pulls wafers from (not owned)
+     * @param cfg   Furnace, pause and risk settings
+     */
+    explicit CrystalGrowthModule(StageQueue* input, const GrowthConfig& cfg = GrowthConfig());
+
+    void seed(std::uint64_t seed) { defects.seed(seed); }
+    std::uint64_t defectDraws() const { return defects.draws(); }
+
+    /// Books the solar / battery split of every draw in `ledger` (stage 2); nullptr ⇒ off.
+    void attachEnergyLedger(energy::EnergyLedger* ledger) { energyLedger = ledger; }
+
+    /// Reports buffer waits, residence and cycles to `observation`; nullptr ⇒ off.
+    void attachQueueing(queueing::StageObservation* observation) { queueStats = observation; }
+
+    /// Appends every grown wafer (it leaves the line) to `finished`; nullptr ⇒ off.
+    void attachCompletions(std::vector<Task*>* finished) { finishedWafers = finished; }
+
+    /**
+     * @brief One minute: unload, cool down, load, then grow, pause, hold or reheat.
+     *
+     * @note Same signature as DepositionModule::update(); powerMutex is held only around the draw.
+     */
+    void update(int t, PowerModule& power, Logger& logger, ProfiledMutex* powerMutex, std::atomic<int>* orbitState);
+
+    /**
+     * @brief Fails (or repairs) the heater, between ticks.
+     *
+     *  With the heater failed nothing is drawn: a growing wafer takes a pause as if the bus had
+     *  dropped it (forced between pause points) and goes cold until the repair; no wafer is loaded.
+     */
+    void setHeaterFailed(bool failed) { heaterFailed = failed; }
+    bool isHeaterFailed() const { return heaterFailed; }
+
+    /// Defect chance a pause of `held` + `cold` minutes adds on resume.
+    double pauseRisk(int held, int cold, bool forced) const;
+
+    /// Books the wafer still in the furnace at minute `tEnd` with its residence so far.
+    void censorQueueing(int tEnd) const;
+
+    Task* currentTask() const { return activeTask; }
+    bool isPaused()    const { return paused; }
+    bool isReheating() const { return reheatRemaining > 0; }
+    bool isCoolingDown() const { return cooldownRemaining > 0; }
+    const GrowthConfig& growthConfig() const { return config; }
+    const GrowthStats& growthStats() const { return stats; }
+    const std::string& name() const { return moduleName; }
+
+private:
+    /// true if the policy stops at this pause point (minute t, `left` growth minutes to go,
+    /// `lead` minutes before the segment can start).
+    bool pauseHere(int t, int left, int lead = 0) const;
+    /// true if the policy lets a paused wafer go on at minute t: reheat and next segment fit.
+    bool resumeNow(int t) const;
+    /// Reheat minutes the current pause costs on resume.
+    int reheatNeeded() const;
+    void beginPause(bool forced);
+    /// Ends the pause: draws its risk and schedules the reheat.
+    void endPause();
+    /// Draws `watts` if the bus has them; books them on the wafer and the ledger.
+    bool draw(int t, int watts, PowerModule& power, ProfiledMutex* powerMutex);
+    void unload(int t);
+
+    StageQueue* inputQueue = nullptr;
+    GrowthConfig config;
+    GrowthStats stats;
+    std::string moduleName = "CrystalGrowth";   ///< Module column in the log
+    Task* activeTask = nullptr;
+    int loadedAt = -1;
+    int cooldownRemaining = 0;
+    int reheatRemaining   = 0;
+    bool paused = false;
+    bool pauseForced = false;   ///< the current pause did not start at a pause point
+    int pauseHeld = 0;          ///< minutes of the current pause with hold power
+    int pauseCold = 0;          ///< and without
+    bool heaterFailed = false;  ///< setHeaterFailed()
+
+    DefectSampler defects;      ///< Per-module RNG stream for growth and pause defects
+    energy::EnergyLedger* energyLedger = nullptr;
+    queueing::StageObservation* queueStats = nullptr;
+    std::vector<Task*>* finishedWafers = nullptr;
+};
+
+#endif  // CRYSTAL_GROWTH_MODULE_HPP
@@ -0,0 +1,88 @@
+#ifndef DEFECT_MODEL_HPP
+#define DEFECT_MODEL_HPP
+
+#include <cstdint>
+#include <random>
+
+/**
+ * @brief  Per-minute defect hazard: probability that a processed minute produces a defect.
+ *
+ *  The old model drew a Bernoulli(defectChance) every minute. Sampling the time to the
+ *  first defect over a whole uninterrupted span gives the same distribution with one draw:
+ *    • constant hazard p   → geometric:   P(K = k) = (1-p)^k · p
+ *    • varying hazard p(t) → exponential: first k with Σ -ln(1-p(t)) ≥ E,  E ~ Exp(1)
+ */
+class DefectHazard {
+public:
+    virtual ~DefectHazard() = default;
+
+    virtual double probability(int minute) const = 0;   // defect probability of that minute
+    virtual bool   isConstant() const { return false; } // true ⇒ the geometric fast path applies
+};
+
+class ConstantHazard : public DefectHazard {
+public:
+    explicit ConstantHazard(double p) : p_(p) {}
+    double probability(int) const override { return p_; }
+    bool   isConstant() const override { return true; }
+
+private:
+    double p_;
+};
+
+/**
+ * @brief  Base defect chance plus contamination from the wake-intrusion flux provider:
+ *         p = 1 - (1 - base) · exp(-sensitivity · contamination[#/m² per minute])
+ *         With no contamination this is exactly the old per-minute defectChance.
+ */
+class FluxHazard : public DefectHazard {
+public:
+    FluxHazard(double baseChance, double contaminationPerMinute, double sensitivity = DEFAULT_SENSITIVITY);
+    double probability(int) const override { return p_; }
+    bool   isConstant() const override { return true; }
+
+    static constexpr double DEFAULT_SENSITIVITY = 1.0e-23;   // per (#/m²); the shield's ~2.7e20 adds ~0.3 %
+
+private:
+    double p_;
+};
+
+/**
+ * @brief  RNG stream for defect draws. One per stage instance, so stages never contend on
+ *         (or perturb) each other's sequence — unlike the global rand() it replaces.
+ */
+class DefectSampler {
+public:
+    static constexpr int NO_DEFECT = -1;
+
+    explicit DefectSampler(std::uint64_t seed = 1) : rng_(seed) {}
+    void seed(std::uint64_t s) { rng_.seed(s); draws_ = 0; }
+
+    /// One minute, one draw: the old runOneMinute behaviour.
+    bool drawMinute(double p);
+
+    /**
+     * @brief Offset (0-based minute) of the first defect within the next `span` minutes,
+     *        or NO_DEFECT. Constant hazard, one draw.
+     */
+    int firstDefect(int span, double p);
+
+    /**
+     * @brief Same, for a hazard that may vary per minute; minute offsets are relative to
+     *        `startMinute`. Uses the geometric path when the hazard is constant.
+     */
+    int firstDefect(int startMinute, int span, const DefectHazard& hazard);
+
+    std::mt19937_64& engine() { return rng_; }
+
+    /// Position in the stream: uniforms drawn since the last seed() (journal checkpoints).
+    std::uint64_t draws() const { return draws_; }
+
+private:
+    double uniformOpen();   // U ∈ (0, 1]
+
+    std::mt19937_64 rng_;
+    std::uint64_t draws_ = 0;
+};
+
+#endif  // DEFECT_MODEL_HPP
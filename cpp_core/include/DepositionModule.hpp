@@ -4,19 +4,124 @@
 #include "Task.hpp"
 #include "PowerBus.hpp"
 #include "Logger.hpp"
+#include "WaferMap.hpp"
+#include "DefectModel.hpp"
+#include "StageQueue.hpp"
+#include "ProfiledMutex.hpp"
+#include "Journal.hpp"
+#include "YieldAnalytics.hpp"
+#include "EnergyLedger.hpp"
+#include "QueueingAnalyzer.hpp"
 #include <queue>
+#include <string>
+#include <vector>
 #include <mutex>
 #include <atomic>
 
+/**
+ * @brief Per-chamber timing: calibration before every carrier, cooldown after it.
+ *        Zero minutes disables the step (the original single-chamber behaviour).
+ *
+ *  Batch mode (carrierSize > 1): the chamber loads up to carrierSize wafers per cycle.
+ *  It waits for a full carrier, but starts with a partial one once the oldest waiting
+ *  wafer has been available for maxBatchWaitMinutes. Calibration and cooldown are paid
+ *  once per carrier; the carrier draws REQUIRED_POWER + extraWaferPower per extra wafer.
+ */
+struct ChamberConfig {
+    int calibrationMinutes = 0;   ///< minutes at calibrationPower before processing starts
+    int calibrationPower   = 100; ///< W drawn per calibration minute
+    int cooldownMinutes    = 0;   ///< idle minutes after a carrier leaves the chamber
+    int carrierSize        = 1;   ///< wafers per cycle (1 ⇒ single-wafer tool)
+    int maxBatchWaitMinutes = 0;  ///< max minutes to hold a partial carrier for more wafers
+    int extraWaferPower    = 100; ///< W per minute for every wafer beyond the first
+};
+
+/**
+ * @brief Simulated-minute accounting for one chamber (read after the run).
+ */
+struct ChamberStats {
+    int completed          = 0;   ///< wafers that finished this stage here
+    int busyMinutes        = 0;   ///< powered processing minutes
+    int calibratingMinutes = 0;
+    int coolingMinutes     = 0;
+    int idleMinutes        = 0;   ///< no wafer available (or waiting to fill a carrier)
+    int powerDeniedMinutes = 0;   ///< wafer present but the bus could not supply it
+    int blockedMinutes     = 0;   ///< finished wafers held on the carrier: output buffer full
+    int downMinutes        = 0;   ///< out of service (FaultInjector.hpp)
+    int batches            = 0;   ///< carriers started
+    int batchWaitMinutes   = 0;   ///< idle minutes spent holding for a fuller carrier
+    long long waferWaitMinutes = 0;   ///< Σ (load minute - Task::readyMinute) over loaded wafers
+    int wafersLoaded       = 0;   ///< wafers waferWaitMinutes is summed over
+};
+
 /**
  * @brief Represents a deposition machine that processes wafer tasks minute-by-minute.
  * Internally uses a queue of task pointers to simulate sequential real-time job processing.
+ *
+ * Several instances ("chambers") can share one StageQueue; each keeps its own
+ * calibration / cooldown state and competes for the same PowerModule under powerMutex.
  */
 class DepositionModule {
 private:
+    /// One wafer on the carrier, with its own map and defect span.
+    struct CarrierSlot {
+        Task* task = nullptr;
+        WaferMap* map = nullptr;         ///< held only while the wafer is on this stage
+        bool spanOpen = false;           ///< true while the wafer runs uninterrupted
+        int minutesToDefect = DefectSampler::NO_DEFECT;   ///< powered minutes until the sampled defect
+    };
+
     std::queue<Task*> queue;     ///< Queue of wafer tasks waiting to be processed
-    Task* activeTask = nullptr;  ///< Currently running task (nullptr if idle)
+    Task* activeTask = nullptr;  ///< First wafer of the carrier (nullptr if idle)
     int elapsed = 0;             ///< Tracks elapsed time for the current task
+    std::vector<CarrierSlot> carrier;    ///< Wafers loaded this cycle (≤ config.carrierSize)
+
+    int chamberId = 0;                   ///< Index among chambers of this stage
+    std::string moduleName = "Deposition";   ///< Module column in the log
+    StageQueue* sharedQueue = nullptr;   ///< If set, wafers are pulled from here instead of `queue`
+    ChamberConfig config;
+    ChamberStats stats;
+    int calibrationRemaining = 0;        ///< Calibration minutes left for the current carrier
+    int cooldownRemaining    = 0;        ///< Cooldown minutes left before the next carrier
+
+    /// Next wafer from the shared queue or the private one (nullptr if none).
+    Task* pullNext();
+    std::size_t queuedCount() const;
+    /// Minute the longest-waiting queued wafer became available (-1 if none).
+    int oldestQueued() const;
+
+    /// Applies the max-wait policy and loads the carrier; returns true if a cycle starts.
+    bool loadCarrier(int t);
+
+    /// W drawn per processing minute by the current carrier.
+    int carrierPower() const;
+
+    WaferMapArena* mapArena = nullptr;   ///< Pool the per-wafer maps come from (nullptr ⇒ no maps)
+    const FluxMap* fluxMap  = nullptr;   ///< Deposition profile + wake intrusion per cell
+    float depositionRateNm  = 15.0f;     ///< Film growth per powered minute at profile 1.0 [nm]
+
+    /// Copies the map summary into phase[0] and returns the map to the arena.
+    void finalizeMap(CarrierSlot& slot);
+    /// Finalizes the carrier's wafers front to back and drops each one `take(task)` accepts,
+    /// stopping at the first it refuses; an emptied carrier leaves the chamber idle.
+    /// Allocates nothing. Returns how many wafers left the carrier.
+    template <typename Take> std::size_t unloadWhile(Take take);
+
+    DefectSampler defects;               ///< Per-module RNG stream for defect draws
+    journal::Journal* runJournal = nullptr;   ///< Orders the shared sections when recording / replaying
+    analytics::YieldAnalytics* yieldStats = nullptr;   ///< Per-recipe outcomes of unloaded wafers, last stage only (nullptr ⇒ off)
+    energy::EnergyLedger* energyLedger = nullptr;      ///< Per-orbit solar / battery roll-up (nullptr ⇒ off)
+    queueing::StageObservation* queueStats = nullptr; ///< Waits, residence and cycles for the analyzer (nullptr ⇒ off)
+    int carrierLoadedAt = -1;            ///< Minute the current carrier was loaded
+    std::size_t carrierBatch = 0;        ///< Wafers loaded on the current carrier
+    StageQueue* outputQueue = nullptr;   ///< Buffer to the next stage (nullptr ⇒ wafers just leave)
+    bool blocked = false;                ///< Finished wafers waiting for room in outputQueue
+    bool down = false;                   ///< Out of service: setDown()
+    std::vector<Task*>* finishedWafers = nullptr;   ///< Unloaded wafers for main to hand on (nullptr ⇒ off)
+    double contaminationPerMinute = 0.0; ///< Disc-mean wake intrusion from fluxMap [#/m² per minute]
+
+    /// Samples the time to first defect over the rest of the phase (one draw per span).
+    void beginSpan(CarrierSlot& slot);
 
 public:
     /**
@@ -27,6 +132,15 @@ public:
      */
     DepositionModule(); 
 
+    /**
+     * @brief One chamber of a multi-chamber deposition stage.
+     *
+     * @param id     Chamber index; chambers other than 0 log as "Deposition_<id>"
+     * @param shared Queue all chambers of the stage pull from (not owned)
+     * @param cfg    Calibration / cooldown timing of this chamber
+     */
+    DepositionModule(int id, StageQueue* shared, const ChamberConfig& cfg = ChamberConfig());
+
     /**
      * @brief Adds a new task to the internal queue (non-copying).
      * 
@@ -47,6 +161,17 @@ public:
      */
     bool DepositionModuleEmpty();
 
+    /**
+     * @brief Enables per-wafer thickness / contamination maps.
+     *
+     * @param arena  Shared pool; a map is taken when a wafer starts and returned when it leaves
+     * @param flux   Per-cell sources; must outlive the module
+     * @param rateNm Film growth per powered minute at profile 1.0 [nm]
+     *
+     * @note Without this call the module behaves exactly as before (no spatial state).
+     */
+    void attachWaferMaps(WaferMapArena* arena, const FluxMap* flux, float rateNm = 15.0f);
+
     /**
      * @brief Main function to simulate one minute of real-time operation.
      * 
@@ -61,12 +186,12 @@ public:
      * @note Not marked `static` because it modifies internal state.
      *       Not marked `const` since it alters members like `activeTask`, `queue`, etc.
      */
-    void update(int t, PowerModule& power, Logger& logger, std::mutex* powerMutex, std::atomic<int>* orbitState);
+    void update(int t, PowerModule& power, Logger& logger, ProfiledMutex* powerMutex, std::atomic<int>* orbitState);
 
     /**
-     * @brief Determines whether the current active task has finished processing.
+     * @brief Determines whether the current carrier has finished processing.
      * 
-     * @return true if a task is currently running and its phase[0] is done.
+     * @return true if wafers are loaded and all of their phase[0] are done.
      *         false otherwise.
      * 
      * @note Helps coordinate task popping and logging.
@@ -80,15 +205,130 @@ public:
      * 
      * @note Does not deallocate memory. `main.cpp` or controller is responsible for task lifetime.
      *       `activeTask` is set to `nullptr`, marking the machine as idle again.
+     *       In batch mode the whole carrier is unloaded; use popCompletedBatch() to get every wafer.
      */
     Task* popCompleted();
 
+    /// Unloads the finished carrier and returns all of its wafers.
+    std::vector<Task*> popCompletedBatch();
+
     void discardTask_dep(Task* task);
 
+    static constexpr int REQUIRED_POWER = 300;   ///< W drawn per processing minute
+
+    /// Seeds this module's defect stream (replaces the global srand()).
+    void seedDefects(std::uint64_t seed);
+    std::uint64_t defectDraws() const { return defects.draws(); }
+
+    /**
+     * @brief Records (or, in replay, enforces) the order in which this chamber loads from the
+     *        shared queue and draws from the power bus, relative to the other chambers.
+     *
+     * @param journal Owned by the caller; nullptr (the default) leaves the module unsynchronised
+     */
+    void attachJournal(journal::Journal* journal) { runJournal = journal; }
+
+    /**
+     * @brief Adds every wafer this chamber unloads to `yield` (energy, defects, cycle time).
+     *
+     *  Only where deposition is the last stage (the benches); a full line records its
+     *  wafers once they leave crystal growth.
+     * @param yield Owned by the caller and written only by this chamber's thread; give each
+     *              chamber its own and merge them once the chambers are stopped
+     */
+    void attachYieldAnalytics(analytics::YieldAnalytics* yield) { yieldStats = yield; }
+
+    /**
+     * @brief Books the solar / battery split of every draw this chamber makes in `ledger`.
+     *
+     *  The per-wafer split is kept in PhaseInfo::solarEnergy / batteryEnergy either way.
+     * @param ledger Owned by the caller, one per chamber like attachYieldAnalytics()
+     */
+    void attachEnergyLedger(energy::EnergyLedger* ledger) { energyLedger = ledger; }
+
+    /**
+     * @brief Reports queue waits, carrier residence and chamber cycles to `observation`.
+     *
+     * @param observation Owned by the caller, one per chamber; merged into the stage's
+     *                    QueueingAnalyzer observation after the run
+     */
+    void attachQueueing(queueing::StageObservation* observation) { queueStats = observation; }
+
+    /**
+     * @brief Hands finished wafers to `buffer` (the next stage's queue) instead of dropping them.
+     *
+     *  If the buffer is bounded and full, the wafers that do not fit stay on the carrier and the
+     *  chamber is blocked (ChamberStats::blockedMinutes) until the next stage takes some.
+     */
+    void attachOutputBuffer(StageQueue* buffer) { outputQueue = buffer; }
+
+    /**
+     * @brief Appends every wafer this chamber unloads to `finished`, for main to act on between
+     *        ticks (e.g. TaskGraph::complete releasing the next wafers of a lot).
+     *
+     * @param finished Owned by the caller, one per chamber; reserve it and clear it after reading
+     */
+    void attachCompletions(std::vector<Task*>* finished) { finishedWafers = finished; }
+
+    /// Books the wafers still on the carrier at minute `tEnd` with their residence so far.
+    void censorQueueing(int tEnd) const;
+
+    /**
+     * @brief Defect hazard per powered minute for `task` on this stage:
+     *        phase[0].defectChance combined with the flux map's wake intrusion.
+     */
+    double minuteHazard(const Task& task) const;
+
+    /**
+     * @brief Jumps the carrier forward by up to `maxMinutes` powered minutes in one step.
+     *
+     * Stops early at phase completion or at the first defect on any wafer (which is marked),
+     * so an event-driven caller can react to it. The defect time is drawn once per uninterrupted
+     * span, and update() runs each powered minute through here (maxMinutes = 1), so a jump gives
+     * the same completion, defect minute and film as stepping minute by minute (tests/module_checks).
+     *
+     * @return Minutes actually advanced (0 if idle).
+     *
+     * @note The caller is responsible for the power: carrier draw W for each advanced minute, and
+     *       for its solar / battery split. Wafer maps get the n minutes of film and contamination.
+     */
+    int fastForward(int maxMinutes);
+
+    /**
+     * @brief Takes the chamber out of service (or back). Call between ticks.
+     *
+     *  While down the chamber does nothing: no unload, load, calibration or draw. Wafers on the
+     *  carrier are interrupted and keep their progress; their defect span ends.
+     */
+    void setDown(bool isDown);
+    bool isDown() const { return down; }
+
+    /// Marks the end of an uninterrupted span (e.g. the caller could not supply power).
+    void interruptSpan() { for (auto& slot : carrier) slot.spanOpen = false; }
+
+    /// Task currently on the stage (nullptr if idle); the first wafer in batch mode.
+    Task* currentTask() const { return activeTask; }
+    std::size_t carrierLoad() const { return carrier.size(); }
+    std::vector<Task*> carrierTasks() const;   ///< Wafers on the carrier, in load order
+    Task* carrierTask(std::size_t i) const { return carrier[i].task; }   ///< i < carrierLoad(), no copy
+    int loadedAt() const { return carrierLoadedAt; }   ///< minute the current carrier was loaded
+    /// Minutes of calibration and work left before the carrier unloads, if it always gets power.
+    int minutesToUnload() const;
+    int cooldownLeft() const { return cooldownRemaining; }
+    int carrierDraw() const { return carrier.empty() ? 0 : carrierPower(); }
+
+    int chamber() const { return chamberId; }
+    const std::string& name() const { return moduleName; }
+    const ChamberStats& chamberStats() const { return stats; }
+    bool isCalibrating()  const { return calibrationRemaining > 0; }
+    bool isCoolingDown()  const { return cooldownRemaining > 0; }
+    bool isBlocked()      const { return blocked; }   ///< holding finished wafers for a full output buffer
+
     /**
      * @brief Static helper function to simulate one minute of processing for a task.
      * 
-     * Logs debug info to file and probabilistically marks the task as defective.
+     * Logs debug info to file. Defects are no longer drawn here; see beginSpan().
+     * Called once per wafer on the carrier.
      * 
      * @param task   Reference to task being processed
      * @param power  Reference to power manager (to log post-power state)
@@ -0,0 +1,120 @@
+#ifndef ENERGY_LEDGER_HPP
+#define ENERGY_LEDGER_HPP
+
+#include "PowerBus.hpp"
+#include "Task.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief  Solar vs battery attribution of every watt-minute drawn from the power bus.
+ *
+ *  PowerModule::consumePower() returns the solar / battery split of a draw. A stage that
+ *  spreads one draw over several wafers (a carrier) hands it out with a DrawSplitter, adds
+ *  each part to the wafer's PhaseInfo (under the phase lock it already holds) and books it
+ *  in its EnergyLedger for the per-orbit roll-up:
+ *
+ *      const PowerDraw draw = power.consumePower(watts);
+ *      energy::DrawSplitter split(draw);
+ *      for (wafer : carrier) {
+ *          const energy::Split part = split.take(wafer watts);
+ *          phase.solarEnergy += part.solar; phase.batteryEnergy += part.battery;
+ *          ledger->book(t, stage, part);
+ *      }
+ *
+ *  Amounts are fixed-point integers (1/1000 W·min), so the parts of a draw add up to the
+ *  draw exactly and ledger totals can be checked against the bus. One ledger per chamber
+ *  (single writer, no locks), merged at the end of the run. Wafers are closed once, by
+ *  whoever sees them leave the line, so a merged ledger counts each wafer once.
+ */
+namespace energy {
+
+using MilliWattMinutes = std::int64_t;
+constexpr MilliWattMinutes SCALE = 1000;   ///< fixed-point units per W·min
+constexpr int ORBIT_MINUTES = 90;          ///< 45 sunlight + 45 eclipse, as driven by main
+constexpr int STAGES = 3;
+
+enum class Source : std::uint8_t { Solar = 0, Battery = 1 };
+
+struct Split {
+    MilliWattMinutes solar   = 0;
+    MilliWattMinutes battery = 0;
+};
+
+/**
+ * @brief Hands out one PowerDraw to several consumers in proportion to their watts.
+ *
+ * Each take() gets its share of the solar still unassigned; the last one (whose watts use up
+ * the draw) gets exactly what is left, so the parts always sum to the draw. Two integer ops.
+ */
+class DrawSplitter {
+public:
+    explicit DrawSplitter(const PowerDraw& draw)
+        : solarLeft_(draw.solar * SCALE), wattsLeft_(draw.total()) {}
+
+    Split take(int watts) {
+        Split part;
+        part.solar = wattsLeft_ > 0 ? solarLeft_ * watts / wattsLeft_ : 0;
+        part.battery = watts * SCALE - part.solar;
+        solarLeft_ -= part.solar;
+        wattsLeft_ -= watts;
+        return part;
+    }
+
+private:
+    MilliWattMinutes solarLeft_;
+    MilliWattMinutes wattsLeft_;
+};
+
+/// Energy per stage and source over one orbit.
+struct OrbitRollup {
+    std::array<std::array<MilliWattMinutes, 2>, STAGES> drawn{};   // [stage][Source]
+
+    MilliWattMinutes total(Source source) const;
+};
+
+class EnergyLedger {
+public:
+    /// Reserves the roll-ups for a run of `minutes`, so booking never allocates.
+    explicit EnergyLedger(int minutes = 0);
+
+    /// Books one part of a draw at minute `t` on `stage` (0 deposition, 1 ion, 2 crystal).
+    void book(int t, int stage, const Split& part) {
+        const std::size_t orbit = static_cast<std::size_t>(t / ORBIT_MINUTES);
+        if (orbit >= orbits_.size()) orbits_.resize(orbit + 1);
+        auto& cell = orbits_[orbit].drawn[static_cast<std::size_t>(stage)];
+        cell[0] += part.solar;
+        cell[1] += part.battery;
+    }
+
+    /// A wafer leaving the line (its last stage, or scrapped): its battery energy (all phases)
+    /// goes into the per-wafer figures. Close each wafer in one ledger only.
+    void closeWafer(const Task& wafer);
+
+    void merge(const EnergyLedger& other);
+
+    const std::vector<OrbitRollup>& orbits() const { return orbits_; }
+    MilliWattMinutes total(Source source) const;
+    std::uint64_t wafersClosed() const { return wafers_; }
+
+    /// Per-orbit solar / battery table, run totals and battery W·min per wafer.
+    void report(std::ostream& out) const;
+
+private:
+    std::vector<OrbitRollup> orbits_;
+    std::uint64_t wafers_ = 0;
+    MilliWattMinutes waferBattery_ = 0;              // sum over closed wafers
+    MilliWattMinutes worstBattery_ = 0;
+    const Task* worstWafer_ = nullptr;               // owned by main, outlives the report
+};
+
+/// W·min as a double, for printing.
+inline double wattMinutes(MilliWattMinutes v) { return static_cast<double>(v) / static_cast<double>(SCALE); }
+
+}  // namespace energy
+
+#endif  // ENERGY_LEDGER_HPP
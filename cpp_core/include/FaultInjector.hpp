@@ -0,0 +1,140 @@
+#ifndef FAULT_INJECTOR_HPP
+#define FAULT_INJECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+class PowerModule;
+class DepositionModule;
+class IonImplantationModule;
+class CrystalGrowthModule;
+
+/**
+ * @brief  Scheduled and stochastic power / equipment faults, driven by an event queue.
+ *
+ *  Each FaultSpec is one failure mode on one target. A scheduled fault strikes at `at`; a
+ *  stochastic one strikes after an exponential time with mean `mtbf`, and again after each
+ *  repair. A fault with a repair time is undone that many minutes later (exponential with
+ *  that mean for stochastic faults, exact for scheduled ones); 0 ⇒ permanent.
+ *
+ *      panel        a solar string is lost: generation -size W (default one of the 4 strings)
+ *      cell         a battery cell fails: capacity -size mWh (permanent; repair is ignored)
+ *      battery_trip the battery disconnects: no draw and no charge until repaired
+ *      heater       the crystal growth heater fails: no growth, reheat or hold
+ *      chamber      deposition chamber `target` is down (a target past the attached chambers is ignored)
+ *      implanter    the ion implanter is down (a running beam trips)
+ *
+ *  Failures and repairs are events in a min-heap keyed by (minute, sequence), so ties apply
+ *  in a fixed order. Between events advance() is one comparison with the heap top:
+ *
+ *      faults::FaultInjector injector(specs, seed);
+ *      injector.attachPower(&power); injector.attachChamber(chamber.get()); ...
+ *      for (t...) { injector.advance(t); power.update(t, phase); ... }
+ *
+ *  Overlapping faults on one target stack (two lost strings, a chamber down twice) and the
+ *  target recovers only when every one of them is repaired. Everything is applied by the
+ *  thread that drives the tick, between ticks, so the targets need no locks.
+ */
+namespace faults {
+
+enum class FaultKind : std::uint8_t { Panel, Cell, BatteryTrip, Heater, Chamber, Implanter };
+
+const char* toString(FaultKind kind);
+/// "panel", "cell", ...; false for an unknown name.
+bool parseKind(const std::string& name, FaultKind& kind);
+
+struct FaultSpec {
+    FaultKind kind = FaultKind::Chamber;
+    int target = -1;       ///< chamber index (FaultKind::Chamber, required); unused otherwise
+    int at = -1;           ///< scheduled minute; -1 ⇒ stochastic
+    double mtbf = 0.0;     ///< stochastic: mean minutes between a repair and the next failure
+    double repair = 0.0;   ///< minutes until repaired (mean, if stochastic); 0 ⇒ permanent
+    int size = 0;          ///< W (panel) or mWh (cell); 0 ⇒ the default for the kind
+};
+
+/**
+ * @brief Reads one spec per line: key=value fields, '#' comments.
+ *        kind=<name> [target=<chamber>] (at=<minute> | mtbf=<minutes>) [repair=<minutes>] [size=<n>]
+ *
+ * @return false (with `error` naming the line) on an unknown kind or key, a line with neither at nor
+ *         mtbf, or a chamber fault without a target ≥ 0.
+ */
+bool loadSpecs(const std::string& path, std::vector<FaultSpec>& specs, std::string& error);
+
+struct FaultStats {
+    std::uint64_t injected = 0;
+    std::uint64_t repaired = 0;
+    long long faultMinutes = 0;   ///< minutes under this fault, summed over its occurrences (open ones to the end)
+};
+
+class FaultInjector {
+public:
+    static constexpr int PANEL_STRING_WATTS = 75;    ///< W per string: the 300 W array is wired in 4
+    static constexpr int CELL_CAPACITY = 25'000;     ///< mWh lost per failed cell (1 / 10 of the pack)
+
+    FaultInjector(const std::vector<FaultSpec>& specs, std::uint64_t seed);
+
+    void attachPower(PowerModule* power) { power_ = power; }
+    /// Chambers in index order; FaultSpec::target indexes them.
+    void attachChamber(DepositionModule* chamber) { chambers_.push_back(chamber); }
+    void attachImplanter(IonImplantationModule* implanter) { implanter_ = implanter; }
+    void attachFurnace(CrystalGrowthModule* furnace) { furnace_ = furnace; }
+
+    /// Applies every failure and repair due at or before minute `t`. O(1) when none is.
+    void advance(int t) {
+        if (!heap_.empty() && heap_.front().minute <= t) fire(t);
+    }
+    /// Minute of the next failure or repair; std::numeric_limits<int>::max() if none is left.
+    int nextEventAt() const;
+
+    std::size_t active() const { return active_; }   ///< faults in effect right now
+    const std::vector<FaultSpec>& specs() const { return specs_; }
+    const FaultStats& stats(std::size_t spec) const { return stats_[spec]; }
+
+    /// Per-spec injections, repairs and fault minutes up to `tEnd`.
+    void report(std::ostream& out, int tEnd) const;
+
+private:
+    struct Event {
+        int minute = 0;
+        std::uint64_t seq = 0;
+        std::uint32_t spec = 0;
+        bool repair = false;
+    };
+    static bool later(const Event& a, const Event& b) {
+        return a.minute != b.minute ? a.minute > b.minute : a.seq > b.seq;
+    }
+
+    void fire(int t);
+    void schedule(int minute, std::uint32_t spec, bool repair);
+    int sampleMinutes(double mean);
+    /// Applies (+1) or undoes (-1) one fault of `spec` on its target.
+    void apply(const FaultSpec& spec, int delta);
+
+    std::vector<FaultSpec> specs_;
+    std::vector<FaultStats> stats_;
+    std::vector<int> since_;                 // per spec: minute the open fault struck (-1 ⇒ none)
+    std::vector<Event> heap_;                // std::push_heap / pop_heap with later()
+    std::uint64_t seq_ = 0;
+    std::size_t active_ = 0;
+    std::mt19937_64 rng_;
+    std::exponential_distribution<double> unitExp_{1.0};
+
+    PowerModule* power_ = nullptr;
+    std::vector<DepositionModule*> chambers_;
+    IonImplantationModule* implanter_ = nullptr;
+    CrystalGrowthModule* furnace_ = nullptr;
+    int panelLost_ = 0;                      // W of generation currently lost
+    int batteryTrips_ = 0;
+    int heaterFaults_ = 0;
+    int implanterFaults_ = 0;
+    std::vector<int> chamberFaults_;         // per chamber
+};
+
+}  // namespace faults
+
+#endif  // FAULT_INJECTOR_HPP
@@ -0,0 +1,85 @@
+#ifndef INTROSPECTION_HPP
+#define INTROSPECTION_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief  Read-only view of a running simulation, published by the main loop.
+ *
+ *  Main builds one after every minute's barrier (the chambers are parked, so nothing is
+ *  read mid-update) and swaps it in atomically; the server only ever reads the last one.
+ */
+struct RunSnapshot {
+    struct Chamber {
+        std::string name;
+        std::string state;                  // idle / calibrating / running / cooling
+        std::vector<std::string> carrier;   // wafer ids on the chamber
+        int completed = 0;
+        int powerDeniedMinutes = 0;
+    };
+
+    static constexpr std::size_t QUEUE_PREVIEW = 32;   // queued ids listed per stage
+
+    int minute = 0;
+    int simDuration = 0;
+    std::string orbit;
+    int batteryLevel = 0;        // mWh
+    double batterySOC = 0.0;     // %
+    int powerAvailable = 0;      // W left in this minute's budget
+    int throughput = 0;          // wafers through deposition so far
+    int wafersTotal = 0;
+    std::size_t depositionQueued = 0;
+    std::vector<std::string> depositionQueue;   // first QUEUE_PREVIEW ids
+    std::vector<Chamber> chambers;
+};
+
+class SnapshotPublisher {
+public:
+    void publish(std::shared_ptr<const RunSnapshot> snapshot) { std::atomic_store(&current_, std::move(snapshot)); }
+    std::shared_ptr<const RunSnapshot> latest() const { return std::atomic_load(&current_); }
+
+private:
+    std::shared_ptr<const RunSnapshot> current_;
+};
+
+/**
+ * @brief  Line-based query server on a Unix domain socket (one client at a time).
+ *
+ *  Commands (one per line); every reply ends with a line containing only "."
+ *      minute | battery | throughput | queues | metrics | all | help | quit
+ *  e.g.  printf 'all\n' | nc -U /tmp/spaceforge.sock
+ *
+ *  Replies are built from the published RunSnapshot and metrics::registry().snapshot(),
+ *  never from live module state.
+ */
+class IntrospectionServer {
+public:
+    IntrospectionServer(std::string socketPath, const SnapshotPublisher& publisher);
+    ~IntrospectionServer();
+
+    IntrospectionServer(const IntrospectionServer&) = delete;
+    IntrospectionServer& operator=(const IntrospectionServer&) = delete;
+
+    bool start();   // false if the socket cannot be bound
+    void stop();    // joins the server thread and removes the socket file
+
+    /// Reply to one command line (exposed so it can be exercised without a socket).
+    std::string handle(const std::string& command) const;
+
+private:
+    void serve();
+    void serveClient(int fd);
+
+    std::string path_;
+    const SnapshotPublisher& publisher_;
+    int listenFd_ = -1;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+#endif  // INTROSPECTION_HPP
@@ -0,0 +1,161 @@
+#ifndef ION_IMPLANTATION_MODULE_HPP
+#define ION_IMPLANTATION_MODULE_HPP
+
+#include "Task.hpp"
+#include "PowerBus.hpp"
+#include "Logger.hpp"
+#include "DefectModel.hpp"
+#include "StageQueue.hpp"
+#include "ProfiledMutex.hpp"
+#include "EnergyLedger.hpp"
+#include "QueueingAnalyzer.hpp"
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Beam and dose settings of the implanter.
+ *
+ *  The beam current scales with the power the bus grants, from beamCurrentMa at runPower
+ *  down to minBeamPower; below that the source cannot hold the beam and it trips. With the
+ *  defaults a wafer reaches its dose in about 19 beam minutes at full power.
+ */
+struct ImplantConfig {
+    int calibrationMinutes = 3;     ///< beam tune at calibrationPower, before every wafer and after every trip
+    int calibrationPower   = 100;   ///< W drawn per tuning minute
+    int cooldownMinutes    = 5;     ///< idle minutes after a wafer leaves
+    int runPower           = 200;   ///< W asked for per beam minute
+    int minBeamPower       = 100;   ///< W below which the beam trips (interruption)
+    double beamCurrentMa   = 1.0;   ///< beam current at runPower [mA]
+    double waferAreaCm2    = 706.9; ///< scanned area (300 mm wafer) [cm²]
+    double targetDose      = 1.0e16;   ///< ions/cm² per wafer; the wafer is done when it gets there
+    double driftSigma      = 0.01;  ///< per beam minute, log-normal step of the current vs its tune
+    double driftLimit      = 0.05;  ///< |drift| past which the beam is re-tuned (no retry spent)
+    int maxRetries         = 2;     ///< beam trips a wafer may resume from; one more scraps it
+};
+
+/**
+ * @brief Simulated-minute accounting for the implanter (read after the run).
+ */
+struct ImplantStats {
+    int completed          = 0;   ///< wafers that reached their dose
+    int scrapped           = 0;   ///< wafers past maxRetries, scrapped with a partial dose
+    int resumed            = 0;   ///< trips a wafer resumed from with its dose kept
+    int retunes            = 0;   ///< re-tunes for drift out of band
+    int beamMinutes        = 0;   ///< minutes the beam was on
+    int reducedBeamMinutes = 0;   ///< of which with less than runPower
+    int calibratingMinutes = 0;
+    int coolingMinutes     = 0;
+    int idleMinutes        = 0;   ///< no wafer in the buffer
+    int powerDeniedMinutes = 0;   ///< wafer present but not enough power to tune or hold the beam
+    int downMinutes        = 0;   ///< out of service (FaultInjector.hpp)
+    double doseDelivered   = 0.0; ///< ions/cm², every wafer
+    double doseKept        = 0.0; ///< partial dose carried across trips, each wafer's counted once (time-based: scrapped)
+    double doseScrapped    = 0.0; ///< partial dose of the scrapped wafers
+    long long waferWaitMinutes = 0;   ///< Σ (load minute - Task::readyMinute)
+};
+
+/**
+ * @brief Single-wafer ion implanter fed by the deposition → ion implantation buffer.
+ *
+ *  Implantation is about total dose (ions per cm²), not time. Every beam minute the module
+ *  takes what the bus can give up to runPower, turns it into beam current, scales it by the
+ *  drift since the last tune and integrates the dose into PhaseInfo::dose; the wafer is done
+ *  when the dose reaches targetDose, so a weak or drifting beam costs minutes, not yield.
+ *  PhaseInfo::elapsedTime counts beam minutes; requiredTime stays the nominal estimate.
+ *
+ *  When the beam trips (less than minBeamPower), the wafer keeps its partial dose, the beam
+ *  is tuned again once power is back and the wafer resumes; after maxRetries trips it is
+ *  scrapped (PhaseInfo::defective) instead. Drift beyond driftLimit forces a re-tune.
+ *
+ *  Runs on main between ticks, after crystal growth and the deposition chambers took their
+ *  power, so it gets what is left of the minute's budget.
+ */
+class IonImplantationModule {
+public:
+    static constexpr double ELEMENTARY_CHARGE = 1.602176634e-19;   ///< C
+
+    /**
+     * @param input Buffer the implanter pulls wafers from (not owned)
+     * @param cfg   Beam, dose and retry settings
+     */
+    explicit IonImplantationModule(StageQueue* input, const ImplantConfig& cfg = ImplantConfig());
+
+    /// Seeds the defect and drift streams (one per module, like the deposition chambers).
+    void seed(std::uint64_t seed);
+    std::uint64_t defectDraws() const { return defects.draws(); }
+
+    /// Books the solar / battery split of every draw in `ledger` (stage 1); nullptr ⇒ off.
+    void attachEnergyLedger(energy::EnergyLedger* ledger) { energyLedger = ledger; }
+
+    /// Reports buffer waits, residence and cycles to `observation`; nullptr ⇒ off.
+    void attachQueueing(queueing::StageObservation* observation) { queueStats = observation; }
+
+    /// Hands implanted wafers to `buffer` (unbounded: the implanter never blocks); scrapped ones stay out.
+    void attachOutputBuffer(StageQueue* buffer) { outputQueue = buffer; }
+
+    /// Appends every wafer scrapped here (it leaves the line) to `scrapped`; nullptr ⇒ off.
+    void attachScrapped(std::vector<Task*>* scrapped) { scrappedWafers = scrapped; }
+
+    /**
+     * @brief One minute: unload a finished (or scrapped) wafer, cool down, load, tune, or
+     *        run the beam on whatever power is left.
+     *
+     * @note Same signature as DepositionModule::update(); powerMutex is held only around the draw.
+     */
+    void update(int t, PowerModule& power, Logger& logger, ProfiledMutex* powerMutex, std::atomic<int>* orbitState);
+
+    /// Dose per minute [ions/cm²] of a tuned beam on `watts` (0 below minBeamPower).
+    double doseRate(int watts) const;
+
+    /**
+     * @brief Takes the implanter out of service (or back), between ticks.
+     *
+     *  A running beam trips, so the wafer goes through the bounded retry like any other trip;
+     *  while down the module does nothing at all.
+     */
+    void setDown(bool isDown);
+    bool isDown() const { return down; }
+
+    /// Books the wafer still in the implanter at minute `tEnd` with its residence so far.
+    void censorQueueing(int tEnd) const;
+
+    Task* currentTask() const { return activeTask; }
+    double beamDrift() const { return drift; }
+    const ImplantConfig& implantConfig() const { return config; }
+    const ImplantStats& implantStats() const { return stats; }
+    bool isCalibrating()  const { return calibrationRemaining > 0; }
+    bool isCoolingDown()  const { return cooldownRemaining > 0; }
+    const std::string& name() const { return moduleName; }
+
+private:
+    /// Unloads the wafer: it leaves the stage (done, or scrapped past maxRetries).
+    void unload(int t);
+    /// Beam trip: keep the dose and re-tune, or scrap past maxRetries.
+    void trip();
+
+    StageQueue* inputQueue = nullptr;
+    StageQueue* outputQueue = nullptr;   ///< Buffer to crystal growth (nullptr ⇒ wafers just leave)
+    ImplantConfig config;
+    ImplantStats stats;
+    std::string moduleName = "IonImplantation";   ///< Module column in the log
+    Task* activeTask = nullptr;
+    int loadedAt = -1;
+    int calibrationRemaining = 0;
+    int cooldownRemaining    = 0;
+    bool scrapPending = false;            ///< trip past maxRetries: unload as defective
+    bool down = false;                    ///< out of service: setDown()
+    double drift = 1.0;                   ///< beam current / tuned current
+    double doseAtLastTrip = 0.0;          ///< loaded wafer's dose when its beam last tripped
+
+    DefectSampler defects;                ///< Per-module RNG stream for defect draws
+    std::mt19937_64 driftRng;             ///< separate, so drift never shifts the defect stream
+    std::normal_distribution<double> driftStep{0.0, 1.0};
+    energy::EnergyLedger* energyLedger = nullptr;
+    queueing::StageObservation* queueStats = nullptr;
+    std::vector<Task*>* scrappedWafers = nullptr;
+};
+
+#endif  // ION_IMPLANTATION_MODULE_HPP
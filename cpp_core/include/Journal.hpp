@@ -0,0 +1,171 @@
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief  Deterministic record / replay of a run.
+ *
+ *  Everything a run depends on besides the code is either an input or an ordering:
+ *    - inputs: run parameters, the defect seed and the wafer arrivals (written once, up front)
+ *    - ordering: which chamber went first through each shared-state section in a minute
+ *      (loading from the shared StageQueue, drawing from the power bus, unloading into a
+ *      bounded buffer)
+ *  Per-chamber RNG streams are deterministic once both are fixed; their positions (draws so
+ *  far) are written with a state hash at the end of every minute, so replay can tell the
+ *  exact minute it stopped matching.
+ *
+ *  Record: chambers wrap each shared section in a journal::Turn, which serialises the
+ *  sections and appends (point, chamber) — 2 bytes, into an in-memory buffer flushed by main.
+ *  Replay: the same Turn blocks each chamber until it is next in the recorded order, however
+ *  long that takes. The run has diverged only when it can no longer follow the order: every
+ *  chamber still in its minute is waiting and none of them is next (the recorded one already
+ *  arrived at the barrier, or never takes that section).
+ *
+ *  File: "SFJ1" + version byte, then tagged records with LEB128 varints:
+ *      'P' param    key, value (zig-zag)       'S' seed      stream, value
+ *      'A' arrival  minute, id, recipe, 3×required, 3×defectChance (raw doubles), lot, #after, after ids
+ *      'T' turn     point, chamber             'M' minute    t, state hash, draws per chamber
+ */
+namespace journal {
+
+/// Shared-state sections whose order between chambers is recorded.
+enum class Point : std::uint8_t { Load = 1, Power = 2, Unload = 3 };
+
+struct TaskArrival {
+    int minute = 0;
+    std::string id;
+    std::string recipe;
+    std::string lot;
+    std::vector<std::string> after;   // precedence edges (TaskGraph.hpp)
+    std::array<int, 3> requiredTime{};
+    std::array<double, 3> defectChance{};
+};
+
+struct RunInputs {
+    std::vector<std::pair<std::string, std::int64_t>> params;   // in recording order
+    std::uint64_t seed = 0;
+    std::vector<TaskArrival> arrivals;
+
+    void setParam(const std::string& key, std::int64_t value);
+    std::int64_t param(const std::string& key, std::int64_t fallback) const;
+    /// A double kept exactly: its bit pattern is stored as the int64 param.
+    void setRealParam(const std::string& key, double value);
+    double realParam(const std::string& key, double fallback) const;
+};
+
+/// End-of-minute state: hash of the run state plus the position of every chamber's RNG stream.
+struct Checkpoint {
+    std::uint64_t stateHash = 0;
+    std::vector<std::uint64_t> rngDraws;   // one per chamber
+};
+
+/// FNV-1a over the values that make up a checkpoint.
+class StateHash {
+public:
+    void add(std::uint64_t v);
+    void add(std::int64_t v) { add(static_cast<std::uint64_t>(v)); }
+    void add(int v) { add(static_cast<std::uint64_t>(static_cast<std::int64_t>(v))); }
+    void add(bool v) { add(static_cast<std::uint64_t>(v)); }
+    void add(const std::string& s);
+    std::uint64_t value() const { return hash_; }
+
+private:
+    std::uint64_t hash_ = 14695981039346656037ull;
+};
+
+class Journal {
+public:
+    enum class Mode { Off, Record, Replay };
+
+    Journal() = default;
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    /// Creates `path` and writes the run inputs; false (and Mode::Off) if it cannot be opened.
+    bool startRecording(const std::string& path, const RunInputs& inputs);
+    /// Reads a whole journal into memory; false (and Mode::Off) on a missing or malformed file.
+    bool loadReplay(const std::string& path);
+
+    Mode mode() const { return mode_; }
+    const RunInputs& inputs() const { return inputs_; }   ///< replay: the recorded inputs
+    int recordedMinutes() const { return static_cast<int>(minutes_.size()); }
+
+    /* ---------- chamber threads (via Turn) ---------- */
+    void enter(Point point, int chamber);
+    void leave();
+    /// The chamber is done with its minute (before TickBarrier::arrive); replay stops expecting it.
+    void arrive();
+
+    /* ---------- main thread, chambers parked at the barrier ---------- */
+    void beginMinute(int t, int chambers);
+    /// Record: appends the checkpoint. Replay: compares it; false from the first divergence on.
+    bool endMinute(int t, const Checkpoint& checkpoint);
+    int divergedAt() const { return divergedAt_; }   ///< -1 while replay matches the journal
+
+    void close();   ///< flushes a recording
+
+private:
+    struct Turn {
+        Point point;
+        int chamber;
+    };
+    struct MinuteLog {
+        std::vector<Turn> turns;
+        Checkpoint checkpoint;
+    };
+
+    void flush();
+    void markDiverged(int t, const char* why);
+    /// Replay, turnMutex_ held: diverged if every running chamber waits and the next is not among them.
+    void checkStalled();
+
+    Mode mode_ = Mode::Off;
+    RunInputs inputs_;
+
+    // record
+    std::ofstream file_;
+    std::vector<std::uint8_t> buffer_;   // reserved up front; flushed by main at minute end
+    std::mutex sectionMutex_;            // held from enter() to leave(): defines the order
+
+    // replay
+    std::vector<MinuteLog> minutes_;
+    std::mutex turnMutex_;
+    std::condition_variable turnCv_;
+    int minute_ = 0;
+    std::size_t cursor_ = 0;             // next turn of minutes_[minute_]
+    int running_ = 0;                    // chambers not yet arrived this minute
+    int waitingCount_ = 0;               // of which blocked in enter()
+    std::vector<char> waiting_;          // per chamber: blocked in enter()
+    int divergedAt_ = -1;                // once set, chambers run free (no more ordering)
+};
+
+/// Holds the calling chamber's turn through a shared-state section; no-op without a journal.
+class Turn {
+public:
+    Turn(Journal* journal, Point point, int chamber)
+        : journal_(journal && journal->mode() != Journal::Mode::Off ? journal : nullptr) {
+        if (journal_) journal_->enter(point, chamber);
+    }
+    ~Turn() { if (journal_) journal_->leave(); }
+
+    Turn(const Turn&) = delete;
+    Turn& operator=(const Turn&) = delete;
+
+private:
+    Journal* journal_;
+};
+
+}  // namespace journal
+
+#endif  // JOURNAL_HPP
@@ -5,12 +5,13 @@
 #include <string>
 #include <mutex>
 #include <atomic>
+#include "ProfiledMutex.hpp"
 
 class Logger {
 private:
     std::ofstream file;
-    std::mutex logMutex;
-    int throughput = 0;
+    ProfiledMutex logMutex{"logger"};
+    std::atomic<int> throughput{0};   // chambers on different threads complete wafers
 
 public:
     Logger(const std::string& filename = "logV1.csv");
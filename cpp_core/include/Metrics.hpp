@@ -0,0 +1,140 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief  Run-wide metrics: counters, gauges and fixed-bucket histograms.
+ *
+ *  Look a metric up once (registration takes a lock) and keep the reference; updates are
+ *  relaxed atomics on a per-thread shard, so chambers never bounce one cache line:
+ *
+ *      static metrics::Counter& denied = metrics::registry().counter("deposition.power_denied_minutes");
+ *      denied.add();
+ *
+ *  snapshot() may be taken from any thread while the run is going; dump() prints the
+ *  end-of-run summary.
+ */
+namespace metrics {
+
+constexpr std::size_t SHARDS = 16;
+
+/// Nanoseconds since `start` — for wait / latency histograms.
+inline double nanosSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Shard of the calling thread (assigned round-robin on first use).
+std::size_t threadShard();
+
+struct alignas(64) PaddedCount {
+    std::atomic<std::uint64_t> value{0};
+};
+
+class Counter {
+public:
+    void add(std::uint64_t n = 1) { shards_[threadShard()].value.fetch_add(n, std::memory_order_relaxed); }
+    std::uint64_t value() const;
+
+private:
+    std::array<PaddedCount, SHARDS> shards_;
+};
+
+/// Last value set, plus the high-water mark (e.g. queue depth, battery level).
+class Gauge {
+public:
+    void set(std::int64_t v);
+    void add(std::int64_t d);
+    std::int64_t value() const { return value_.load(std::memory_order_relaxed); }
+    std::int64_t max()   const { return max_.load(std::memory_order_relaxed); }
+
+private:
+    void raiseMax(std::int64_t v);
+
+    std::atomic<std::int64_t> value_{0};
+    std::atomic<std::int64_t> max_{INT64_MIN};
+};
+
+/// Counts per bucket; bucket i holds v ≤ bounds[i], the last bucket everything above.
+class Histogram {
+public:
+    explicit Histogram(std::vector<double> upperBounds);
+
+    void observe(double v);
+
+    const std::vector<double>& bounds() const { return bounds_; }
+    std::vector<std::uint64_t> counts() const;   // bounds().size() + 1 entries
+    std::uint64_t count() const;
+    double sum() const;
+
+    /// start, start·factor, … (`n` bounds) — e.g. exponential(64, 2, 21) covers 64 ns … 67 ms.
+    static std::vector<double> exponential(double start, double factor, int n);
+
+private:
+    struct alignas(64) Shard {
+        std::unique_ptr<std::atomic<std::uint64_t>[]> counts;
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<double> sum{0.0};
+    };
+
+    std::vector<double> bounds_;
+    std::array<Shard, SHARDS> shards_;
+};
+
+struct HistogramSnapshot {
+    std::vector<double> bounds;
+    std::vector<std::uint64_t> counts;
+    std::uint64_t count = 0;
+    double sum = 0.0;
+
+    double mean() const { return count ? sum / static_cast<double>(count) : 0.0; }
+    /// Upper bound of the bucket holding quantile q (an upper estimate; +inf for the overflow bucket).
+    double quantile(double q) const;
+};
+
+struct GaugeSnapshot {
+    std::int64_t value = 0;
+    std::int64_t max = 0;
+};
+
+struct Snapshot {
+    std::map<std::string, std::uint64_t> counters;
+    std::map<std::string, GaugeSnapshot> gauges;
+    std::map<std::string, HistogramSnapshot> histograms;
+};
+
+class Registry {
+public:
+    /// Returns the metric called `name`, creating it on first use; references stay valid.
+    Counter&   counter(const std::string& name);
+    Gauge&     gauge(const std::string& name);
+    Histogram& histogram(const std::string& name, const std::vector<double>& upperBounds);
+
+    Snapshot snapshot() const;
+
+    /// End-of-run summary: one line per metric, histograms as count / mean / p50 / p99.
+    void dump(std::ostream& out) const;
+
+private:
+    mutable std::mutex mutex_;   // registration and snapshot only
+    std::map<std::string, std::unique_ptr<Counter>>   counters_;
+    std::map<std::string, std::unique_ptr<Gauge>>     gauges_;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms_;
+};
+
+/// The process-wide registry.
+Registry& registry();
+
+}  // namespace metrics
+
+#endif  // METRICS_HPP
@@ -0,0 +1,142 @@
+#ifndef PLANNER_HPP
+#define PLANNER_HPP
+
+#include "ReservationCalendar.hpp"
+#include "Task.hpp"
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief  Forward deposition plan on a ReservationCalendar, repaired locally as the run drifts.
+ *
+ *  Every wafer not yet on a carrier holds one window: chamber, start, calibration + work +
+ *  cooldown minutes at the single-wafer draw, no earlier than its predecessors (Task::after)
+ *  finish. Chambers that are busy in the simulation hold a pin: [next minute, end of their
+ *  cooldown) at the carrier's draw. Between ticks main reports what happened:
+ *
+ *      planner.started(wafer, chamber);          // loaded this minute: its window becomes the pin
+ *      planner.pin(chamber, t + 1, unload, until, watts);
+ *      planner.finished(wafer, t);               // a defective wafer drops its descendants
+ *      planner.repair(t + 1);
+ *
+ *  repair() re-slots only the impacted wafers: those evicted by a pin that grew (power
+ *  denied, a bigger carrier, a chamber that took someone else's wafer), those whose start
+ *  went by without them loading, and, transitively, successors that would now start before
+ *  their predecessor finishes. They are taken in the order of their previous start, so the
+ *  old plan is the warm start and its sequence survives. When more than half the waiting
+ *  wafers (at least Config::repairBudget) are impacted, a repair would cost about as much as
+ *  starting over, so it escalates to replan(): every waiting window is cancelled and
+ *  re-booked in precedence order around the pins.
+ *
+ *  The plan is advisory: dispatch still follows the StageQueue. Wafers that do not fit in the
+ *  horizon stay unplanned (start -1) until a later repair finds them room.
+ */
+namespace plan {
+
+class Planner {
+public:
+    struct Config {
+        int setupMinutes    = 0;     ///< calibration before the wafer's work
+        int cooldownMinutes = 0;     ///< chamber stays reserved after unloading
+        int watts           = 300;   ///< single-wafer draw booked for the whole window
+        std::size_t repairBudget = 16;   ///< floor of the impacted wafers a local repair may take on
+        bool alwaysReplan = false;   ///< baseline: every repair is a full replan
+    };
+
+    struct Stats {
+        std::uint64_t repairs     = 0;   ///< repair() calls that changed the plan locally
+        std::uint64_t replans     = 0;   ///< full replans, including the first plan
+        std::uint64_t escalations = 0;   ///< repairs over budget that became full replans
+        std::uint64_t reslotted   = 0;   ///< windows re-booked by local repairs
+        std::uint64_t evicted     = 0;   ///< windows a pin pushed out
+        std::uint64_t late        = 0;   ///< windows whose start passed without the wafer
+        std::uint64_t repairNs    = 0;
+        std::uint64_t repairNsMax = 0;
+        std::uint64_t replanNs    = 0;
+        std::uint64_t replanNsMax = 0;
+    };
+
+    Planner(int chambers, const std::vector<std::int64_t>& powerProfile, const Config& config);
+
+    /// Takes the wafers (file order; Task::after must name wafers in the set) and plans them from minute 0.
+    void build(const std::vector<Task*>& tasks);
+
+    void started(Task* task, int chamber);
+    /// Chamber commitment from `now`: unloads at `unload`, free again at `until` (≤ now ⇒ idle).
+    void pin(int chamber, int now, int unload, int until, int watts);
+    void finished(Task* task, int t);
+
+    /// Local repair of everything reported since the last call; returns the windows re-booked.
+    std::size_t repair(int now);
+    /// Cancels every waiting window and books them again in precedence order.
+    void replan(int now);
+
+    /// The waiting wafer planned next on `chamber` and its start; nullptr if the chamber has none.
+    Task* nextFor(int chamber, int& start) const;
+
+    const Stats& stats() const { return stats_; }
+    std::size_t planned() const;          ///< waiting wafers holding a window
+    int plannedFinish() const;            ///< last planned (or actual) unload over all wafers; -1 if none
+
+    void report(std::ostream& out, int actualFinish) const;
+
+private:
+    enum class State { Waiting, Running, Done, Dropped };
+
+    struct Job {
+        Task* task = nullptr;
+        std::vector<int> preds;
+        std::vector<int> succs;
+        State state = State::Waiting;
+        int reservation = -1;
+        int chamber = -1;
+        int start  = -1;   ///< -1 ⇒ unplanned
+        int finish = -1;   ///< unload minute: successors may load from here
+        int rank = 0;      ///< position in precedence order
+        bool dirty = false;
+    };
+
+    struct Pin {
+        int reservation = -1;
+        int until  = 0;
+        int unload = 0;
+        int watts  = 0;
+        std::vector<int> running;   ///< jobs on the carrier
+    };
+
+    int windowMinutes(const Job& job) const;
+    int readyAt(const Job& job, int now) const;
+    bool place(int j, int now);          ///< books the earliest window; false ⇒ unplanned
+    void unbook(int j);
+    void markDirty(int j);
+    /// First booked window on `chamber` starting ≥ from (optionally skipping dirty ones); -1 if none.
+    int nextOnChamber(int chamber, int from, bool skipDirty) const;
+    void forgetSkips();
+    void evictFor(int chamber, int now, int until, int watts);
+
+    ReservationCalendar calendar_;
+    Config config_;
+    std::vector<Job> jobs_;
+    std::unordered_map<const Task*, int> index_;
+    std::vector<int> topo_;                   // jobs in precedence order (file order among equals)
+    std::vector<Pin> pins_;
+    std::set<std::pair<int, int>> byStart_;   // (start, job) of the booked waiting windows
+    std::vector<int> dirty_;
+    std::size_t waiting_ = 0;                 // jobs in State::Waiting
+    std::vector<std::pair<std::int64_t, int>> heap_;   // repair order: (previous start, rank) → job
+    int skipFrom_ = INT_MAX;      // no window of skipMinutes_ or more starts in [skipFrom_, skipTo_)
+    int skipTo_   = INT_MIN;      // (INT_MAX ⇒ none in the horizon); valid until capacity is freed
+    int skipMinutes_ = 0;
+    Stats stats_;
+};
+
+}  // namespace plan
+
+#endif  // PLANNER_HPP
@@ -3,6 +3,13 @@
 
 #include <string>
 
+/// Where the watts of one consumePower() call came from; solar is always spent first.
+struct PowerDraw {
+    int solar   = 0;   // W this minute
+    int battery = 0;   // W this minute
+    int total() const { return solar + battery; }
+};
+
 /**
  * ESSENTIALLY A BLUEPRINT, functions are not implemented here.
  * @brief  Tracks solar-panel generation, battery state, and power consumption.
@@ -11,7 +18,7 @@
  *     power.update(t, orbitalPhase);          // refresh available power
  *     if (power.canSatisfyDemand(neededW)) {
  *         power.consumePower(neededW);        // deduct watts from budget
- *     }
+ *     }                                       // (returns the solar / battery split)
  */
 class PowerModule {
 public:
@@ -28,14 +35,24 @@ public:
     bool canSatisfyDemand(int watts) const;
         // Returns true if watts ≤ surplus for current minute
 
-    void consumePower(int watts);
-        // Deducts watts from available budget and draws from battery as needed
+    PowerDraw consumePower(int watts);
+        // Deducts watts from available budget; solar left this minute goes first,
+        // the rest is drawn from battery. Returns the split for energy attribution
 
     /* ---------- getters for other modules / logger ---------- */
     int  getAvailablePower() const;   // Remaining budget this minute (W)
     int  getBatteryLevel()   const;   // Battery state of charge (mWh)
     int  getLastProduced()   const;   // Solar generation this minute (W)
     double getSOC() const;   // SoC in percent (0–100)
+    long long getSolarDrawn()   const { return solarDrawn_; }     // W·min handed out from solar, whole run
+    long long getBatteryDrawn() const { return batteryDrawn_; }   // W·min handed out from battery, whole run
+    int  getCapacity()       const { return maxBattery_; }         // mWh, less any failed cells
+
+    /* ---------- fault hooks (FaultInjector.hpp), applied between minutes ---------- */
+    void setSolarDerate(int watts);         // W of generation lost to failed panel strings
+    void loseBatteryCapacity(int mWh);      // failed cells: permanent, the charge above the new capacity is lost
+    void setBatteryTripped(bool tripped);   // battery disconnected: no draw and no charge
+    bool isBatteryTripped() const { return batteryTripped_; }
 
 private:
     /* ---------- persistent state ---------- */
@@ -45,10 +62,17 @@ private:
     /* generation rates */
     int genSunlight_;        // W in full sunlight
     int genEclipse_;         // W in eclipse
+    int solarDerate_ = 0;    // W lost to panel faults
+    bool batteryTripped_ = false;
 
     /* ---------- per-minute scratch ---------- */
     int producedThisMinute_; // actual solar W produced this minute
     int budgetThisMinute_;   // reset by update()
+    int solarLeftThisMinute_ = 0;   // solar not yet handed to a consumer this minute
+
+    /* run totals, cross-check for the energy ledger */
+    long long solarDrawn_   = 0;
+    long long batteryDrawn_ = 0;
 
     /* helper */
     int solarGeneration(const std::string& phase) const;  // W for current phase
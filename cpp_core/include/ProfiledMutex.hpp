@@ -0,0 +1,66 @@
+#ifndef PROFILED_MUTEX_HPP
+#define PROFILED_MUTEX_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+/**
+ * @brief  Drop-in std::mutex replacement that profiles contention per named lock.
+ *
+ *  With SPACEFORGE_PROFILE_LOCKS defined (Debug builds, or -DSPACEFORGE_PROFILE_LOCKS=ON)
+ *  every lock records into metrics::registry():
+ *      lock.<name>.acquisitions / lock.<name>.contended      counters
+ *      lock.<name>.wait_ns      / lock.<name>.hold_ns        histograms
+ *  Otherwise ProfiledMutex *is* a std::mutex (the name is dropped); lock() tries first and
+ *  reads the clock only when that fails, so an uncontended lock costs one try_lock.
+ *  In both builds a contended lock adds its wait to the thread's usage::ThreadStats::lockWaitNs.
+ *
+ *  Use std::lock_guard<ProfiledMutex> / std::unique_lock<ProfiledMutex::lock_type>, and
+ *  ProfiledConditionVariable where a condition variable waits on one.
+ */
+#ifdef SPACEFORGE_PROFILE_LOCKS
+
+struct LockStats;
+
+class ProfiledMutex {
+public:
+    using lock_type = ProfiledMutex;
+
+    explicit ProfiledMutex(const char* name = "unnamed");
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+    void lock();
+    bool try_lock();
+    void unlock();
+
+private:
+    std::mutex mutex_;
+    LockStats* stats_;
+    std::chrono::steady_clock::time_point acquiredAt_;   // written by the holder only
+};
+
+using ProfiledConditionVariable = std::condition_variable_any;
+
+#else
+
+class ProfiledMutex : public std::mutex {
+public:
+    using lock_type = std::mutex;
+
+    explicit ProfiledMutex(const char* /*name*/ = "unnamed") {}
+
+    void lock() {
+        if (!try_lock()) lockContended();
+    }
+
+private:
+    void lockContended();   // blocks, then reports the wait to usage::addLockWait
+};
+
+using ProfiledConditionVariable = std::condition_variable;
+
+#endif  // SPACEFORGE_PROFILE_LOCKS
+
+#endif  // PROFILED_MUTEX_HPP
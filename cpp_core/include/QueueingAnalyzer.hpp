@@ -0,0 +1,136 @@
+#ifndef QUEUEING_ANALYZER_HPP
+#define QUEUEING_ANALYZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief  Per-stage queueing statistics and bottleneck analysis for the wafer pipeline.
+ *
+ *  Each stage is observed through StageObservation, updated in O(1) per event:
+ *      arrive()      a wafer joins the stage queue               (whoever pushes it)
+ *      start()       a wafer leaves the queue for a chamber      (its wait)
+ *      leave()       a wafer leaves the chamber                  (its residence)
+ *      finish()      a carrier cycle ends                        (chamber occupancy, batch size)
+ *      sample()      once per minute, after the chambers ran     (queue length, wafers in chambers)
+ *  Chambers keep their own observation (single writer, no locks); main merges them at the end.
+ *  Wafers still queued or on a carrier when the run stops are booked with their partial
+ *  time (censor), so the Little's-law checks L = λ·W hold exactly, not just in the limit.
+ *
+ *  Stages that are not simulated yet can be added from their nominal recipe times, so the
+ *  bottleneck and the value of one more chamber are found over the whole pipeline:
+ *      capacity μ = chambers · wafers per cycle / minutes per cycle
+ *      pipeline throughput X = min(arrival rate, μ of every stage)
+ */
+namespace queueing {
+
+/// Welford running mean / variance; merge() uses Chan's pairwise update. O(1) everywhere.
+class RunningStats {
+public:
+    void add(double x) {
+        ++n_;
+        const double delta = x - mean_;
+        mean_ += delta / static_cast<double>(n_);
+        m2_ += delta * (x - mean_);
+        sum_ += x;
+    }
+    void merge(const RunningStats& other);
+
+    std::uint64_t count() const { return n_; }
+    double mean() const { return mean_; }
+    double sum() const { return sum_; }
+    double variance() const { return n_ > 1 ? m2_ / static_cast<double>(n_ - 1) : 0.0; }
+    double stddev() const;
+
+private:
+    std::uint64_t n_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+    double sum_ = 0.0;
+};
+
+struct StageObservation {
+    std::uint64_t arrivals   = 0;
+    std::uint64_t departures = 0;
+    RunningStats wait;        ///< minutes from Task::readyMinute to loading, per wafer
+    RunningStats residence;   ///< minutes on the carrier, per wafer
+    RunningStats cycle;       ///< minutes a chamber is held per carrier (load → ready for the next)
+    RunningStats batch;       ///< wafers per carrier
+    long long occupiedMinutes = 0;   ///< chamber-minutes not available to a new carrier
+    long long queueArea   = 0;       ///< Σ queue length over sampled minutes
+    long long chamberArea = 0;       ///< Σ wafers in chambers over sampled minutes
+    long long samples     = 0;
+
+    void arrive() { ++arrivals; }
+    void start(int waitMinutes) { wait.add(waitMinutes); }
+    void leave(int residenceMinutes) { residence.add(residenceMinutes); ++departures; }
+    void finish(int cycleMinutes, std::size_t wafers) {
+        cycle.add(cycleMinutes);
+        batch.add(static_cast<double>(wafers));
+    }
+    void sample(std::size_t queued, std::size_t inChambers) {
+        queueArea += static_cast<long long>(queued);
+        chamberArea += static_cast<long long>(inChambers);
+        ++samples;
+    }
+    /// A wafer still waiting (or still on a carrier) when the run stops, with its time so far.
+    void censorWait(int minutesSoFar) { wait.add(minutesSoFar); }
+    void censorResidence(int minutesSoFar) { residence.add(minutesSoFar); }
+
+    void merge(const StageObservation& other);
+};
+
+/// Derived figures for one stage (rates in wafers per minute).
+struct StageFigures {
+    std::string name;
+    int chambers = 0;
+    bool nominal = false;       ///< from recipe times, not observed
+    double arrivalRate = 0.0;   ///< λ offered to the stage
+    double throughput  = 0.0;   ///< X observed (nominal: min(λ, μ))
+    double cycleMinutes = 0.0;  ///< mean chamber cycle
+    double waferPerCycle = 1.0;
+    double capacity = 0.0;      ///< μ
+    double utilization = 0.0;   ///< observed occupancy (nominal: λ / μ)
+    double meanQueue = 0.0;     ///< Lq
+    double meanWait  = 0.0;     ///< Wq
+    double littleQueueError = 0.0;     ///< |Lq - λ·Wq| / Lq
+    double littleChamberError = 0.0;   ///< |L - X·W| / L for wafers in chambers
+};
+
+class QueueingAnalyzer {
+public:
+    /// A simulated stage; returns its index. Stages are in pipeline order.
+    int addStage(const std::string& name, int chambers);
+    /// A stage known only from its recipe: `cycleMinutes` per carrier of `waferPerCycle`.
+    int addNominalStage(const std::string& name, int chambers, double cycleMinutes, double waferPerCycle = 1.0);
+
+    StageObservation& observation(int stage) { return stages_[static_cast<std::size_t>(stage)].observed; }
+
+    std::vector<StageFigures> figures(long long minutes) const;
+
+    /// Index of the stage with the lowest capacity (-1 without stages).
+    static int bottleneck(const std::vector<StageFigures>& stages);
+    /// Pipeline throughput bound min(λ, μ…), optionally with one more chamber on `extraAt`.
+    static double pipelineThroughput(const std::vector<StageFigures>& stages, int extraAt = -1);
+
+    /// Stage table, Little's-law checks, bottleneck and the gain of one more chamber there.
+    void report(std::ostream& out, long long minutes) const;
+
+private:
+    struct Stage {
+        std::string name;
+        int chambers = 1;
+        bool nominal = false;
+        double cycleMinutes = 0.0;
+        double waferPerCycle = 1.0;
+        StageObservation observed;
+    };
+    std::vector<Stage> stages_;
+};
+
+}  // namespace queueing
+
+#endif  // QUEUEING_ANALYZER_HPP
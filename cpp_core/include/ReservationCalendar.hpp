@@ -0,0 +1,117 @@
+#ifndef RESERVATION_CALENDAR_HPP
+#define RESERVATION_CALENDAR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/**
+ * @brief  Forward reservation calendar for the chambers and the power bus.
+ *
+ *  Answers "when is the next window where chamber X is free and at least W watts are
+ *  available for d minutes?", and books / cancels such windows, over a fixed horizon
+ *  (e.g. a week, 10 080 minutes) at one-minute resolution.
+ *
+ *  Every resource is a Timeline: a segment tree over the minutes holding the amount still
+ *  available (watts for the bus, 1 / 0 for a chamber), with lazy range add and min / max per
+ *  node. Booking and cancelling are range adds, O(log H). A window search descends to the
+ *  first minute below the demand and then to the first minute back at it, so each step is
+ *  O(log H) and skips a whole blocked run (an eclipse, a booked carrier) at once:
+ *
+ *      plan::ReservationCalendar calendar(chambers, plan::orbitPowerProfile(7 * 1440));
+ *      int start = calendar.earliestWindow(chamber, from, 60, 300);    // -1 ⇒ none in the horizon
+ *      int id    = calendar.reserve(chamber, start, 60, 300);          // -1 ⇒ no longer fits
+ *      calendar.cancel(id);
+ */
+namespace plan {
+
+/// Per-minute amounts with range add and threshold searches (segment tree, lazy propagation).
+class Timeline {
+public:
+    explicit Timeline(const std::vector<std::int64_t>& initial);
+
+    int horizon() const { return horizon_; }
+
+    /// Adds `delta` to every minute of [begin, end).
+    void add(int begin, int end, std::int64_t delta);
+    /// Lowest amount over [begin, end).
+    std::int64_t min(int begin, int end);
+    std::int64_t at(int minute) { return min(minute, minute + 1); }
+
+    /// First minute ≥ from with amount < threshold; horizon() if none.
+    int firstBelow(int from, std::int64_t threshold);
+    /// First minute ≥ from with amount ≥ threshold; horizon() if none.
+    int firstAtLeast(int from, std::int64_t threshold);
+
+private:
+    void build(std::size_t node, int lo, int hi, const std::vector<std::int64_t>& initial);
+    void push(std::size_t node);
+    void apply(std::size_t node, std::int64_t delta);
+    void add(std::size_t node, int lo, int hi, int begin, int end, std::int64_t delta);
+    std::int64_t min(std::size_t node, int lo, int hi, int begin, int end);
+    int firstBelow(std::size_t node, int lo, int hi, int from, std::int64_t threshold);
+    int firstAtLeast(std::size_t node, int lo, int hi, int from, std::int64_t threshold);
+
+    int horizon_;
+    std::vector<std::int64_t> min_;
+    std::vector<std::int64_t> max_;
+    std::vector<std::int64_t> lazy_;
+};
+
+/**
+ * @brief Power the bus can hand out per minute over `horizon` minutes, as PowerModule budgets it:
+ *        solar (sunlight / eclipse by the 90-minute orbit main drives) plus the battery draw cap.
+ *
+ * Optimistic about the battery: it assumes the cap is always available (no depletion model).
+ */
+std::vector<std::int64_t> orbitPowerProfile(int horizon, int sunlightW = 300, int eclipseW = 0, int batteryDrawW = 300);
+
+struct Reservation {
+    int id = -1;
+    int chamber = 0;
+    int start = 0;   ///< first minute
+    int end = 0;     ///< one past the last minute
+    int watts = 0;
+};
+
+class ReservationCalendar {
+public:
+    ReservationCalendar(int chambers, const std::vector<std::int64_t>& powerProfile);
+
+    int horizon() const { return power_.horizon(); }
+    int chambers() const { return static_cast<int>(chambers_.size()); }
+
+    /// Earliest start ≥ from where `chamber` is free and `watts` are available for `minutes`; -1 if none.
+    int earliestWindow(int chamber, int from, int minutes, int watts);
+    /// Same over every chamber; the chosen one goes to `chamber`. -1 if none.
+    int earliestWindowAny(int from, int minutes, int watts, int& chamber);
+
+    bool fits(int chamber, int start, int minutes, int watts);
+    /// Books the window; returns its id, or -1 if it no longer fits.
+    int reserve(int chamber, int start, int minutes, int watts);
+    /// Frees the window; false for an unknown (or already cancelled) id.
+    bool cancel(int id);
+
+    /// The reservation holding `chamber` at `minute`, or nullptr. O(log n) in its bookings.
+    const Reservation* occupant(int chamber, int minute) const;
+    std::size_t active() const { return active_; }
+
+    std::int64_t powerAvailable(int minute) { return power_.at(minute); }
+    /// Lowest free power over [start, start + minutes).
+    std::int64_t powerHeadroom(int start, int minutes) { return power_.min(start, start + minutes); }
+
+private:
+    /// earliestWindow limited to starts ≤ latest.
+    int search(int chamber, int from, int minutes, int watts, int latest);
+
+    Timeline power_;
+    std::vector<Timeline> chambers_;
+    std::vector<std::map<int, int>> bookings_;   // per chamber: start → reservation id (disjoint)
+    std::vector<Reservation> reservations_;      // by id; cancelled ones keep id = -1
+    std::size_t active_ = 0;
+};
+
+}  // namespace plan
+
+#endif  // RESERVATION_CALENDAR_HPP
@@ -0,0 +1,91 @@
+#ifndef STAGE_QUEUE_HPP
+#define STAGE_QUEUE_HPP
+
+#include "Task.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include "ProfiledMutex.hpp"
+#include <vector>
+
+/**
+ * @brief Limits of a StageQueue used as an inter-stage WIP buffer (defaults: unbounded).
+ *
+ *  capacity        tryPush() refuses wafers beyond this many; the upstream chamber keeps
+ *                  them on its carrier and is blocked until there is room
+ *  maxDwellMinutes expire() scraps wafers that have waited longer than this (they degrade)
+ */
+struct BufferConfig {
+    std::size_t capacity = 0;     ///< 0 ⇒ unbounded
+    int maxDwellMinutes  = 0;     ///< 0 ⇒ wafers never expire
+};
+
+/// Occupancy telemetry of one buffer; sample() adds one minute.
+struct BufferStats {
+    std::uint64_t pushed   = 0;
+    std::uint64_t popped   = 0;
+    std::uint64_t rejected = 0;   ///< tryPush() calls refused because the buffer was full
+    std::uint64_t expired  = 0;   ///< wafers scrapped after maxDwellMinutes
+    std::size_t highWater  = 0;
+    long long occupancyArea = 0;  ///< Σ occupancy over sampled minutes
+    long long fullMinutes   = 0;  ///< sampled minutes at capacity
+    long long samples       = 0;
+
+    double meanOccupancy() const { return samples ? static_cast<double>(occupancyArea) / static_cast<double>(samples) : 0.0; }
+};
+
+/**
+ * @brief Thread-safe FIFO of wafers waiting for one stage type.
+ *
+ * Acts as the central dispatcher when several chambers of the same stage run in
+ * parallel: every idle chamber pulls the next wafer from the same queue, so work goes
+ * to whichever chamber frees up first. Stores pointers only — main owns the Tasks.
+ *
+ * Between two stages it is the WIP buffer: bounded by BufferConfig, with blocking
+ * (tryPush) and dwell expiry. Each entry remembers the minute it joined, so expiry is
+ * exact; wafers join in time order, so only the head ever needs checking.
+ */
+class StageQueue {
+public:
+    StageQueue() = default;
+    explicit StageQueue(const BufferConfig& cfg) : config_(cfg) {}
+
+    void   push(Task* task);             // unbounded; the wafer joins at its readyMinute
+    bool   tryPush(Task* task, int t);   // false (wafer stays with the caller) if the buffer is full
+    Task*  tryPop();                 // nullptr if empty
+    bool   remove(Task* task);       // true if the task was queued
+    bool   empty() const;
+    std::size_t size() const;
+    std::vector<Task*> front(std::size_t n) const;   // copy of the first n queued wafers (oldest first)
+    int    oldestSince() const;      // minute the longest-waiting wafer joined; -1 if empty
+
+    /// Scraps (Task::scrapped) and drops every wafer that has waited more than maxDwellMinutes at minute t;
+    /// appends them to `scrapped` if given.
+    std::size_t expire(int t, std::vector<Task*>* scrapped = nullptr);
+    /// Adds one minute of occupancy telemetry; call once per minute.
+    void sample();
+
+    /// Order tryPop() serves in: arrival, or least Task::dispatchSlack, then longest dispatchTail (TaskGraph.hpp).
+    enum class Dispatch { Fifo, CriticalPath };
+    void setDispatch(Dispatch dispatch);
+
+    const BufferConfig& config() const { return config_; }
+    BufferStats stats() const;
+
+private:
+    struct Entry {
+        Task* task;
+        int since;   // minute the wafer joined
+    };
+
+    bool full() const { return config_.capacity > 0 && tasks_.size() >= config_.capacity; }
+
+    BufferConfig config_;
+    Dispatch dispatch_ = Dispatch::Fifo;
+    mutable ProfiledMutex mutex_{"stage_queue"};
+    std::deque<Entry> tasks_;
+    BufferStats stats_;
+};
+
+#endif  // STAGE_QUEUE_HPP
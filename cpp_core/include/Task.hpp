@@ -2,10 +2,13 @@
 #define TASK_HPP
 
 #include <string>
+#include <vector>
 #include <array>
 #include <algorithm>   // std::max
 #include <mutex>
 #include <atomic>
+#include <cstdint>
+#include "ProfiledMutex.hpp"
 
 /**
  * @brief  Full life-cycle record for a single wafer (“task”).
@@ -28,9 +31,19 @@ struct Task {
         int requiredTime = 0;   // minutes needed for this phase
         int elapsedTime  = 0;   // minutes processed so far
         int energyUsed   = 0;   // cumulative watt-minutes USED 
+        std::int64_t solarEnergy   = 0;   // of which from solar, 1/1000 W·min (EnergyLedger.hpp)
+        std::int64_t batteryEnergy = 0;   // of which from battery, 1/1000 W·min
         bool wasInterrupted = false;   // true if the phase was paused/stalled mid-run
         double defectChance = 0.0;     // the error rate for this phase (e.g., 0.01 = 1%)
         bool defective = false;        // whether this phase had a defect
+        double dose = 0.0;             // ion implantation: ions/cm² delivered so far (IonImplantationModule.hpp)
+        int retries = 0;               // beam trips the wafer resumed from (or was scrapped on)
+        int pausedMinutes = 0;         // crystal growth: minutes paused (CrystalGrowthModule.hpp)
+
+        // spatial summary from the stage's WaferMap, filled in at phase end (WaferMap.hpp)
+        double meanThickness     = 0.0;   // nm
+        double nonUniformity     = 0.0;   // (max - min) / (2 · mean)
+        int    contaminatedCells = 0;     // cells above wafermap::CONTAMINATION_LIMIT_M2
 
         // Phase phase[3]; // 0: deposition, 1: ion, 2: crystal
         // std::mutex phaseMutex[3];  // 🔒 one mutex per phase
@@ -41,15 +54,24 @@ struct Task {
 
     /* ----- Persistent wafer identity ----- */
     std::string id;                     // e.g. "T_3"
+    std::string recipe = "default";     // process recipe, the key for yield analytics
+    std::string lot;                    // order the wafer belongs to ("" ⇒ a lot of its own), TaskGraph.hpp
+    std::vector<std::string> after;     // wafers that must finish, and pass, before this one starts
 
     /* ----- Three manufacturing stages ----- */
     std::array<PhaseInfo, 3> phase;     // [0] = Depo, [1] = Ion, [2] = Crystal
 
     // one mutex for each phase
-    std::mutex phaseMutex[3];
+    ProfiledMutex phaseMutex[3] = {ProfiledMutex("phase.deposition"), ProfiledMutex("phase.ion"),
+                                   ProfiledMutex("phase.crystal")};
 
     /* ----- Pointer to current stage ----- */
     int currentStage = 0;               // 0..2; 3 ⇒ wafer finished
+    int readyMinute  = 0;               // minute the wafer became available to its current stage
+    int releasedMinute = 0;             // minute it entered the line (arrival, or release by its lot)
+    bool scrapped    = false;           // expired in a WIP buffer (StageQueue::expire)
+    int dispatchSlack = 0;              // minutes of slack on its lot's critical path (lower ⇒ sooner)
+    int dispatchTail  = 0;              // longest chain of work left from here to the end of its lot
 
 
     /* ----- Convenience helpers ----- */
@@ -64,8 +86,24 @@ struct Task {
         return sum;
     }
 
+    // battery share of totalEnergy(), in 1/1000 W·min: the expensive part a scheduler should minimise
+    std::int64_t batteryEnergy() const {
+        std::int64_t sum = 0;
+        for (const auto& p : phase) sum += p.batteryEnergy;
+        return sum;
+    }
+
     // check if the current phase has failed
     bool phaseFail() const {    return currentPhase().defective;}
+
+    // true if any stage marked the wafer defective, or it was scrapped on the way
+    bool failed() const {
+        if (scrapped) return true;
+        for (const auto& p : phase) {
+            if (p.defective) return true;
+        }
+        return false;
+    }
     
 };
 
@@ -0,0 +1,94 @@
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+#include "Task.hpp"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief  Wafer lots with precedence edges, and critical-path priorities for dispatch.
+ *
+ *  A lot is the set of wafers sharing Task::lot (a wafer without one is a lot of its own).
+ *  Task::after lists the wafers that must finish — and pass — before it may start, e.g. a
+ *  test wafer ahead of the production wafers. A failed (defective) wafer cancels everything
+ *  downstream of it; those wafers are never queued.
+ *
+ *  Per wafer, with rem = minutes of work left over all phases:
+ *      head  = longest chain of unfinished predecessors   = max over preds (head + rem)
+ *      tail  = rem + longest chain after it               = rem + max over succs tail
+ *      slack = critical path of the lot - head - tail      (0 ⇒ on the critical path)
+ *  Written to Task::dispatchSlack / dispatchTail; a StageQueue in Dispatch::CriticalPath order
+ *  serves the least slack first, then the longest tail, then FIFO.
+ *
+ *  complete() is called from main between ticks (chambers parked). It propagates the changed
+ *  heads and tails only along the chains they change, then re-derives the slack of that lot.
+ */
+namespace lots {
+
+class TaskGraph {
+public:
+    /// Builds the DAG from Task::lot / Task::after; false with `error` on an unknown id or a cycle.
+    bool build(const std::vector<Task*>& tasks, std::string& error);
+
+    bool hasEdges() const { return edges_ > 0; }
+
+    /// Wafers without predecessors, in file order: queue these at the start.
+    std::vector<Task*> initiallyReady() const;
+
+    /**
+     * @brief Marks `task` finished at minute `t`; appends successors that became ready to `released`.
+     *
+     * Call it when the wafer leaves the line: grown, or scrapped on the way. One that
+     * Task::failed() cancels its descendants.
+     */
+    void complete(Task* task, int t, std::vector<Task*>& released);
+
+    /// Per lot: wafers done / cancelled, nominal critical path, and makespan so far.
+    void report(std::ostream& out) const;
+
+private:
+    enum class State { Held, Ready, Done, Cancelled };
+
+    struct Node {
+        Task* task = nullptr;
+        int lot = 0;
+        std::vector<int> preds;
+        std::vector<int> succs;
+        int waitingOn = 0;   // unfinished predecessors
+        int rem  = 0;
+        int head = 0;
+        int tail = 0;
+        State state = State::Held;
+    };
+
+    struct Lot {
+        std::string name;
+        std::vector<int> nodes;
+        int criticalPath = 0;          // current, over the unfinished wafers
+        int nominalCriticalPath = 0;   // at the start of the run
+        int done = 0;
+        int cancelled = 0;
+        int firstReady = -1;           // minute its first wafer could start
+        int lastCompletion = -1;
+    };
+
+    static int remainingWork(const Task& task);
+    void propagateTails(int from);
+    void propagateHeads(int from);
+    void refreshLot(int lot);
+    void cancelFrom(int node);
+
+    std::vector<Node> nodes_;
+    std::vector<Lot> lots_;
+    std::unordered_map<const Task*, int> index_;
+    std::size_t edges_ = 0;
+    std::vector<int> work_;   // scratch worklist, reserved in build()
+};
+
+}  // namespace lots
+
+#endif  // TASK_GRAPH_HPP
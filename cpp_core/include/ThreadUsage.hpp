@@ -0,0 +1,59 @@
+#ifndef THREAD_USAGE_HPP
+#define THREAD_USAGE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief  Host-side accounting per simulator thread: CPU time, wall time, and how much of
+ *         that wall time was spent blocked waiting for a tick or for a lock.
+ *
+ *  Each thread registers itself once and closes its entry before it exits:
+ *
+ *      usage::beginThread("Deposition0");
+ *      ...  { usage::TickWait w; cv.wait(...); }  ...
+ *      usage::endThread();
+ *
+ *  Lock waits are added by ProfiledMutex on every contended lock, in every build. Calls from
+ *  a thread that never registered are ignored, so waits can be reported unconditionally
+ *  (benches and tools do not register).
+ */
+namespace usage {
+
+struct ThreadStats {
+    std::string   name;
+    std::uint64_t wallNs     = 0;   ///< beginThread → endThread (or now, if still running)
+    std::uint64_t cpuNs      = 0;   ///< CLOCK_THREAD_CPUTIME_ID over the same span
+    std::uint64_t tickWaitNs = 0;   ///< blocked on the tick condition variables
+    std::uint64_t lockWaitNs = 0;   ///< blocked acquiring a contended ProfiledMutex
+};
+
+/// CPU time consumed by the calling thread so far.
+std::uint64_t threadCpuNs();
+
+void beginThread(const std::string& name);
+void endThread();
+
+void addTickWait(std::uint64_t ns);
+void addLockWait(std::uint64_t ns);
+
+/// Every thread registered so far, in registration order.
+std::vector<ThreadStats> threads();
+
+/// Adds its lifetime to the calling thread's tick wait.
+class TickWait {
+public:
+    TickWait();
+    ~TickWait();
+
+    TickWait(const TickWait&) = delete;
+    TickWait& operator=(const TickWait&) = delete;
+
+private:
+    std::int64_t startNs_;
+};
+
+}  // namespace usage
+
+#endif  // THREAD_USAGE_HPP
@@ -0,0 +1,51 @@
+#ifndef TICK_BARRIER_HPP
+#define TICK_BARRIER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include "ProfiledMutex.hpp"
+
+/**
+ * @brief  The per-minute handshake between the main loop and the module threads.
+ *
+ *  Main publishes a new tick and wakes every worker exactly once; each worker runs its
+ *  minute and arrives; main waits until all workers arrived before it touches shared
+ *  state (the power bus) again.
+ *
+ *  Usage:
+ *      main:    barrier.publish(); barrier.waitAll();   ...   barrier.stop();
+ *      worker:  int seen = 0;
+ *               while (barrier.waitForTick(seen)) { module.update(...); barrier.arrive(); }
+ */
+class TickBarrier {
+public:
+    explicit TickBarrier(int workers);
+
+    /* ---------- main thread ---------- */
+    void publish();   // start a new tick and wake every worker
+    void waitAll();   // block until every worker arrived for the current tick
+    void stop();      // wake all workers so they can exit
+
+    /* ---------- worker threads ---------- */
+    // Blocks until a tick newer than `seen` is published (then updates `seen`); false on stop()
+    bool waitForTick(int& seen);
+    void arrive();
+
+    int  ticks() const { return tick_.load(std::memory_order_acquire); }
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+private:
+    const int workers_;
+
+    ProfiledMutex tickMutex_{"depo_mutex"};   // no worker can miss the wakeup between its check and wait
+    ProfiledConditionVariable tickCv_;
+    std::atomic<bool> running_{true};
+    std::atomic<int>  tick_{0};           // incremented once per minute; avoids spurious wakeups repeating work
+
+    ProfiledMutex doneMutex_{"done_mutex"};
+    ProfiledConditionVariable doneCv_;
+    int done_ = 0;                        // guarded by doneMutex_
+};
+
+#endif  // TICK_BARRIER_HPP
@@ -0,0 +1,211 @@
+#ifndef TICK_LATENCY_HPP
+#define TICK_LATENCY_HPP
+
+/** Tick latency recording for the real-time / HIL budget (header-only, shared by cpp_core and Sim)
+ *
+ * LatencyHistogram is HDR-style: log-linear buckets with 64 sub-buckets per power of two,
+ * so every recorded value is kept to within ~1.6 % from 1 ns up to ~36 minutes, in a
+ * fixed 18 KiB table (no allocation after construction, O(1) record).
+ *
+ * TickRecorder times whole ticks with the monotonic clock and splits each one into named
+ * phases; the slowest ticks are kept with their phase breakdown and a few context values:
+ *
+ *      recorder.beginTick(t);
+ *      power.update(...);           recorder.mark("power");
+ *      barrier.publish/waitAll();   recorder.mark("chambers");
+ *      recorder.note("log.rows", rows);
+ *      recorder.endTick();
+ *      ...
+ *      recorder.report(std::cout);  // p50 / p99 / p99.9 / max, 10 Hz and 100 Hz budgets, slowest ticks
+ *
+ * Single writer: one recorder per ticking thread.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 7;                              // 2^7 exact values, then 64 per octave
+    static constexpr int MAX_EXPONENT = 41;                         // values up to 2^41 ns ≈ 36 min
+    static constexpr std::size_t LINEAR = std::size_t(1) << SUB_BITS;
+    static constexpr std::size_t HALF = LINEAR / 2;
+    static constexpr std::size_t BUCKETS = LINEAR + (MAX_EXPONENT - SUB_BITS) * HALF;
+
+    void record(std::uint64_t ns) {
+        ++counts_[indexOf(ns)];
+        ++count_;
+        sum_ += ns;
+        max_ = std::max(max_, ns);
+        min_ = std::min(min_, ns);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (std::size_t i = 0; i < BUCKETS; ++i) counts_[i] += other.counts_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+        min_ = std::min(min_, other.min_);
+    }
+
+    std::uint64_t count() const { return count_; }
+    std::uint64_t max() const { return max_; }
+    std::uint64_t min() const { return count_ ? min_ : 0; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0; }
+
+    /// Highest value equivalent to the bucket holding quantile q (never above max()).
+    std::uint64_t percentile(double q) const {
+        if (count_ == 0) return 0;
+        const auto rank = static_cast<std::uint64_t>(std::max(1.0, std::ceil(q * static_cast<double>(count_))));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) return std::min(highestEquivalent(i), max_);
+        }
+        return max_;
+    }
+
+    /// Number of recorded values strictly above `ns` (to bucket precision).
+    std::uint64_t countAbove(std::uint64_t ns) const {
+        std::uint64_t above = 0;
+        for (std::size_t i = indexOf(ns) + 1; i < BUCKETS; ++i) above += counts_[i];
+        return above;
+    }
+
+private:
+    static std::size_t indexOf(std::uint64_t v) {
+        if (v < LINEAR) return static_cast<std::size_t>(v);
+        const int exponent = std::min(63 - __builtin_clzll(v), MAX_EXPONENT - 1);
+        const int shift = exponent - SUB_BITS + 1;
+        const std::uint64_t top = std::min<std::uint64_t>(v >> shift, LINEAR - 1);   // in [HALF, LINEAR)
+        return LINEAR + static_cast<std::size_t>(exponent - SUB_BITS) * HALF + static_cast<std::size_t>(top - HALF);
+    }
+
+    static std::uint64_t highestEquivalent(std::size_t index) {
+        if (index < LINEAR) return index;
+        const std::size_t octave = (index - LINEAR) / HALF;
+        const std::uint64_t top = HALF + (index - LINEAR) % HALF;
+        const int shift = static_cast<int>(octave) + 1;
+        return ((top + 1) << shift) - 1;
+    }
+
+    std::array<std::uint64_t, BUCKETS> counts_{};
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+    std::uint64_t max_ = 0;
+    std::uint64_t min_ = UINT64_MAX;
+};
+
+class TickRecorder {
+public:
+    static constexpr int MAX_PHASES = 8;
+    static constexpr int MAX_NOTES = 4;
+
+    struct Phase {
+        const char* name = nullptr;   // string literal
+        std::uint64_t ns = 0;
+    };
+    struct Note {
+        const char* name = nullptr;   // string literal
+        long long value = 0;
+    };
+    struct Tick {
+        long index = 0;
+        std::uint64_t ns = 0;
+        int phases = 0;
+        int notes = 0;
+        std::array<Phase, MAX_PHASES> phase{};
+        std::array<Note, MAX_NOTES> note{};
+    };
+
+    explicit TickRecorder(std::size_t keepSlowest = 8) : keep_(std::max<std::size_t>(1, keepSlowest)) {
+        slowest_.reserve(keep_ + 1);
+    }
+
+    void beginTick(long index) {
+        current_ = Tick{};
+        current_.index = index;
+        tickStart_ = phaseStart_ = Clock::now();
+    }
+
+    /// Closes the phase that started at the previous mark (or at beginTick).
+    void mark(const char* phase) {
+        const auto now = Clock::now();
+        if (current_.phases < MAX_PHASES) current_.phase[current_.phases++] = Phase{phase, nanos(now - phaseStart_)};
+        phaseStart_ = now;
+    }
+
+    /// Context kept with the tick if it ends up among the slowest (e.g. rows logged this tick).
+    void note(const char* name, long long value) {
+        if (current_.notes < MAX_NOTES) current_.note[current_.notes++] = Note{name, value};
+    }
+
+    void endTick() {
+        current_.ns = nanos(Clock::now() - tickStart_);
+        histogram_.record(current_.ns);
+        if (slowest_.size() < keep_ || current_.ns > slowest_.back().ns) {
+            // sorted slowest-first; at most keep_ + 1 entries, so this never reallocates
+            const auto at = std::upper_bound(slowest_.begin(), slowest_.end(), current_,
+                                             [](const Tick& a, const Tick& b) { return a.ns > b.ns; });
+            slowest_.insert(at, current_);
+            if (slowest_.size() > keep_) slowest_.pop_back();
+        }
+    }
+
+    const LatencyHistogram& histogram() const { return histogram_; }
+    const std::vector<Tick>& slowest() const { return slowest_; }
+
+    /// Percentiles, the 10 Hz / 100 Hz budget check and the slowest ticks with their breakdown.
+    void report(std::ostream& out, const char* title = "tick latency") const {
+        const auto us = [](std::uint64_t ns) { return static_cast<double>(ns) / 1e3; };
+        const auto flags = out.flags();
+        const auto precision = out.precision();
+        out << "\n---- " << title << " (" << histogram_.count() << " ticks, us) ----\n"
+            << std::fixed << std::setprecision(1)
+            << "p50 " << us(histogram_.percentile(0.50)) << " | p99 " << us(histogram_.percentile(0.99))
+            << " | p99.9 " << us(histogram_.percentile(0.999)) << " | max " << us(histogram_.max())
+            << " | mean " << histogram_.mean() / 1e3 << "\n";
+
+        for (const int hz : {10, 100}) {
+            const std::uint64_t budget = 1'000'000'000ull / static_cast<std::uint64_t>(hz);
+            const std::uint64_t over = histogram_.countAbove(budget);
+            out << hz << " Hz budget (" << us(budget) << " us): "
+                << (histogram_.max() <= budget ? "met by every tick" : "missed") << " | over budget: " << over;
+            if (histogram_.count()) out << " (" << 100.0 * static_cast<double>(over) / static_cast<double>(histogram_.count()) << " %)";
+            out << " | headroom at p99.9: " << (100.0 - 100.0 * static_cast<double>(histogram_.percentile(0.999)) / static_cast<double>(budget)) << " %\n";
+        }
+
+        out << "slowest ticks:\n";
+        for (const Tick& tick : slowest_) {
+            out << "  tick " << tick.index << ": " << us(tick.ns);
+            for (int i = 0; i < tick.phases; ++i) out << " | " << tick.phase[i].name << " " << us(tick.phase[i].ns);
+            for (int i = 0; i < tick.notes; ++i) out << " | " << tick.note[i].name << "=" << tick.note[i].value;
+            out << "\n";
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static std::uint64_t nanos(Clock::duration d) {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    }
+
+    std::size_t keep_;
+    LatencyHistogram histogram_;
+    std::vector<Tick> slowest_;
+    Tick current_;
+    Clock::time_point tickStart_;
+    Clock::time_point phaseStart_;
+};
+
+#endif  // TICK_LATENCY_HPP
@@ -0,0 +1,68 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief  Scoped-span tracing in the Chrome / Perfetto trace-event format.
+ *
+ *  Every thread appends complete ("X") events to its own fixed-size buffer: no locks and
+ *  no allocation on the hot path (the buffer is allocated on the thread's first span).
+ *  Buffers outlive their threads, so main writes the JSON after joining the workers:
+ *
+ *      SF_TRACE_THREAD_NAME("Deposition_1");
+ *      { SF_TRACE_SCOPE("power.lock", "lock"); ... }
+ *      SF_TRACE_WRITE("trace.json");           // open in ui.perfetto.dev or chrome://tracing
+ *
+ *  The macros compile to nothing unless SPACEFORGE_TRACE is defined
+ *  (cmake -DSPACEFORGE_ENABLE_TRACE=ON). Span names and categories must be string literals.
+ */
+namespace trace {
+
+constexpr std::size_t EVENTS_PER_THREAD = 1u << 18;   // 8 MiB per traced thread; later spans are dropped
+
+std::uint64_t nowNs();   // steady clock, relative to process start
+
+/// Records [begin, end) for the calling thread.
+void record(const char* name, const char* category, std::uint64_t beginNs, std::uint64_t endNs);
+
+/// Label for the calling thread in the viewer (default "thread <n>").
+void setThreadName(const std::string& name);
+
+/// Writes every thread's events; call once the traced threads are joined. False if the file cannot be opened.
+bool writeChromeJson(const std::string& path);
+
+std::size_t droppedEvents();
+
+class Span {
+public:
+    Span(const char* name, const char* category) : name_(name), category_(category), begin_(nowNs()) {}
+    ~Span() { record(name_, category_, begin_, nowNs()); }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    std::uint64_t begin_;
+};
+
+}  // namespace trace
+
+#define SF_TRACE_CONCAT_INNER(a, b) a##b
+#define SF_TRACE_CONCAT(a, b) SF_TRACE_CONCAT_INNER(a, b)
+
+#ifdef SPACEFORGE_TRACE
+#define SF_TRACE_SCOPE(name, category) ::trace::Span SF_TRACE_CONCAT(sfTraceSpan_, __LINE__)(name, category)
+#define SF_TRACE_THREAD_NAME(name)     ::trace::setThreadName(name)
+#define SF_TRACE_WRITE(path)           ::trace::writeChromeJson(path)
+#else
+#define SF_TRACE_SCOPE(name, category) ((void)0)
+#define SF_TRACE_THREAD_NAME(name)     ((void)0)
+#define SF_TRACE_WRITE(path)           ((void)0)
+#endif
+
+#endif  // TRACE_HPP
@@ -0,0 +1,130 @@
+#ifndef WAFER_MAP_HPP
+#define WAFER_MAP_HPP
+
+#include "WakeTracer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief  Spatially resolved state of one wafer while it sits in a stage.
+ *
+ *  Both grids use the tracer's wafer binning (WAFER_MAP_N × WAFER_MAP_N, row-major, rows = y):
+ *    • thickness     – deposited film [nm], accumulated every powered minute
+ *    • contamination – wake-intrusion particles that reached the wafer [#/m²],
+ *                      accumulated every minute the wafer is exposed
+ *
+ *  Maps are only held while a wafer is on a stage; the summary (WaferMapStats) is
+ *  copied into Task::PhaseInfo at phase end and the map goes back to the arena.
+ */
+constexpr int WAFER_MAP_N     = wake::GRID_N;
+constexpr int WAFER_MAP_CELLS = WAFER_MAP_N * WAFER_MAP_N;
+
+struct alignas(32) WaferMap {
+    float thickness[WAFER_MAP_CELLS];
+    float contamination[WAFER_MAP_CELLS];
+};
+
+/**
+ * @brief  Per-minute sources that feed a WaferMap.
+ *
+ *  depositionProfile is relative (mean 1.0 over the wafer disc, 0 outside it), so
+ *  thickness += depositionRate × profile. contaminationRate is absolute [#/m² per minute].
+ */
+struct alignas(32) FluxMap {
+    float depositionProfile[WAFER_MAP_CELLS];
+    float contaminationRate[WAFER_MAP_CELLS];
+
+    static constexpr double DEFAULT_SOURCE_HEIGHT = 4.0;   // effusion source above the wafer centre [wafer radii]
+
+    // flat deposition over the disc, no contamination
+    static FluxMap uniform();
+
+    // deposition from a cosine-law source on the wafer axis, `sourceHeight` wafer radii above it:
+    // rate(ρ) ∝ 1 / (1 + (ρ/h)²)², thickest in the centre; no contamination
+    static FluxMap radial(double sourceHeight = DEFAULT_SOURCE_HEIGHT);
+
+    // radial deposition + contamination from a tracer run (wafer grid × waferFluxM2s, per minute)
+    static FluxMap fromTrace(const wake::TraceResult& trace, double sourceHeight = DEFAULT_SOURCE_HEIGHT);
+
+    static constexpr std::uint64_t SHIELD_RAYS = 1'000'000;   // ~4 000 wafer hits, ~2 per disc cell
+
+    // fromTrace() of the station's shield (wafermap::shieldScene()), `rays` traced with seed 1
+    static FluxMap fromShield(std::uint64_t rays = SHIELD_RAYS);
+};
+
+/**
+ * @brief  Uniformity / defect metrics derived from a WaferMap at phase end.
+ *  Only cells inside the wafer disc are counted.
+ */
+struct WaferMapStats {
+    double meanThickness   = 0.0;   // nm
+    double nonUniformity   = 0.0;   // (max - min) / (2 · mean), the usual ±% figure as a fraction
+    double thicknessStdDev = 0.0;   // nm
+    double peakContamination = 0.0; // #/m²
+    int    contaminatedCells = 0;   // cells above the contamination limit
+    double contaminatedFraction = 0.0;
+};
+
+/**
+ * @brief  Fixed-capacity pool of WaferMaps.
+ *
+ *  Maps are carved out of slabs that are never returned to the heap, and released maps
+ *  go on a free list, so steady-state acquire/release never allocates. Capacity bounds
+ *  memory: it only has to cover wafers that are *on a stage*, not wafers in flight.
+ *  acquire() returns nullptr when the pool is exhausted — callers then skip the map.
+ *
+ *  Thread-safe (several chambers share one arena).
+ */
+class WaferMapArena {
+public:
+    explicit WaferMapArena(std::size_t capacity = 64, std::size_t slabSize = 16);
+
+    WaferMap* acquire();              // zeroed map, or nullptr if capacity is reached
+    void      release(WaferMap* map); // nullptr is ignored
+
+    std::size_t inUse()    const;
+    std::size_t capacity() const { return capacity_; }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<WaferMap[]>> slabs_;
+    std::vector<WaferMap*> free_;
+    std::size_t capacity_;
+    std::size_t slabSize_;
+    std::size_t allocated_ = 0;       // maps carved out of slabs so far
+};
+
+namespace wafermap {
+
+// under the shield a 60-minute deposition leaves a few hotspot cells (~0.3 %) above the limit
+constexpr double CONTAMINATION_LIMIT_M2    = 5.0e22;  // per-cell dose that counts as a defect site
+constexpr double MAX_CONTAMINATED_FRACTION = 0.01;    // more of the disc than this ⇒ wafer defective
+
+/**
+ * @brief The station's wake shield: the mc_output4 reference cupola (1.91 m edge, specular)
+ *        with the 150 mm wafer 1.01 m downstream, slightly off axis; ~0.4 % of rays hit it.
+ */
+wake::Scene shieldScene();
+
+/**
+ * @brief One exposed minute: thickness += rate × profile, contamination += contaminationRate.
+ *        Vectorised (AVX / SSE2 when available).
+ *
+ * @param powered false ⇒ the chamber was stalled this minute; only contamination accumulates
+ */
+void accumulateMinute(WaferMap& map, const FluxMap& flux, float depositionRateNm, bool powered);
+
+/// `minutes` powered minutes in one step (DepositionModule::fastForward); minutes = 1 is accumulateMinute(.., true).
+void accumulateMinutes(WaferMap& map, const FluxMap& flux, float depositionRateNm, int minutes);
+
+WaferMapStats summarize(const WaferMap& map);
+
+// disc-mean contamination rate of a flux map [#/m² per minute]
+double meanContamination(const FluxMap& flux);
+
+}  // namespace wafermap
+
+#endif  // WAFER_MAP_HPP
@@ -0,0 +1,108 @@
+#ifndef WAKE_TRACER_HPP
+#define WAKE_TRACER_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief  Native port of the wake-shield Monte-Carlo tracer in
+ *         monte-carlo-sim/physics.py (trace_batch).
+ *
+ *  Geometry conventions are identical to the Python version:
+ *    • shield apex at the origin, +Z upstream, -Z downstream (into the wake)
+ *    • particles launched from a disc at z = +1 m, radius 1.2 × primaryDim
+ *    • wafer is a disc in the plane z = zOffset (< 0), binned onto a 50×50 grid
+ *
+ *  Rays are split into fixed-size chunks and every chunk owns its own RNG
+ *  stream, so a trace is bit-identical for a given seed no matter how many
+ *  threads run it. That is what lets the benchmark compare thread counts.
+ */
+namespace wake {
+
+constexpr int GRID_N = 50;                       // wafer grid is GRID_N × GRID_N
+using WaferGrid = std::array<std::uint32_t, GRID_N * GRID_N>;   // row-major, rows = y
+
+enum class ShieldProfile { Cap, Flat, Pyramid, Cupola };
+enum class Coating       { Specular, Diffuse };
+enum class WakeShape     { Cone, Pyramid };
+
+/**
+ * @brief How the launch disc is sampled.
+ *   Uniform    – i.i.d. positions, same as the Python reference
+ *   Stratified – radius² and angle stratified per chunk (lower variance per ray)
+ */
+enum class SamplingMode { Uniform, Stratified };
+
+struct Shield {
+    ShieldProfile profile = ShieldProfile::Cap;
+    double primaryDim = 1.0;     // radius (cap/flat), half-base (pyramid), edge length (cupola) [m]
+    double shapeParam = 1.0;     // cap: 1/R, pyramid: h/half-base, otherwise unused
+    Coating coating   = Coating::Diffuse;
+};
+
+struct Wafer {
+    double radius  = 0.30;       // [m]
+    double zOffset = -1.0;       // plane position behind the shield [m]
+    double xOffset = 0.0;        // misalignment [m]
+    double yOffset = 0.0;
+};
+
+struct Wake {
+    WakeShape shape = WakeShape::Cone;
+    double cos2 = 1.0;           // cos²(half-angle) of the (equivalent) infinite cone
+};
+
+struct Scene {
+    Shield shield;
+    Wafer  wafer;
+    Wake   wake;
+};
+
+struct TraceResult {
+    double meanDeflectionDeg  = 0.0;
+    double hitRatio           = 0.0;   // wafer hits / rays
+    double wakeIntrusionRatio = 0.0;   // (wake ∪ wafer) hits / rays
+    double waferFluxM2s       = 0.0;   // physical particles per m² per s at the wafer
+    std::uint64_t rays        = 0;
+    WaferGrid grid{};                  // unweighted hit counts
+};
+
+/**
+ * @brief Build a Scene the same way spaceforge-montecarlo.py does
+ *        (cone wake derived from the wafer distance, pyramid wake with length = 10 × dim).
+ *
+ * @return false if the profile / coating / wake names are not recognised.
+ */
+bool makeScene(const std::string& profile,
+               double primaryDim,
+               double shapeParam,
+               const std::string& coating,
+               double zOffset,
+               double xOffset,
+               double yOffset,
+               const std::string& wakeType,
+               double waferRadius,
+               Scene& out);
+
+/**
+ * @brief Trace `rays` particles through one scene.
+ *
+ * @param scene   Geometry to trace
+ * @param rays    Number of particles launched
+ * @param seed    Base seed; chunk k uses an independent stream derived from (seed, k)
+ * @param mode    Launch-disc sampling mode
+ * @param threads Worker threads (≤ 1 ⇒ run on the calling thread)
+ */
+TraceResult traceBatch(const Scene& scene,
+                       std::uint64_t rays,
+                       std::uint64_t seed,
+                       SamplingMode mode = SamplingMode::Uniform,
+                       int threads = 1);
+
+const char* toString(SamplingMode mode);
+
+}  // namespace wake
+
+#endif  // WAKE_TRACER_HPP
@@ -0,0 +1,105 @@
+#ifndef YIELD_ANALYTICS_HPP
+#define YIELD_ANALYTICS_HPP
+
+#include "Task.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief  Streaming per-recipe yield analytics: throughput, yield, energy per wafer and
+ *         cycle time, updated as wafers leave the line.
+ *
+ *  A wafer is recorded once, when it leaves its last stage (or is scrapped on the way), so
+ *  its outcome covers every phase. Quantiles come from KLL sketches, so memory stays bounded
+ *  however many wafers a campaign runs, and two summaries merge without the raw data. Each
+ *  YieldAnalytics has a single writer (no locks); per-writer summaries merge at the end;
+ *  ensemble members or MPI ranks exchange serialize() blobs and merge them the same way.
+ */
+namespace analytics {
+
+/**
+ * @brief KLL quantile sketch (Karnin, Lang, Liberty 2016).
+ *
+ *  Level h holds items of weight 2^h; a full level is sorted and every other item
+ *  (random offset) moves up. Level capacities shrink by 2/3 going down from the top,
+ *  so ~3k items are retained in total. Rank error is about 1.7 / k (k = 200: ~1 %).
+ */
+class KllSketch {
+public:
+    static constexpr int DEFAULT_K = 200;
+
+    explicit KllSketch(int k = DEFAULT_K);
+
+    void add(double v);
+    void merge(const KllSketch& other);
+
+    /// Value at quantile q ∈ [0, 1]; 0 for an empty sketch.
+    double quantile(double q) const;
+
+    std::uint64_t count() const { return n_; }
+    double min() const { return n_ ? min_ : 0.0; }
+    double max() const { return n_ ? max_ : 0.0; }
+    std::size_t retained() const;   ///< items currently stored
+
+    /// Host byte order: for ranks / members on the same architecture.
+    void serialize(std::vector<std::uint8_t>& out) const;
+    bool deserialize(const std::uint8_t*& p, const std::uint8_t* end);
+
+private:
+    std::size_t capacity(std::size_t level) const;
+    void addLevel();
+    void compress();
+    void compact(std::size_t level);
+
+    int k_;
+    std::uint64_t n_ = 0;
+    double min_ = 0.0;
+    double max_ = 0.0;
+    std::vector<std::vector<double>> levels_;   // reserved to k + 1 each, so adds rarely reallocate
+    std::uint64_t coin_ = 0x9E3779B97F4A7C15ull; // xorshift state for the compaction offset
+};
+
+struct RecipeStats {
+    std::uint64_t completed   = 0;
+    std::uint64_t defective   = 0;
+    std::uint64_t interrupted = 0;   ///< wafers stalled at least once on any stage
+    double energySum = 0.0;          ///< W·min
+    double cycleSum  = 0.0;          ///< minutes from releasedMinute to leaving the line
+    KllSketch energy;
+    KllSketch cycle;
+
+    double yield() const { return completed ? 1.0 - static_cast<double>(defective) / static_cast<double>(completed) : 0.0; }
+};
+
+class YieldAnalytics {
+public:
+    /**
+     * @brief Adds one wafer leaving the line at minute `t`.
+     *
+     * Defective is Task::failed() (any phase, or scrapped); energy is Task::totalEnergy();
+     * cycle time is t - Task::releasedMinute.
+     */
+    void record(const Task& wafer, int t);
+
+    void merge(const YieldAnalytics& other);
+
+    const std::map<std::string, RecipeStats>& recipes() const { return recipes_; }
+
+    /// One line per recipe; throughput is scaled to wafers per simulated day.
+    void report(std::ostream& out, long long minutesSimulated) const;
+
+    void serialize(std::vector<std::uint8_t>& out) const;
+    bool deserialize(const std::vector<std::uint8_t>& blob);   ///< merges the blob into this
+
+private:
+    std::map<std::string, RecipeStats> recipes_;
+};
+
+}  // namespace analytics
+
+#endif  // YIELD_ANALYTICS_HPP
@@ -2,6 +2,13 @@
 #include <iostream>
 #include <mutex>
 #include <atomic>
+#include "Trace.hpp"
+#include "Metrics.hpp"
+#include "AllocTracker.hpp"
+
+namespace {
+metrics::Counter& rowsLogged = metrics::registry().counter("logger.rows");
+}  // namespace
 
 Logger::Logger(const std::string& filename) {
     file.open(filename);
@@ -45,7 +52,10 @@ void Logger::log(int minute,
                  const std::string& orbit,
                  const std::string& action,
                  float reward) {
-    std::lock_guard<std::mutex> lock(logMutex);
+    SF_TRACE_SCOPE("log.row", "io");   // includes the wait for logMutex
+    SF_ALLOC_SCOPE(alloc::Tag::Logger);
+    std::lock_guard<ProfiledMutex> lock(logMutex);
+    rowsLogged.add();
 
     file << minute << ","
          << module << ","
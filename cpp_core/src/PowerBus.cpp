@@ -18,7 +18,8 @@ PowerModule::PowerModule(int maxBattery,
 
 /* ---------- private helper that picks the right wattage based on storage space  ---------- */
 int PowerModule::solarGeneration(const std::string& phase) const {
-    return (phase == "sunlight") ? genSunlight_ : genEclipse_;
+    const int gen = (phase == "sunlight") ? genSunlight_ : genEclipse_;
+    return std::max(0, gen - solarDerate_);
 }
 
 /* ---------- public methods ---------- */
@@ -27,11 +28,13 @@ int PowerModule::solarGeneration(const std::string& phase) const {
 void PowerModule::update(int t, const std::string& orbitalPhase) {
 
     producedThisMinute_ = solarGeneration(orbitalPhase); // 300W in sunlight, 0W in eclipse
-    battery_ = std::min(std::max(battery_ + producedThisMinute_, 0), maxBattery_); // recharge battery up to max capacity 
+    if (!batteryTripped_)
+        battery_ = std::min(std::max(battery_ + producedThisMinute_, 0), maxBattery_); // recharge battery up to max capacity 
 
     constexpr int maxDrawPerMin_Allowed = 300;                     // W you’ll allow from battery
-    int batteryDrawPotential = std::min(maxDrawPerMin_Allowed, battery_);  // can either draw the amount available <300 or just 300
+    int batteryDrawPotential = batteryTripped_ ? 0 : std::min(maxDrawPerMin_Allowed, battery_);  // can either draw the amount available <300 or just 300
     budgetThisMinute_ = producedThisMinute_ + batteryDrawPotential; 
+    solarLeftThisMinute_ = producedThisMinute_;
 }
 
 // returns true if there is enough power in this minute's budget
@@ -41,14 +44,32 @@ bool PowerModule::canSatisfyDemand(int watts) const {
 
 // actually consumes power for a device/task
 // Even though you pack them together in one “budget,” that subtraction-and-difference step guarantees solar is “spent” first, then battery.
-void PowerModule::consumePower(int watts) {
+// Solar is tracked per minute, so a second consumer in the same minute only gets what the first one left.
+PowerDraw PowerModule::consumePower(int watts) {
     budgetThisMinute_ -= watts;  // subtract from the available budget (the shared pool of solarGenerated + battery)
-    int wattsFromBattery = std::max(0, watts - producedThisMinute_);  // if watts <= productedThisMinute_ by solar then no from battery
-    battery_ = std::max(0, battery_ - wattsFromBattery); // else if watts > producedThisMinute_ then pull from battery 
-    
+    PowerDraw draw;
+    draw.solar   = std::min(std::max(watts, 0), solarLeftThisMinute_);   // solar first
+    draw.battery = std::max(0, watts - draw.solar);                       // the rest from battery
+    solarLeftThisMinute_ -= draw.solar;
+    battery_ = std::max(0, battery_ - draw.battery);
+    solarDrawn_   += draw.solar;
+    batteryDrawn_ += draw.battery;
+    return draw;
 }
 
-double PowerModule::getSOC() const {  return (static_cast<double>(battery_) / maxBattery_) * 100.0;}
+double PowerModule::getSOC() const {
+    return maxBattery_ > 0 ? (static_cast<double>(battery_) / maxBattery_) * 100.0 : 0.0;
+}
+
+// fault hooks: take effect from the next update()
+void PowerModule::setSolarDerate(int watts) { solarDerate_ = std::max(0, watts); }
+
+void PowerModule::loseBatteryCapacity(int mWh) {
+    maxBattery_ = std::max(0, maxBattery_ - std::max(0, mWh));
+    battery_ = std::min(battery_, maxBattery_);
+}
+
+void PowerModule::setBatteryTripped(bool tripped) { batteryTripped_ = tripped; }
 // query methods
 int PowerModule::getAvailablePower() const { return budgetThisMinute_; }
 int PowerModule::getBatteryLevel()   const { return battery_; }
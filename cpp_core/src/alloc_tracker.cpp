@@ -0,0 +1,198 @@
+#include "AllocTracker.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+#ifdef SPACEFORGE_ALLOC_TRACKING
+
+#include <atomic>
+#include <cstdlib>
+#include <execinfo.h>
+#include <new>
+#include <unistd.h>
+
+namespace alloc {
+namespace {
+
+constexpr std::size_t TAGS = static_cast<std::size_t>(Tag::Count);
+constexpr int MAX_SAMPLES = 8;    // violations kept with a stack sample
+constexpr int MAX_FRAMES  = 24;
+
+struct alignas(64) TagCounters {
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::uint64_t> frees{0};
+};
+
+struct Sample {
+    Tag tag;
+    std::size_t size;
+    int frames;
+    void* stack[MAX_FRAMES];
+};
+
+TagCounters counters[TAGS];
+std::atomic<bool> steadyState{false};
+std::atomic<bool> abortOnViolation{false};
+std::atomic<std::uint64_t> violations{0};
+Sample samples[MAX_SAMPLES];
+std::atomic<int> sampleCount{0};
+
+thread_local Tag threadTag = Tag::Other;
+thread_local bool tickThread = false;
+thread_local bool inHook = false;   // backtrace() may allocate; never recurse into the check
+
+void onAllocate(std::size_t size) {
+    const auto tag = static_cast<std::size_t>(threadTag);
+    counters[tag].allocations.fetch_add(1, std::memory_order_relaxed);
+    counters[tag].bytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (!tickThread || inHook || !steadyState.load(std::memory_order_relaxed)) return;
+    inHook = true;
+    violations.fetch_add(1, std::memory_order_relaxed);
+    const int slot = sampleCount.fetch_add(1, std::memory_order_relaxed);
+    if (slot < MAX_SAMPLES) {
+        Sample& s = samples[slot];
+        s.tag = threadTag;
+        s.size = size;
+        s.frames = backtrace(s.stack, MAX_FRAMES);
+    }
+    if (abortOnViolation.load(std::memory_order_relaxed)) {
+        static const char msg[] = "[alloc] heap allocation in the steady-state tick loop\n";
+        (void)!write(2, msg, sizeof(msg) - 1);
+        void* stack[MAX_FRAMES];
+        backtrace_symbols_fd(stack, backtrace(stack, MAX_FRAMES), 2);
+        std::abort();
+    }
+    inHook = false;
+}
+
+void onFree(void* p) {
+    if (p) counters[static_cast<std::size_t>(threadTag)].frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* allocate(std::size_t size) {
+    onAllocate(size);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t align) {
+    onAllocate(size);
+    const auto a = static_cast<std::size_t>(align);
+    const std::size_t rounded = ((size ? size : 1) + a - 1) / a * a;   // aligned_alloc wants a multiple
+    if (void* p = std::aligned_alloc(a, rounded)) return p;
+    throw std::bad_alloc();
+}
+
+}  // namespace
+
+bool enabled() { return true; }
+Tag  currentTag() { return threadTag; }
+void setCurrentTag(Tag tag) { threadTag = tag; }
+void setTickThread(bool isTickThread) { tickThread = isTickThread; }
+
+void enterSteadyState(Policy policy) {
+    // load the unwinder now so the first sample does not allocate behind our back
+    void* warm[2];
+    backtrace(warm, 2);
+    abortOnViolation.store(policy == Policy::Abort, std::memory_order_relaxed);
+    steadyState.store(true, std::memory_order_release);
+}
+
+void leaveSteadyState() {
+    steadyState.store(false, std::memory_order_release);
+}
+
+TagStats stats(Tag tag) {
+    const TagCounters& c = counters[static_cast<std::size_t>(tag)];
+    return TagStats{c.allocations.load(std::memory_order_relaxed), c.bytes.load(std::memory_order_relaxed),
+                    c.frees.load(std::memory_order_relaxed)};
+}
+
+std::uint64_t steadyStateViolations() {
+    return violations.load(std::memory_order_relaxed);
+}
+
+void report(std::ostream& out) {
+    out << "\n---- heap allocations by subsystem ----\n"
+        << std::left << std::setw(12) << "Tag" << std::right << std::setw(14) << "Allocations"
+        << std::setw(16) << "Bytes" << std::setw(14) << "Frees" << "\n";
+    for (std::size_t i = 0; i < TAGS; ++i) {
+        const TagStats s = stats(static_cast<Tag>(i));
+        if (s.allocations == 0 && s.frees == 0) continue;
+        out << std::left << std::setw(12) << toString(static_cast<Tag>(i)) << std::right
+            << std::setw(14) << s.allocations << std::setw(16) << s.bytes << std::setw(14) << s.frees << "\n";
+    }
+    out << "Steady-state allocations on tick threads: " << steadyStateViolations() << "\n";
+    out.flush();
+
+    const int kept = std::min(sampleCount.load(std::memory_order_relaxed), MAX_SAMPLES);
+    for (int i = 0; i < kept; ++i) {
+        out << "  sample " << i << ": " << samples[i].size << " bytes, tag " << toString(samples[i].tag) << std::endl;
+        backtrace_symbols_fd(samples[i].stack, samples[i].frames, 2);
+    }
+}
+
+}  // namespace alloc
+
+/* ---------- global replacements (all paths end in malloc / free) ---------- */
+void* operator new(std::size_t size) { return alloc::allocate(size); }
+void* operator new[](std::size_t size) { return alloc::allocate(size); }
+void* operator new(std::size_t size, std::align_val_t a) { return alloc::allocateAligned(size, a); }
+void* operator new[](std::size_t size, std::align_val_t a) { return alloc::allocateAligned(size, a); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return alloc::allocate(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return alloc::allocate(size); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { alloc::onFree(p); std::free(p); }
+void operator delete[](void* p) noexcept { alloc::onFree(p); std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { alloc::onFree(p); std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { alloc::onFree(p); std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { alloc::onFree(p); std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alloc::onFree(p); std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { alloc::onFree(p); std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { alloc::onFree(p); std::free(p); }
+
+#else  // hooks not compiled in
+
+namespace alloc {
+
+bool enabled() { return false; }
+Tag  currentTag() { return Tag::Other; }
+void setCurrentTag(Tag) {}
+void setTickThread(bool) {}
+void enterSteadyState(Policy) {}
+void leaveSteadyState() {}
+TagStats stats(Tag) { return TagStats{}; }
+std::uint64_t steadyStateViolations() { return 0; }
+
+void report(std::ostream& out) {
+    out << "\n[alloc] Allocation tracking not compiled in (cmake -DSPACEFORGE_TRACK_ALLOCS=ON)\n";
+}
+
+}  // namespace alloc
+
+#endif  // SPACEFORGE_ALLOC_TRACKING
+
+namespace alloc {
+
+const char* toString(Tag tag) {
+    switch (tag) {
+        case Tag::Main:       return "Main";
+        case Tag::Deposition: return "Deposition";
+        case Tag::Ion:        return "Ion";
+        case Tag::Crystal:    return "Crystal";
+        case Tag::Logger:     return "Logger";
+        case Tag::Power:      return "Power";
+        case Tag::Queue:      return "Queue";
+        case Tag::Tracer:     return "Tracer";
+        default:              return "Other";
+    }
+}
+
+}  // namespace alloc
@@ -0,0 +1,222 @@
+#include "CrystalGrowthModule.hpp"
+#include "Trace.hpp"
+#include "Metrics.hpp"
+#include "AllocTracker.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+
+namespace {
+metrics::Counter& wafersGrown   = metrics::registry().counter("crystal.wafers_completed");
+metrics::Counter& growthMinutes = metrics::registry().counter("crystal.growth_minutes");
+metrics::Counter& pauses        = metrics::registry().counter("crystal.pauses");
+metrics::Counter& coldMinutes   = metrics::registry().counter("crystal.cold_minutes");
+metrics::Counter& defectsMarked = metrics::registry().counter("crystal.defects");
+
+const std::string ORBIT_SUNLIGHT = "sunlight";
+const std::string ORBIT_ECLIPSE  = "eclipse";
+}  // namespace
+
+CrystalGrowthModule::CrystalGrowthModule(StageQueue* input, const GrowthConfig& cfg)
+    : inputQueue(input), config(cfg)
+{
+    std::cout << "Called: CrystalGrowthModule::CrystalGrowthModule()" << std::endl;
+}
+
+double CrystalGrowthModule::pauseRisk(int held, int cold, bool forced) const {
+    const double hazard = config.heldRiskPerMinute * held + config.coldRiskPerMinute * cold;
+    const double p = 1.0 - std::exp(-hazard);
+    return forced ? 1.0 - (1.0 - p) * (1.0 - config.forcedPauseRisk) : p;
+}
+
+void CrystalGrowthModule::censorQueueing(int tEnd) const {
+    if (queueStats && activeTask) queueStats->censorResidence(tEnd - loadedAt);
+}
+
+bool CrystalGrowthModule::pauseHere(int t, int left, int lead) const {
+    if (config.policy == PausePolicy::RunThrough) return false;
+    const int orbitMinute = t % energy::ORBIT_MINUTES;
+    const int sunlightLeft = config.sunlightMinutes - orbitMinute;   // ≤ 0 in eclipse
+    return lead + std::min(config.pausePointMinutes, left) > sunlightLeft;
+}
+
+int CrystalGrowthModule::reheatNeeded() const {
+    return config.reheatMinutes + static_cast<int>(std::ceil(config.reheatPerColdMinute * pauseCold));
+}
+
+// the reheat and the segment after it must both finish in this arc; a reheat that never
+// could is cut to what leaves room for the segment, so the wafer still resumes
+bool CrystalGrowthModule::resumeNow(int t) const {
+    if (config.policy == PausePolicy::RunThrough) return true;
+    const int lead = std::max(0, std::min(reheatNeeded(), config.sunlightMinutes - config.pausePointMinutes));
+    return !pauseHere(t, activeTask->phase[2].timeRemaining(), lead);
+}
+
+bool CrystalGrowthModule::draw(int t, int watts, PowerModule& power, ProfiledMutex* powerMutex) {
+    if (heaterFailed) return false;
+    PowerDraw drawn;
+    {
+        std::lock_guard<ProfiledMutex> powerLock(*powerMutex);
+        if (!power.canSatisfyDemand(watts)) return false;
+        drawn = power.consumePower(watts);
+    }
+    const energy::Split part = energy::DrawSplitter(drawn).take(watts);
+    {
+        std::lock_guard<ProfiledMutex> lockPhaseCrystal(activeTask->phaseMutex[2]);
+        activeTask->phase[2].energyUsed    += watts;
+        activeTask->phase[2].solarEnergy   += part.solar;
+        activeTask->phase[2].batteryEnergy += part.battery;
+    }
+    if (energyLedger) energyLedger->book(t, 2, part);
+    return true;
+}
+
+void CrystalGrowthModule::beginPause(bool forced) {
+    paused = true;
+    pauseForced = forced;
+    pauseHeld = pauseCold = 0;
+    if (forced) {
+        stats.forcedPauses++;
+        std::lock_guard<ProfiledMutex> lockPhaseCrystal(activeTask->phaseMutex[2]);
+        activeTask->phase[2].wasInterrupted = true;
+    } else {
+        stats.pauses++;
+    }
+    pauses.add();
+}
+
+// The risk of the whole pause is drawn once, now that its length is known
+void CrystalGrowthModule::endPause() {
+    const double risk = pauseRisk(pauseHeld, pauseCold, pauseForced);
+    if (defects.drawMinute(risk)) {
+        std::lock_guard<ProfiledMutex> lockPhaseCrystal(activeTask->phaseMutex[2]);
+        if (!activeTask->phase[2].defective) stats.pauseDefects++;
+        activeTask->phase[2].defective = true;
+        defectsMarked.add();
+    }
+    paused = false;
+    reheatRemaining = reheatNeeded();
+}
+
+void CrystalGrowthModule::unload(int t) {
+    Task& task = *activeTask;
+    stats.completed++;
+    wafersGrown.add();
+    if (queueStats) {
+        queueStats->leave(t - loadedAt);
+        queueStats->finish(t - loadedAt + config.cooldownMinutes, 1);
+    }
+    task.readyMinute = t;
+    if (finishedWafers) finishedWafers->push_back(&task);
+    std::cout << "Task completed and removed from " << moduleName << ": " << task.id << "\n";
+    activeTask = nullptr;
+    cooldownRemaining = config.cooldownMinutes;
+}
+
+// One-minute update method - owns the state machine of the module
+void CrystalGrowthModule::update(int t, PowerModule& power, Logger& logger, ProfiledMutex* powerMutex, std::atomic<int>* orbitState) {
+    SF_TRACE_SCOPE("crystal.update", "module");
+    SF_ALLOC_SCOPE(alloc::Tag::Crystal);
+    const std::string& orbit = orbitState->load() == 0 ? ORBIT_SUNLIGHT : ORBIT_ECLIPSE;
+    if (heaterFailed) stats.heaterFailedMinutes++;
+
+    if (activeTask && !paused && reheatRemaining == 0 && activeTask->phase[2].isDone()) unload(t);
+
+    if (cooldownRemaining > 0) {
+        cooldownRemaining--;
+        stats.coolingMinutes++;
+        return;
+    }
+
+    // a wafer is loaded only when the policy would let it grow its first segment
+    if (!activeTask) {
+        if (heaterFailed || !inputQueue || inputQueue->empty() || pauseHere(t, config.pausePointMinutes)) {
+            stats.idleMinutes++;
+            return;
+        }
+        activeTask = inputQueue->tryPop();
+        if (!activeTask) {
+            stats.idleMinutes++;
+            return;
+        }
+        loadedAt = t;
+        stats.waferWaitMinutes += t - activeTask->readyMinute;
+        if (queueStats) queueStats->start(t - activeTask->readyMinute);
+        std::cout << "Started new task on " << moduleName << ": " << activeTask->id << "\n";
+    }
+    Task& task = *activeTask;
+    Task::PhaseInfo& phase = task.phase[2];
+
+    if (paused && resumeNow(t)) {
+        bool powered = false;
+        {
+            std::lock_guard<ProfiledMutex> powerLock(*powerMutex);
+            powered = !heaterFailed && power.canSatisfyDemand(config.runPower);
+        }
+        if (powered) endPause();
+    }
+
+    // reheat after a pause: full power, no growth; without it the wafer is still at its pause point
+    if (!paused && reheatRemaining > 0) {
+        if (draw(t, config.runPower, power, powerMutex)) {
+            reheatRemaining--;
+            stats.reheatMinutes++;
+            stats.reheatEnergy += config.runPower;
+            logger.log(t, moduleName, task.id, 2, true, false, cooldownRemaining,
+                       phase.elapsedTime, phase.requiredTime, phase.energyUsed,
+                       power.getBatteryLevel() / 1000, power.getAvailablePower(),
+                       phase.wasInterrupted, phase.defective, orbit, "reheat", 0.0f);
+            return;
+        }
+        beginPause(false);   // growth has not moved: still at its pause point; the reheat starts over
+    }
+
+    // a resume was only let through with room for the reheat and this segment: the check holds
+    if (!paused) {
+        const int left = phase.timeRemaining();
+        const bool atPausePoint = phase.elapsedTime % std::max(1, config.pausePointMinutes) == 0;
+        if (atPausePoint && pauseHere(t, left)) {
+            beginPause(false);
+        } else if (draw(t, config.runPower, power, powerMutex)) {
+            bool defect = false;
+            {
+                std::lock_guard<ProfiledMutex> lockPhaseCrystal(task.phaseMutex[2]);
+                phase.elapsedTime++;
+                if (defects.drawMinute(phase.defectChance)) {
+                    defect = !phase.defective;
+                    phase.defective = true;
+                }
+            }
+            if (defect) defectsMarked.add();
+            stats.growthMinutes++;
+            growthMinutes.add();
+            logger.log(t, moduleName, task.id, 2, true, false, cooldownRemaining,
+                       phase.elapsedTime, phase.requiredTime, phase.energyUsed,
+                       power.getBatteryLevel() / 1000, power.getAvailablePower(),
+                       phase.wasInterrupted, phase.defective, orbit, "grow", 0.0f);
+            return;
+        } else {
+            beginPause(!atPausePoint);   // the bus dropped the furnace mid-segment
+        }
+    }
+
+    // paused: hold the melt if the bus can, otherwise it goes cold
+    if (draw(t, config.holdPower, power, powerMutex)) {
+        pauseHeld++;
+        stats.heldMinutes++;
+        stats.holdEnergy += config.holdPower;
+    } else {
+        pauseCold++;
+        stats.coldMinutes++;
+        coldMinutes.add();
+    }
+    {
+        std::lock_guard<ProfiledMutex> lockPhaseCrystal(task.phaseMutex[2]);
+        phase.pausedMinutes++;
+    }
+    logger.log(t, moduleName, task.id, 2, true, false, cooldownRemaining,
+               phase.elapsedTime, phase.requiredTime, phase.energyUsed,
+               power.getBatteryLevel() / 1000, power.getAvailablePower(),
+               phase.wasInterrupted, phase.defective, orbit, "hold", 0.0f);
+}
@@ -0,0 +1,39 @@
+#include "DefectModel.hpp"
+#include <cmath>
+
+FluxHazard::FluxHazard(double baseChance, double contaminationPerMinute, double sensitivity)
+    : p_(1.0 - (1.0 - baseChance) * std::exp(-sensitivity * contaminationPerMinute)) {}
+
+double DefectSampler::uniformOpen() {
+    // 53-bit mantissa, shifted into (0, 1] so log() is always finite
+    ++draws_;
+    return (static_cast<double>(rng_() >> 11) + 1.0) * 0x1.0p-53;
+}
+
+bool DefectSampler::drawMinute(double p) {
+    return uniformOpen() <= p;
+}
+
+int DefectSampler::firstDefect(int span, double p) {
+    if (span <= 0 || p <= 0.0) return NO_DEFECT;
+    if (p >= 1.0) return 0;
+
+    // inverse CDF of the geometric distribution on {0, 1, 2, ...}
+    const double k = std::floor(std::log(uniformOpen()) / std::log1p(-p));
+    return k < static_cast<double>(span) ? static_cast<int>(k) : NO_DEFECT;
+}
+
+int DefectSampler::firstDefect(int startMinute, int span, const DefectHazard& hazard) {
+    if (hazard.isConstant()) return firstDefect(span, hazard.probability(startMinute));
+
+    // survive minute k with prob (1 - p_k)  ⇔  cumulative hazard Σ -ln(1 - p_k) stays below E
+    const double e = -std::log(uniformOpen());
+    double cumulative = 0.0;
+    for (int k = 0; k < span; ++k) {
+        const double p = hazard.probability(startMinute + k);
+        if (p >= 1.0) return k;
+        if (p > 0.0) cumulative -= std::log1p(-p);
+        if (cumulative >= e) return k;
+    }
+    return NO_DEFECT;
+}
@@ -2,12 +2,27 @@
 #include <iostream>
 #include <algorithm>
 #include <fstream> 
-#include <cstdlib> // For rand(), srand()
-#include <ctime>   // For time()
 #include <mutex>
 #include "Logger.hpp"
+#include "Trace.hpp"
+#include "Metrics.hpp"
+#include "AllocTracker.hpp"
 #include <atomic>
 
+namespace {
+// run-wide totals over all chambers; per-chamber numbers stay in ChamberStats
+metrics::Counter& wafersCompleted    = metrics::registry().counter("deposition.wafers_completed");
+metrics::Counter& busyMinutes        = metrics::registry().counter("deposition.busy_minutes");
+metrics::Counter& powerDeniedMinutes = metrics::registry().counter("deposition.power_denied_minutes");
+metrics::Counter& interruptedMinutes = metrics::registry().counter("deposition.interrupted_wafer_minutes");
+metrics::Counter& defectsMarked      = metrics::registry().counter("deposition.defects");
+metrics::Counter& blockedMinutes     = metrics::registry().counter("deposition.blocked_minutes");
+
+// orbit names for the log, built once instead of on every update
+const std::string ORBIT_SUNLIGHT = "sunlight";
+const std::string ORBIT_ECLIPSE  = "eclipse";
+}  // namespace
+
 // Constructor
 DepositionModule::DepositionModule() 
     : activeTask(nullptr), elapsed(0) 
@@ -15,95 +30,410 @@ DepositionModule::DepositionModule()
     std::cout << "Called: DepositionModule::DepositionModule()" << std::endl;
 }
 
+DepositionModule::DepositionModule(int id, StageQueue* shared, const ChamberConfig& cfg)
+    : activeTask(nullptr), elapsed(0), chamberId(id),
+      moduleName(id == 0 ? "Deposition" : "Deposition_" + std::to_string(id)),
+      sharedQueue(shared), config(cfg)
+{
+    carrier.reserve(static_cast<std::size_t>(std::max(1, config.carrierSize)));   // no allocation while loading
+    std::cout << "Called: DepositionModule::DepositionModule() | Chamber: " << chamberId << std::endl;
+}
+
 // Enqueue task into queue — now using pointer to avoid copying
 void DepositionModule::enqueue(Task* task) {
     std::cout << "Called: DepositionModule::enqueue() | Task ID: " << task->id << std::endl;
-    queue.push(task);  // store pointer to actual task from main
+    if (sharedQueue) sharedQueue->push(task);
+    else             queue.push(task);  // store pointer to actual task from main
 }
 
 // check if queue inside deposition module is empty 
 bool DepositionModule::DepositionModuleEmpty() { 
-    return queue.empty(); 
+    return sharedQueue ? sharedQueue->empty() : queue.empty();
+}
+
+std::size_t DepositionModule::queuedCount() const {
+    return sharedQueue ? sharedQueue->size() : queue.size();
+}
+
+int DepositionModule::oldestQueued() const {
+    if (sharedQueue) return sharedQueue->oldestSince();
+    return queue.empty() ? -1 : queue.front()->readyMinute;   // private queue: FIFO in arrival order
+}
+
+Task* DepositionModule::pullNext() {
+    if (sharedQueue) return sharedQueue->tryPop();
+    if (queue.empty()) return nullptr;
+    Task* next = queue.front();
+    queue.pop();
+    return next;
+}
+
+// Enable spatial maps — arena and flux are owned by the caller (main)
+void DepositionModule::attachWaferMaps(WaferMapArena* arena, const FluxMap* flux, float rateNm) {
+    mapArena = arena;
+    fluxMap = flux;
+    depositionRateNm = rateNm;
+    contaminationPerMinute = flux ? wafermap::meanContamination(*flux) : 0.0;
+}
+
+void DepositionModule::seedDefects(std::uint64_t seed) {
+    defects.seed(seed);
+}
+
+// the carrier keeps its progress through the outage; the defect spans end here
+void DepositionModule::setDown(bool isDown) {
+    if (isDown && !down) {
+        for (auto& slot : carrier) {
+            {
+                std::lock_guard<ProfiledMutex> lockPhaseDep(slot.task->phaseMutex[0]);
+                if (!slot.task->phase[0].isDone()) slot.task->phase[0].wasInterrupted = true;
+            }
+            slot.spanOpen = false;
+        }
+    }
+    down = isDown;
+}
+
+double DepositionModule::minuteHazard(const Task& task) const {
+    return FluxHazard(task.phase[0].defectChance, contaminationPerMinute).probability(0);
+}
+
+// One draw covers the whole remaining phase; re-drawn after every interruption
+// (memoryless, so this matches a Bernoulli draw per powered minute)
+void DepositionModule::beginSpan(CarrierSlot& slot) {
+    slot.minutesToDefect = defects.firstDefect(slot.task->phase[0].timeRemaining(), minuteHazard(*slot.task));
+    slot.spanOpen = true;
+}
+
+int DepositionModule::carrierPower() const {
+    const int extra = std::max<int>(0, static_cast<int>(carrier.size()) - 1);
+    return REQUIRED_POWER + extra * config.extraWaferPower;
+}
+
+// Max-wait batching: start when the carrier would be full, or when the oldest waiting
+// wafer has waited maxBatchWaitMinutes; otherwise hold the chamber idle for more wafers
+bool DepositionModule::loadCarrier(int t) {
+    const std::size_t available = queuedCount();
+    if (available == 0) return false;
+
+    // the max wait runs from when the oldest waiting wafer became available, not from when we noticed it
+    const std::size_t target = static_cast<std::size_t>(std::max(1, config.carrierSize));
+    if (available < target) {
+        const int oldest = oldestQueued();
+        if (oldest >= 0 && t - oldest < config.maxBatchWaitMinutes) {
+            stats.batchWaitMinutes++;
+            return false;
+        }
+    }
+
+    while (carrier.size() < target) {
+        Task* next = pullNext();   // another chamber may have taken wafers in between
+        if (!next) break;
+        CarrierSlot slot;
+        slot.task = next;
+        if (mapArena && fluxMap) {
+            slot.map = mapArena->acquire();   // nullptr if the pool is exhausted → run without a map
+        }
+        stats.waferWaitMinutes += t - next->readyMinute;
+        stats.wafersLoaded++;
+        if (queueStats) queueStats->start(t - next->readyMinute);
+        std::cout << "Started new task on " << moduleName << ": " << next->id << "\n";
+        carrier.push_back(slot);
+    }
+    if (carrier.empty()) return false;
+
+    activeTask = carrier.front().task;
+    carrierLoadedAt = t;
+    carrierBatch = carrier.size();
+    calibrationRemaining = config.calibrationMinutes;
+    stats.batches++;
+    return true;
+}
+
+// update() runs every powered minute through here with maxMinutes = 1
+int DepositionModule::fastForward(int maxMinutes) {
+    if (carrier.empty() || maxMinutes <= 0) return 0;
+
+    // advance to whichever comes first: the carrier finishing, a defect, or maxMinutes
+    int work = 0;
+    int n = maxMinutes;
+    for (auto& slot : carrier) {
+        work = std::max(work, slot.task->phase[0].timeRemaining());
+        if (!slot.spanOpen) beginSpan(slot);
+        if (slot.minutesToDefect != DefectSampler::NO_DEFECT) n = std::min(n, slot.minutesToDefect + 1);
+    }
+    n = std::min(n, work);
+    if (n <= 0) return 0;
+
+    const int watts = carrierPower();
+    const int share = watts / static_cast<int>(carrier.size());
+    for (std::size_t i = 0; i < carrier.size(); ++i) {
+        CarrierSlot& slot = carrier[i];
+        {
+            std::lock_guard<ProfiledMutex> lockPhaseDep(slot.task->phaseMutex[0]);
+            SF_TRACE_SCOPE("phase.lock", "lock");
+            Task::PhaseInfo& phase = slot.task->phase[0];
+            if (slot.minutesToDefect != DefectSampler::NO_DEFECT) {
+                if (slot.minutesToDefect < n) {
+                    phase.defective = true;
+                    slot.minutesToDefect = DefectSampler::NO_DEFECT;
+                    defectsMarked.add();
+                } else {
+                    slot.minutesToDefect -= n;
+                }
+            }
+            phase.elapsedTime += n;
+            phase.energyUsed  += n * (share + (i == 0 ? watts % static_cast<int>(carrier.size()) : 0));
+        }
+        if (slot.map) wafermap::accumulateMinutes(*slot.map, *fluxMap, depositionRateNm, n);
+    }
+    return n;
+}
+
+// Summarise a wafer's map into its phase record and give the map back to the arena
+void DepositionModule::finalizeMap(CarrierSlot& slot) {
+    if (!slot.map) return;
+    Task& task = *slot.task;
+    const WaferMapStats mapStats = wafermap::summarize(*slot.map);
+    {
+        std::lock_guard<ProfiledMutex> lockPhaseDep(task.phaseMutex[0]);
+        task.phase[0].meanThickness     = mapStats.meanThickness;
+        task.phase[0].nonUniformity     = mapStats.nonUniformity;
+        task.phase[0].contaminatedCells = mapStats.contaminatedCells;
+        if (mapStats.contaminatedFraction > wafermap::MAX_CONTAMINATED_FRACTION) {
+            task.phase[0].defective = true;
+        }
+    }
+    mapArena->release(slot.map);
+    slot.map = nullptr;
+}
+
+// Shared by update() and popCompletedBatch(); defined before both, its only callers
+template <typename Take>
+std::size_t DepositionModule::unloadWhile(Take take) {
+    std::size_t unloaded = 0;
+    for (auto& slot : carrier) {
+        finalizeMap(slot);   // before take(): the defect flag it may set is part of the wafer's record
+        if (!take(slot.task)) break;
+        unloaded++;
+    }
+    carrier.erase(carrier.begin(), carrier.begin() + static_cast<std::ptrdiff_t>(unloaded));
+    if (carrier.empty()) {
+        activeTask = nullptr;          // machine is now idle
+        elapsed = 0;
+    } else {
+        activeTask = carrier.front().task;
+    }
+    return unloaded;
+}
+
+void DepositionModule::censorQueueing(int tEnd) const {
+    if (!queueStats) return;
+    for (std::size_t i = 0; i < carrier.size(); ++i) queueStats->censorResidence(tEnd - carrierLoadedAt);
+}
+
+std::vector<Task*> DepositionModule::carrierTasks() const {
+    std::vector<Task*> tasks;
+    tasks.reserve(carrier.size());
+    for (const auto& slot : carrier) tasks.push_back(slot.task);
+    return tasks;
+}
+
+int DepositionModule::minutesToUnload() const {
+    int work = 0;
+    for (const auto& slot : carrier) work = std::max(work, slot.task->phase[0].timeRemaining());
+    return calibrationRemaining + work;
 }
 
-// check if a task has been completed 
+// check if the loaded carrier has been completed 
 bool DepositionModule::hasCompletedTask() {
-    return (activeTask && activeTask->phase[0].isDone());
+    if (carrier.empty()) return false;
+    for (const auto& slot : carrier) {
+        if (!slot.task->phase[0].isDone()) return false;
+    }
+    return true;
 }
 
 // One-minute update method - owns the state machine of the module 
-void DepositionModule::update(int t, PowerModule& power, Logger& logger, std::mutex* powerMutex, std::atomic<int>* orbitState) {
+void DepositionModule::update(int t, PowerModule& power, Logger& logger, ProfiledMutex* powerMutex, std::atomic<int>* orbitState) {
+    SF_TRACE_SCOPE("deposition.update", "module");
+    SF_ALLOC_SCOPE(alloc::Tag::Deposition);
     std::cout << "Called: DepositionModule::update() | Minute: " << t << std::endl;
-    std::string orbit = orbitState -> load() == 0 ? "sunlight" : "eclipse";
+    const std::string& orbit = orbitState -> load() == 0 ? ORBIT_SUNLIGHT : ORBIT_ECLIPSE;
+
+    if (down) {
+        stats.downMinutes++;
+        return;
+    }
 
-    // If task is complete, pop it
+    // If the carrier is complete, unload it (unloadWhile() is the allocation-free core of popCompletedBatch()).
+    // A full output buffer blocks the chamber: the wafers that do not fit stay on the carrier.
     if (hasCompletedTask()) {   
-        Task* finished = popCompleted();
-        std::cout << "Task completed and removed from DepositionModule: " << finished->id << "\n";
-        // Do not delete the task since main owns it
+        journal::Turn turn(outputQueue ? runJournal : nullptr, journal::Point::Unload, chamberId);
+        unloadWhile([&](Task* task) {
+            if (outputQueue && !outputQueue->tryPush(task, t)) return false;
+            if (yieldStats) yieldStats->record(*task, t);
+            if (queueStats) queueStats->leave(t - carrierLoadedAt);
+            if (finishedWafers) finishedWafers->push_back(task);
+            task->readyMinute = t;   // available to the next stage from now (buffers are drained between ticks)
+            std::cout << "Task completed and removed from " << moduleName << ": " << task->id << "\n";
+            // Do not delete the task since main owns it
+            logger.incrementThroughput();
+            stats.completed++;
+            wafersCompleted.add();
+            return true;
+        });
+        blocked = !carrier.empty();
+        if (blocked) {
+            stats.blockedMinutes++;
+            blockedMinutes.add();
+            return;
+        }
+        // the chamber takes its next carrier after the cooldown at the earliest
+        if (queueStats) queueStats->finish(t - carrierLoadedAt + config.cooldownMinutes, carrierBatch);
+        cooldownRemaining = config.cooldownMinutes;
+    }
+
+    // skip minute if cooldown is active & decrement it
+    if (cooldownRemaining > 0) {
+        cooldownRemaining--;
+        stats.coolingMinutes++;
+        return;
     }
 
-    // If no active task, try to get one from the queue
-    if (!activeTask && !queue.empty()) {
-        activeTask = queue.front(); // just point to the actual task
-        queue.pop(); // remove from queue
-        std::cout << "Started new task: " << activeTask->id << "\n";
+    // If idle, try to load a carrier from the (possibly shared) queue & start calibration
+    if (carrier.empty()) {
+        bool loaded = false;
+        {
+            journal::Turn turn(runJournal, journal::Point::Load, chamberId);
+            loaded = loadCarrier(t);
+        }
+        if (!loaded) {
+            stats.idleMinutes++;
+            return;
+        }
     }
 
-    // If there's an active task, try to run it
-    if (activeTask) {
-        int requiredPower = 300;
+    // calibration: reduced draw, no film growth, the wafers' clocks do not advance
+    if (calibrationRemaining > 0) {
+        bool calibrated = false;
+        PowerDraw draw;
+        {
+            journal::Turn turn(runJournal, journal::Point::Power, chamberId);
+            std::lock_guard<ProfiledMutex> powerLockCalibration(*powerMutex);
+            SF_TRACE_SCOPE("power.lock", "lock");   // hold time; the wait shows as the gap before it
+            if (power.canSatisfyDemand(config.calibrationPower)) {
+                draw = power.consumePower(config.calibrationPower);
+                calibrated = true;
+            }
+        }
+        if (!calibrated) {
+            stats.powerDeniedMinutes++;
+            powerDeniedMinutes.add();
+            return;
+        }
         {
-            // Lock powerMutex ONLY around power operations: lock_guard needs a name to instantiate; <std::mutex> is a template specialization "typecast"
-            std::lock_guard<std::mutex> powerLock(*powerMutex);
+            // calibration energy is booked on the first wafer of the carrier
+            std::lock_guard<ProfiledMutex> lockPhaseDep(activeTask->phaseMutex[0]);
+            SF_TRACE_SCOPE("phase.lock", "lock");
+            activeTask->phase[0].energyUsed += config.calibrationPower;
+            const energy::Split part = energy::DrawSplitter(draw).take(config.calibrationPower);
+            activeTask->phase[0].solarEnergy   += part.solar;
+            activeTask->phase[0].batteryEnergy += part.battery;
+            if (energyLedger) energyLedger->book(t, 0, part);
+        }
+        calibrationRemaining--;
+        stats.calibratingMinutes++;
+        logger.log(t, moduleName, activeTask->id, 0, true, true, calibrationRemaining,   // calibration countdown
+                   activeTask->phase[0].elapsedTime, activeTask->phase[0].requiredTime,
+                   activeTask->phase[0].energyUsed, power.getBatteryLevel() / 1000,
+                   power.getAvailablePower(), activeTask->phase[0].wasInterrupted,
+                   activeTask->phase[0].defective, orbit, "calibrate", 0.0f);
+        return;
+    }
 
-            if (power.canSatisfyDemand(requiredPower)) {
-                power.consumePower(requiredPower);
-            } else {
+    // The carrier is one power consumer: it either runs as a whole or stalls as a whole
+    int requiredPower = carrierPower();
+    PowerDraw draw;
+    {
+        // Lock powerMutex ONLY around power operations; the guard must be named, or it unlocks at the end of the statement
+        journal::Turn turn(runJournal, journal::Point::Power, chamberId);   // whoever draws first may starve the rest
+        std::lock_guard<ProfiledMutex> powerLock(*powerMutex);
+        SF_TRACE_SCOPE("power.lock", "lock");
+
+        if (power.canSatisfyDemand(requiredPower)) {
+            draw = power.consumePower(requiredPower);
+        } else {
+            for (auto& slot : carrier) {
                 {
-                    std::lock_guard<std::mutex> lockPhaseDep(activeTask->phaseMutex[0]);
-                    activeTask->phase[0].wasInterrupted = true;
-                    activeTask->phase[0].elapsedTime++;
+                    std::lock_guard<ProfiledMutex> lockPhaseDep(slot.task->phaseMutex[0]);
+                    SF_TRACE_SCOPE("phase.lock", "lock");
+                    slot.task->phase[0].wasInterrupted = true;
+                    slot.task->phase[0].elapsedTime++;
                 }
-                std::cout << "Not enough power, skipping this task this minute.\n";
-                return;
+                slot.spanOpen = false;   // the uninterrupted span ends here
+                if (slot.map) wafermap::accumulateMinute(*slot.map, *fluxMap, depositionRateNm, false);
             }
-        }   // mutex is unlocked 
+            stats.powerDeniedMinutes++;
+            powerDeniedMinutes.add();
+            interruptedMinutes.add(carrier.size());
+            std::cout << "Not enough power, skipping this task this minute.\n";
+            return;
+        }
+    }   // mutex is unlocked 
 
-        // Now lock the task phase safely to increment ITS elapsedTime and energyUsed
+    // Now lock each task phase safely to book ITS solar / battery share of the minute
+    const int share = requiredPower / static_cast<int>(carrier.size());
+    energy::DrawSplitter split(draw);   // solar / battery follow the same per-wafer shares
+    for (std::size_t i = 0; i < carrier.size(); ++i) {
+        Task* task = carrier[i].task;
+        const int watts = share + (i == 0 ? requiredPower % static_cast<int>(carrier.size()) : 0);
+        const energy::Split part = split.take(watts);
         {
-            std::lock_guard<std::mutex> lockPhaseDep(activeTask -> phaseMutex[0]);
-            activeTask -> phase[0].energyUsed += requiredPower;
-            runOneMinute(*activeTask, power, logger);
-            activeTask -> phase[0].elapsedTime++;
+            std::lock_guard<ProfiledMutex> lockPhaseDep(task -> phaseMutex[0]);
+            SF_TRACE_SCOPE("phase.lock", "lock");
+            task -> phase[0].solarEnergy   += part.solar;
+            task -> phase[0].batteryEnergy += part.battery;
+            runOneMinute(*task, power, logger);
         }
+        if (energyLedger) energyLedger->book(t, 0, part);
+    }
+
+    // one powered minute: film, defect span, clocks and energyUsed, the same path as a jump
+    fastForward(1);
+
+    for (std::size_t i = 0; i < carrier.size(); ++i) {
+        Task* task = carrier[i].task;
 
         logger.log(
             t,
-            "Deposition",
-            activeTask->id,
+            moduleName,
+            task->id,
             0,
             true,
             false,
-            0,
-            activeTask->phase[0].elapsedTime,
-            activeTask->phase[0].requiredTime,
-            activeTask->phase[0].energyUsed,
+            cooldownRemaining,
+            task->phase[0].elapsedTime,
+            task->phase[0].requiredTime,
+            task->phase[0].energyUsed,
             power.getBatteryLevel() / 1000,
             power.getAvailablePower(),
-            activeTask->phase[0].wasInterrupted,
-            activeTask->phase[0].defective,
+            task->phase[0].wasInterrupted,
+            task->phase[0].defective,
             orbit,  // You'll need to pass orbit string into update()
             "run",
             0.0f
         );
     }
+    stats.busyMinutes++;
+    busyMinutes.add();
 }
 
 
 // Static function to run one minute of deposition
 // Static because it doesn't use any internal members of the DepositionModule class
 void DepositionModule::runOneMinute(Task& task, PowerModule& power, Logger& logger) {
+    SF_TRACE_SCOPE("debug.file", "io");   // open + append + close, once per wafer-minute
     std::ofstream file("debugLogs/deposition_debug_log.txt", std::ios::app);
 
     if (!file.is_open()) {
@@ -118,33 +448,48 @@ void DepositionModule::runOneMinute(Task& task, PowerModule& power, Logger& logg
     file << "  Battery levels_post_exec: " << power.getBatteryLevel() << "\n";
     file << "--------------------------\n";
     file.close();
-
-    // Generate a random number between 0 and 1
-    double randomNumber = static_cast<double>(rand()) / RAND_MAX;
-
-    if (randomNumber < task.phase[0].defectChance) {
-        task.phase[0].defective = true;
-    }
 }
 
-// Pop the completed task
-Task* DepositionModule::popCompleted() {
+// Unload the finished carrier
+std::vector<Task*> DepositionModule::popCompletedBatch() {
     std::cout << "Called: DepositionModule::popCompleted()" << std::endl;
-    Task* completed = activeTask;  // just return pointer, no copy
-    activeTask = nullptr;          // machine is now idle
-    elapsed = 0;
+    std::vector<Task*> completed;
+    completed.reserve(carrier.size());
+    unloadWhile([&completed](Task* task) {
+        completed.push_back(task);  // just return pointers, no copy
+        return true;
+    });
     return completed;
 }
 
-// Discard a task from the active slot and internal queue
+// Pop the completed task (first wafer of the carrier)
+Task* DepositionModule::popCompleted() {
+    const std::vector<Task*> completed = popCompletedBatch();
+    return completed.empty() ? nullptr : completed.front();
+}
+
+// Discard a task from the carrier and internal queue
 void DepositionModule::discardTask_dep(Task* task) {
     std::cout << "[DepositionModule] Discarding Task: " << task->id << std::endl;
 
     // If the task is currently being processed
-    if (activeTask == task) {
-        std::cout << "[DepositionModule] Task was active. Resetting active slot.\n";
-        activeTask = nullptr;
+    for (auto it = carrier.begin(); it != carrier.end(); ++it) {
+        if (it->task != task) continue;
+        std::cout << "[DepositionModule] Task was active. Removing it from the carrier.\n";
+        if (it->map) {
+            mapArena->release(it->map);   // discarded wafers keep no spatial summary
+        }
+        carrier.erase(it);
+        break;
+    }
+    activeTask = carrier.empty() ? nullptr : carrier.front().task;
+    if (carrier.empty()) {
         elapsed = 0;
+        calibrationRemaining = 0;
+    }
+
+    if (sharedQueue && sharedQueue->remove(task)) {
+        std::cout << "[DepositionModule] Task found in shared queue and removed: " << task->id << "\n";
     }
 
     // Rebuild the queue without the discarded task
@@ -0,0 +1,81 @@
+#include "EnergyLedger.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace energy {
+
+MilliWattMinutes OrbitRollup::total(Source source) const {
+    MilliWattMinutes sum = 0;
+    for (const auto& stage : drawn) sum += stage[static_cast<std::size_t>(source)];
+    return sum;
+}
+
+EnergyLedger::EnergyLedger(int minutes) {
+    orbits_.reserve(static_cast<std::size_t>(std::max(0, minutes) / ORBIT_MINUTES + 1));
+}
+
+void EnergyLedger::closeWafer(const Task& wafer) {
+    const MilliWattMinutes battery = wafer.batteryEnergy();
+    wafers_++;
+    waferBattery_ += battery;
+    if (!worstWafer_ || battery > worstBattery_) {
+        worstBattery_ = battery;
+        worstWafer_ = &wafer;
+    }
+}
+
+void EnergyLedger::merge(const EnergyLedger& other) {
+    if (orbits_.size() < other.orbits_.size()) orbits_.resize(other.orbits_.size());
+    for (std::size_t o = 0; o < other.orbits_.size(); ++o) {
+        for (std::size_t s = 0; s < STAGES; ++s) {
+            orbits_[o].drawn[s][0] += other.orbits_[o].drawn[s][0];
+            orbits_[o].drawn[s][1] += other.orbits_[o].drawn[s][1];
+        }
+    }
+    wafers_ += other.wafers_;
+    waferBattery_ += other.waferBattery_;
+    if (other.worstWafer_ && (!worstWafer_ || other.worstBattery_ > worstBattery_)) {
+        worstBattery_ = other.worstBattery_;
+        worstWafer_ = other.worstWafer_;
+    }
+}
+
+MilliWattMinutes EnergyLedger::total(Source source) const {
+    MilliWattMinutes sum = 0;
+    for (const auto& orbit : orbits_) sum += orbit.total(source);
+    return sum;
+}
+
+void EnergyLedger::report(std::ostream& out) const {
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    const auto pct = [](MilliWattMinutes part, MilliWattMinutes whole) {
+        return whole > 0 ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+    };
+
+    out << "\nOrbit | Solar (W·min) | Battery (W·min) | Battery % | Depo solar/battery | Ion solar/battery | Crystal solar/battery\n"
+        << std::fixed << std::setprecision(1);
+    for (std::size_t o = 0; o < orbits_.size(); ++o) {
+        const OrbitRollup& orbit = orbits_[o];
+        const MilliWattMinutes solar = orbit.total(Source::Solar);
+        const MilliWattMinutes battery = orbit.total(Source::Battery);
+        out << o << " | " << wattMinutes(solar) << " | " << wattMinutes(battery) << " | " << pct(battery, solar + battery);
+        for (const auto& stage : orbit.drawn) out << " | " << wattMinutes(stage[0]) << "/" << wattMinutes(stage[1]);
+        out << "\n";
+    }
+
+    const MilliWattMinutes solar = total(Source::Solar);
+    const MilliWattMinutes battery = total(Source::Battery);
+    out << "Energy: solar " << wattMinutes(solar) << " W·min | battery " << wattMinutes(battery)
+        << " W·min (" << pct(battery, solar + battery) << " %)\n";
+    if (wafers_ > 0) {
+        out << "Battery energy per wafer: mean " << wattMinutes(waferBattery_) / static_cast<double>(wafers_)
+            << " W·min over " << wafers_ << " wafers | max " << wattMinutes(worstBattery_)
+            << " W·min (" << worstWafer_->id << ")\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+}  // namespace energy
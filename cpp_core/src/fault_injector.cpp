@@ -0,0 +1,217 @@
+#include "FaultInjector.hpp"
+#include "PowerBus.hpp"
+#include "DepositionModule.hpp"
+#include "IonImplantationModule.hpp"
+#include "CrystalGrowthModule.hpp"
+#include "Metrics.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace faults {
+
+namespace {
+metrics::Counter& injectedCount = metrics::registry().counter("faults.injected");
+metrics::Counter& repairedCount = metrics::registry().counter("faults.repaired");
+
+bool stochastic(const FaultSpec& spec) { return spec.at < 0; }
+}  // namespace
+
+const char* toString(FaultKind kind) {
+    switch (kind) {
+        case FaultKind::Panel:       return "panel";
+        case FaultKind::Cell:        return "cell";
+        case FaultKind::BatteryTrip: return "battery_trip";
+        case FaultKind::Heater:      return "heater";
+        case FaultKind::Chamber:     return "chamber";
+        case FaultKind::Implanter:   return "implanter";
+    }
+    return "?";
+}
+
+bool parseKind(const std::string& name, FaultKind& kind) {
+    for (FaultKind k : {FaultKind::Panel, FaultKind::Cell, FaultKind::BatteryTrip,
+                        FaultKind::Heater, FaultKind::Chamber, FaultKind::Implanter}) {
+        if (name == toString(k)) {
+            kind = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool loadSpecs(const std::string& path, std::vector<FaultSpec>& specs, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        FaultSpec spec;
+        bool any = false, kindSet = false;
+        for (std::string field; fields >> field;) {
+            any = true;
+            const std::size_t eq = field.find('=');
+            const std::string key = field.substr(0, eq);
+            const std::string value = eq == std::string::npos ? "" : field.substr(eq + 1);
+            char* end = nullptr;
+            const double number = std::strtod(value.c_str(), &end);
+            const bool numeric = !value.empty() && *end == '\0';
+            if (key == "kind") {
+                kindSet = parseKind(value, spec.kind);
+                if (!kindSet) {
+                    error = path + ":" + std::to_string(lineNo) + ": unknown fault kind " + value;
+                    return false;
+                }
+            } else if (numeric && key == "target") {
+                spec.target = static_cast<int>(number);
+            } else if (numeric && key == "at") {
+                spec.at = static_cast<int>(number);
+            } else if (numeric && key == "mtbf") {
+                spec.mtbf = number;
+            } else if (numeric && key == "repair") {
+                spec.repair = number;
+            } else if (numeric && key == "size") {
+                spec.size = static_cast<int>(number);
+            } else {
+                error = path + ":" + std::to_string(lineNo) + ": bad field " + field;
+                return false;
+            }
+        }
+        if (!any) continue;   // blank or comment
+        if (!kindSet || (spec.at < 0 && spec.mtbf <= 0.0)) {
+            error = path + ":" + std::to_string(lineNo) + ": needs kind= and at= or mtbf=";
+            return false;
+        }
+        if (spec.kind == FaultKind::Chamber && spec.target < 0) {
+            error = path + ":" + std::to_string(lineNo) + ": chamber fault needs target=<chamber index>";
+            return false;
+        }
+        specs.push_back(spec);
+    }
+    return true;
+}
+
+FaultInjector::FaultInjector(const std::vector<FaultSpec>& specs, std::uint64_t seed)
+    : specs_(specs), stats_(specs.size()), since_(specs.size(), -1), rng_(seed)
+{
+    heap_.reserve(specs_.size());   // a spec has at most one event pending: the heap never grows in the run
+    for (std::uint32_t i = 0; i < specs_.size(); ++i) {
+        FaultSpec& spec = specs_[i];
+        if (spec.size <= 0) {
+            if (spec.kind == FaultKind::Panel) spec.size = PANEL_STRING_WATTS;
+            if (spec.kind == FaultKind::Cell)  spec.size = CELL_CAPACITY;
+        }
+        if (spec.kind == FaultKind::Cell) spec.repair = 0.0;   // a failed cell stays failed
+        if (spec.kind == FaultKind::Chamber && spec.target >= static_cast<int>(chamberFaults_.size()))
+            chamberFaults_.resize(static_cast<std::size_t>(std::max(0, spec.target)) + 1, 0);
+        if (!stochastic(spec)) schedule(spec.at, i, false);
+        else if (spec.mtbf > 0.0) schedule(sampleMinutes(spec.mtbf), i, false);
+    }
+}
+
+int FaultInjector::nextEventAt() const {
+    return heap_.empty() ? std::numeric_limits<int>::max() : heap_.front().minute;
+}
+
+// exponential, at least one minute so a repaired target runs before it can fail again
+int FaultInjector::sampleMinutes(double mean) {
+    return std::max(1, static_cast<int>(std::lround(mean * unitExp_(rng_))));
+}
+
+void FaultInjector::schedule(int minute, std::uint32_t spec, bool repair) {
+    heap_.push_back(Event{minute, seq_++, spec, repair});
+    std::push_heap(heap_.begin(), heap_.end(), later);
+}
+
+void FaultInjector::fire(int t) {
+    SF_TRACE_SCOPE("faults.fire", "tick");
+    while (!heap_.empty() && heap_.front().minute <= t) {
+        std::pop_heap(heap_.begin(), heap_.end(), later);
+        const Event event = heap_.back();
+        heap_.pop_back();
+        const FaultSpec& spec = specs_[event.spec];
+        FaultStats& stats = stats_[event.spec];
+
+        if (!event.repair) {
+            apply(spec, +1);
+            stats.injected++;
+            injectedCount.add();
+            since_[event.spec] = event.minute;
+            active_++;
+            if (spec.repair > 0.0) {
+                const int repairMinutes = stochastic(spec) ? sampleMinutes(spec.repair)
+                                                           : std::max(1, static_cast<int>(std::lround(spec.repair)));
+                schedule(event.minute + repairMinutes, event.spec, true);
+            }
+        } else {
+            apply(spec, -1);
+            stats.repaired++;
+            repairedCount.add();
+            stats.faultMinutes += event.minute - since_[event.spec];
+            since_[event.spec] = -1;
+            active_--;
+            if (stochastic(spec)) schedule(event.minute + sampleMinutes(spec.mtbf), event.spec, false);
+        }
+    }
+}
+
+void FaultInjector::apply(const FaultSpec& spec, int delta) {
+    switch (spec.kind) {
+        case FaultKind::Panel:
+            panelLost_ += delta * spec.size;
+            if (power_) power_->setSolarDerate(panelLost_);
+            break;
+        case FaultKind::Cell:
+            if (power_ && delta > 0) power_->loseBatteryCapacity(spec.size);
+            break;
+        case FaultKind::BatteryTrip:
+            batteryTrips_ += delta;
+            if (power_) power_->setBatteryTripped(batteryTrips_ > 0);
+            break;
+        case FaultKind::Heater:
+            heaterFaults_ += delta;
+            if (furnace_) furnace_->setHeaterFailed(heaterFaults_ > 0);
+            break;
+        case FaultKind::Chamber: {
+            if (spec.target < 0) break;
+            int& count = chamberFaults_[static_cast<std::size_t>(spec.target)];
+            count += delta;
+            if (static_cast<std::size_t>(spec.target) < chambers_.size())
+                chambers_[static_cast<std::size_t>(spec.target)]->setDown(count > 0);
+            break;
+        }
+        case FaultKind::Implanter:
+            implanterFaults_ += delta;
+            if (implanter_) implanter_->setDown(implanterFaults_ > 0);
+            break;
+    }
+}
+
+void FaultInjector::report(std::ostream& out, int tEnd) const {
+    out << "\n-- Fault injection (" << specs_.size() << " specs, " << active_ << " still active) --\n";
+    out << "kind | target | when | repair | injected | repaired | fault min\n";
+    for (std::size_t i = 0; i < specs_.size(); ++i) {
+        const FaultSpec& spec = specs_[i];
+        const FaultStats& stats = stats_[i];
+        const long long open = since_[i] >= 0 ? tEnd - since_[i] : 0;
+        std::ostringstream when, repair;
+        if (stochastic(spec)) when << "mtbf " << spec.mtbf;
+        else                  when << "at " << spec.at;
+        if (spec.repair > 0.0) repair << spec.repair;   // as parsed: a mean may be fractional
+        else                   repair << "never";
+        out << toString(spec.kind) << " | " << (spec.kind == FaultKind::Chamber ? std::to_string(spec.target) : "-")
+            << " | " << when.str() << " | " << repair.str()
+            << " | " << stats.injected << " | " << stats.repaired << " | " << stats.faultMinutes + open << "\n";
+    }
+}
+
+}  // namespace faults
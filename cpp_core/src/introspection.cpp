@@ -0,0 +1,171 @@
+#include "Introspection.hpp"
+#include "Metrics.hpp"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+constexpr int POLL_MS = 200;                 // how quickly stop() is noticed
+constexpr std::size_t MAX_LINE = 256;
+
+bool writeAll(int fd, const std::string& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+void writeMinute(std::ostream& out, const RunSnapshot& s) {
+    out << "minute " << s.minute << "\n"
+        << "duration " << s.simDuration << "\n"
+        << "orbit " << s.orbit << "\n";
+}
+
+void writeBattery(std::ostream& out, const RunSnapshot& s) {
+    out << "battery_mwh " << s.batteryLevel << "\n"
+        << "battery_soc " << s.batterySOC << "\n"
+        << "power_available_w " << s.powerAvailable << "\n";
+}
+
+void writeThroughput(std::ostream& out, const RunSnapshot& s) {
+    out << "throughput " << s.throughput << "/" << s.wafersTotal << "\n";
+}
+
+void writeQueues(std::ostream& out, const RunSnapshot& s) {
+    out << "queue deposition " << s.depositionQueued;
+    for (const auto& id : s.depositionQueue) out << " " << id;
+    if (s.depositionQueued > s.depositionQueue.size()) out << " ...";
+    out << "\n";
+    for (const auto& c : s.chambers) {
+        out << "chamber " << c.name << " " << c.state << " completed=" << c.completed
+            << " denied=" << c.powerDeniedMinutes << " carrier=";
+        for (std::size_t i = 0; i < c.carrier.size(); ++i) out << (i ? "," : "") << c.carrier[i];
+        if (c.carrier.empty()) out << "-";
+        out << "\n";
+    }
+}
+
+void writeMetrics(std::ostream& out) {
+    const metrics::Snapshot snap = metrics::registry().snapshot();
+    for (const auto& [name, v] : snap.counters) out << "counter " << name << " " << v << "\n";
+    for (const auto& [name, g] : snap.gauges) out << "gauge " << name << " " << g.value << " max=" << g.max << "\n";
+    for (const auto& [name, h] : snap.histograms) {
+        out << "histogram " << name << " n=" << h.count << " mean=" << h.mean()
+            << " p50<=" << h.quantile(0.50) << " p99<=" << h.quantile(0.99) << "\n";
+    }
+}
+
+}  // namespace
+
+IntrospectionServer::IntrospectionServer(std::string socketPath, const SnapshotPublisher& publisher)
+    : path_(std::move(socketPath)), publisher_(publisher) {}
+
+IntrospectionServer::~IntrospectionServer() {
+    stop();
+}
+
+bool IntrospectionServer::start() {
+    sockaddr_un addr{};
+    if (path_.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[introspection] Socket path too long: " << path_ << std::endl;
+        return false;
+    }
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0) return false;
+
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+    ::unlink(path_.c_str());   // stale socket from a previous run
+    if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listenFd_, 4) != 0) {
+        std::cerr << "[introspection] Could not listen on " << path_ << ": " << std::strerror(errno) << std::endl;
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&IntrospectionServer::serve, this);
+    std::cout << "[introspection] Listening on " << path_ << std::endl;
+    return true;
+}
+
+void IntrospectionServer::stop() {
+    if (!running_.exchange(false)) return;
+    if (thread_.joinable()) thread_.join();
+    ::close(listenFd_);
+    listenFd_ = -1;
+    ::unlink(path_.c_str());
+}
+
+void IntrospectionServer::serve() {
+    while (running_) {
+        pollfd pfd{listenFd_, POLLIN, 0};
+        if (::poll(&pfd, 1, POLL_MS) <= 0) continue;
+        const int client = ::accept(listenFd_, nullptr, nullptr);
+        if (client < 0) continue;
+        serveClient(client);
+        ::close(client);
+    }
+}
+
+void IntrospectionServer::serveClient(int fd) {
+    std::string pending;
+    char buffer[512];
+    while (running_) {
+        pollfd pfd{fd, POLLIN, 0};
+        const int ready = ::poll(&pfd, 1, POLL_MS);
+        if (ready < 0) return;
+        if (ready == 0) continue;
+
+        const ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) return;   // client closed
+        pending.append(buffer, static_cast<std::size_t>(n));
+
+        std::size_t eol;
+        while ((eol = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, eol);
+            pending.erase(0, eol + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line == "quit") return;
+            if (!writeAll(fd, handle(line))) return;
+        }
+        if (pending.size() > MAX_LINE) return;   // not a line-based client
+    }
+}
+
+std::string IntrospectionServer::handle(const std::string& command) const {
+    std::ostringstream out;
+    const std::shared_ptr<const RunSnapshot> snap = publisher_.latest();
+
+    if (command == "help") {
+        out << "commands: minute battery throughput queues metrics all help quit\n";
+    } else if (command == "metrics") {
+        writeMetrics(out);
+    } else if (command == "minute" || command == "battery" || command == "throughput" ||
+               command == "queues" || command == "all") {
+        if (!snap) {
+            out << "error no snapshot published yet\n";
+        } else {
+            if (command == "minute"     || command == "all") writeMinute(out, *snap);
+            if (command == "battery"    || command == "all") writeBattery(out, *snap);
+            if (command == "throughput" || command == "all") writeThroughput(out, *snap);
+            if (command == "queues"     || command == "all") writeQueues(out, *snap);
+            if (command == "all") writeMetrics(out);
+        }
+    } else {
+        out << "error unknown command '" << command << "' (try help)\n";
+    }
+    out << ".\n";
+    return out.str();
+}
@@ -0,0 +1,211 @@
+#include "IonImplantationModule.hpp"
+#include "Trace.hpp"
+#include "Metrics.hpp"
+#include "AllocTracker.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+
+namespace {
+metrics::Counter& wafersImplanted = metrics::registry().counter("ion.wafers_completed");
+metrics::Counter& wafersScrapped  = metrics::registry().counter("ion.wafers_scrapped");
+metrics::Counter& beamMinutes     = metrics::registry().counter("ion.beam_minutes");
+metrics::Counter& beamTrips       = metrics::registry().counter("ion.beam_trips");
+metrics::Counter& defectsMarked   = metrics::registry().counter("ion.defects");
+
+const std::string ORBIT_SUNLIGHT = "sunlight";
+const std::string ORBIT_ECLIPSE  = "eclipse";
+}  // namespace
+
+IonImplantationModule::IonImplantationModule(StageQueue* input, const ImplantConfig& cfg)
+    : inputQueue(input), config(cfg)
+{
+    std::cout << "Called: IonImplantationModule::IonImplantationModule()" << std::endl;
+}
+
+void IonImplantationModule::seed(std::uint64_t s) {
+    defects.seed(s);
+    driftRng.seed(s ^ 0x9e3779b97f4a7c15ULL);
+    driftStep.reset();
+}
+
+double IonImplantationModule::doseRate(int watts) const {
+    if (watts < config.minBeamPower || config.runPower <= 0) return 0.0;
+    const double currentA = config.beamCurrentMa * 1e-3 * std::min(1.0, static_cast<double>(watts) / config.runPower);
+    return currentA * 60.0 / (ELEMENTARY_CHARGE * config.waferAreaCm2);
+}
+
+void IonImplantationModule::censorQueueing(int tEnd) const {
+    if (queueStats && activeTask) queueStats->censorResidence(tEnd - loadedAt);
+}
+
+void IonImplantationModule::unload(int t) {
+    Task& task = *activeTask;
+    if (scrapPending) {
+        stats.scrapped++;
+        stats.doseScrapped += task.phase[1].dose;
+        wafersScrapped.add();
+        if (scrappedWafers) scrappedWafers->push_back(&task);
+        std::cout << "Task scrapped in " << moduleName << " after " << task.phase[1].retries
+                  << " beam trips: " << task.id << "\n";
+    } else {
+        stats.completed++;
+        wafersImplanted.add();
+        std::cout << "Task completed and removed from " << moduleName << ": " << task.id << "\n";
+    }
+    if (queueStats) {
+        queueStats->leave(t - loadedAt);
+        queueStats->finish(t - loadedAt + config.cooldownMinutes, 1);
+    }
+    task.readyMinute = t;
+    if (outputQueue && !scrapPending) outputQueue->push(&task);
+    activeTask = nullptr;
+    scrapPending = false;
+    calibrationRemaining = 0;
+    cooldownRemaining = config.cooldownMinutes;
+}
+
+// The dose stays on the wafer; only the beam has to be tuned again before it resumes
+void IonImplantationModule::trip() {
+    Task::PhaseInfo& phase = activeTask->phase[1];
+    {
+        std::lock_guard<ProfiledMutex> lockPhaseIon(activeTask->phaseMutex[1]);
+        phase.wasInterrupted = true;
+        phase.retries++;
+        if (phase.retries > config.maxRetries) {
+            phase.defective = true;
+            scrapPending = true;
+        }
+    }
+    beamTrips.add();
+    if (scrapPending) return;
+    stats.resumed++;
+    stats.doseKept += phase.dose - doseAtLastTrip;   // only what this trip would have cost: earlier trips booked the rest
+    doseAtLastTrip = phase.dose;
+    calibrationRemaining = config.calibrationMinutes;
+}
+
+void IonImplantationModule::setDown(bool isDown) {
+    const bool beamOn = activeTask && calibrationRemaining == 0 && !scrapPending &&
+                        activeTask->phase[1].dose < config.targetDose;
+    if (isDown && !down && beamOn) trip();
+    down = isDown;
+}
+
+// One-minute update method - owns the state machine of the module
+void IonImplantationModule::update(int t, PowerModule& power, Logger& logger, ProfiledMutex* powerMutex, std::atomic<int>* orbitState) {
+    SF_TRACE_SCOPE("ion.update", "module");
+    SF_ALLOC_SCOPE(alloc::Tag::Ion);
+    const std::string& orbit = orbitState->load() == 0 ? ORBIT_SUNLIGHT : ORBIT_ECLIPSE;
+
+    if (down) {
+        stats.downMinutes++;
+        return;
+    }
+
+    if (activeTask && (scrapPending || activeTask->phase[1].dose >= config.targetDose)) unload(t);
+
+    if (cooldownRemaining > 0) {
+        cooldownRemaining--;
+        stats.coolingMinutes++;
+        return;
+    }
+
+    if (!activeTask) {
+        activeTask = inputQueue ? inputQueue->tryPop() : nullptr;
+        if (!activeTask) {
+            stats.idleMinutes++;
+            return;
+        }
+        loadedAt = t;
+        doseAtLastTrip = 0.0;
+        stats.waferWaitMinutes += t - activeTask->readyMinute;
+        if (queueStats) queueStats->start(t - activeTask->readyMinute);
+        calibrationRemaining = config.calibrationMinutes;
+        std::cout << "Started new task on " << moduleName << ": " << activeTask->id << "\n";
+    }
+    Task& task = *activeTask;
+
+    // beam tune: reduced draw, no dose; the drift is measured out at the end of it
+    if (calibrationRemaining > 0) {
+        PowerDraw draw;
+        {
+            std::lock_guard<ProfiledMutex> powerLock(*powerMutex);
+            if (!power.canSatisfyDemand(config.calibrationPower)) {
+                stats.powerDeniedMinutes++;
+                return;
+            }
+            draw = power.consumePower(config.calibrationPower);
+        }
+        const energy::Split part = energy::DrawSplitter(draw).take(config.calibrationPower);
+        {
+            std::lock_guard<ProfiledMutex> lockPhaseIon(task.phaseMutex[1]);
+            task.phase[1].energyUsed    += config.calibrationPower;
+            task.phase[1].solarEnergy   += part.solar;
+            task.phase[1].batteryEnergy += part.battery;
+        }
+        if (energyLedger) energyLedger->book(t, 1, part);
+        if (--calibrationRemaining == 0) drift = 1.0;
+        stats.calibratingMinutes++;
+        logger.log(t, moduleName, task.id, 1, true, true, calibrationRemaining,   // calibration countdown
+                   task.phase[1].elapsedTime, task.phase[1].requiredTime,
+                   task.phase[1].energyUsed, power.getBatteryLevel() / 1000,
+                   power.getAvailablePower(), task.phase[1].wasInterrupted,
+                   task.phase[1].defective, orbit, "calibrate", 0.0f);
+        return;
+    }
+
+    // the beam takes what is left of the minute, up to runPower; too little and it trips
+    int granted = 0;
+    PowerDraw draw;
+    {
+        std::lock_guard<ProfiledMutex> powerLock(*powerMutex);
+        granted = std::min(config.runPower, power.getAvailablePower());
+        if (granted >= config.minBeamPower) draw = power.consumePower(granted);
+    }
+    if (granted < config.minBeamPower) {
+        stats.powerDeniedMinutes++;
+        trip();
+        if (scrapPending) {   // past maxRetries: unloaded as scrapped next minute, its dose is lost
+            std::cout << "Beam trip on " << moduleName << ": " << task.id << " scrapped after " << task.phase[1].retries
+                      << " trips, loses " << task.phase[1].dose << " ions/cm²\n";
+        } else {
+            std::cout << "Beam trip on " << moduleName << ": " << task.id << " keeps " << task.phase[1].dose << " ions/cm²\n";
+        }
+        return;
+    }
+
+    const energy::Split part = energy::DrawSplitter(draw).take(granted);
+    const double delivered = std::min(doseRate(granted) * drift, config.targetDose - task.phase[1].dose);   // blanked at target
+    {
+        std::lock_guard<ProfiledMutex> lockPhaseIon(task.phaseMutex[1]);
+        task.phase[1].energyUsed    += granted;
+        task.phase[1].solarEnergy   += part.solar;
+        task.phase[1].batteryEnergy += part.battery;
+        task.phase[1].dose          += delivered;
+        task.phase[1].elapsedTime++;
+        if (defects.drawMinute(task.phase[1].defectChance)) {
+            task.phase[1].defective = true;
+            defectsMarked.add();
+        }
+    }
+    if (energyLedger) energyLedger->book(t, 1, part);
+    stats.doseDelivered += delivered;
+    stats.beamMinutes++;
+    if (granted < config.runPower) stats.reducedBeamMinutes++;
+    beamMinutes.add();
+
+    // the current wanders from its tune; past the band the beam is tuned again (the dose is measured, so none is lost)
+    drift *= std::exp(config.driftSigma * driftStep(driftRng));
+    if (std::fabs(drift - 1.0) > config.driftLimit && task.phase[1].dose < config.targetDose) {
+        calibrationRemaining = config.calibrationMinutes;
+        stats.retunes++;
+    }
+
+    logger.log(t, moduleName, task.id, 1, true, false, cooldownRemaining,
+               task.phase[1].elapsedTime, task.phase[1].requiredTime,
+               task.phase[1].energyUsed, power.getBatteryLevel() / 1000,
+               power.getAvailablePower(), task.phase[1].wasInterrupted,
+               task.phase[1].defective, orbit, "implant", 0.0f);
+}
@@ -0,0 +1,421 @@
+#include "Journal.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+namespace journal {
+namespace {
+
+constexpr char MAGIC[4] = {'S', 'F', 'J', '1'};
+constexpr std::uint8_t VERSION = 4;                             // 2: recipe, 3: lot + precedence, 4: real params
+constexpr std::size_t FLUSH_BYTES = 64 * 1024;                  // main writes the buffer out past this
+
+void putVarint(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+void putSigned(std::vector<std::uint8_t>& out, std::int64_t v) {
+    putVarint(out, (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63));   // zig-zag
+}
+
+void putFixed64(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+void putDouble(std::vector<std::uint8_t>& out, double d) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &d, sizeof bits);
+    putFixed64(out, bits);
+}
+
+void putString(std::vector<std::uint8_t>& out, const std::string& s) {
+    putVarint(out, s.size());
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+// Reader over the whole file; every get* returns false past the end
+struct Reader {
+    const std::uint8_t* p;
+    const std::uint8_t* end;
+
+    bool byte(std::uint8_t& b) {
+        if (p == end) return false;
+        b = *p++;
+        return true;
+    }
+    bool varint(std::uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            std::uint8_t b;
+            if (!byte(b)) return false;
+            v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+    bool integer(int& v) {
+        std::uint64_t u;
+        if (!varint(u)) return false;
+        v = static_cast<int>(u);
+        return true;
+    }
+    bool signedVarint(std::int64_t& v) {
+        std::uint64_t u;
+        if (!varint(u)) return false;
+        v = static_cast<std::int64_t>(u >> 1) ^ -static_cast<std::int64_t>(u & 1);
+        return true;
+    }
+    bool fixed64(std::uint64_t& v) {
+        if (end - p < 8) return false;
+        v = 0;
+        for (int i = 0; i < 8; ++i) v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+        p += 8;
+        return true;
+    }
+    bool real(double& d) {
+        std::uint64_t bits;
+        if (!fixed64(bits)) return false;
+        std::memcpy(&d, &bits, sizeof d);
+        return true;
+    }
+    bool string(std::string& s) {
+        std::uint64_t n;
+        if (!varint(n) || static_cast<std::uint64_t>(end - p) < n) return false;
+        s.assign(reinterpret_cast<const char*>(p), static_cast<std::size_t>(n));
+        p += n;
+        return true;
+    }
+};
+
+}  // namespace
+
+/* ---------- RunInputs / StateHash ---------- */
+
+void RunInputs::setParam(const std::string& key, std::int64_t value) {
+    for (auto& kv : params) {
+        if (kv.first == key) {
+            kv.second = value;
+            return;
+        }
+    }
+    params.emplace_back(key, value);
+}
+
+std::int64_t RunInputs::param(const std::string& key, std::int64_t fallback) const {
+    for (const auto& kv : params) {
+        if (kv.first == key) return kv.second;
+    }
+    return fallback;
+}
+
+void RunInputs::setRealParam(const std::string& key, double value) {
+    std::int64_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    setParam(key, bits);
+}
+
+double RunInputs::realParam(const std::string& key, double fallback) const {
+    std::int64_t bits;
+    std::memcpy(&bits, &fallback, sizeof bits);
+    bits = param(key, bits);
+    double value;
+    std::memcpy(&value, &bits, sizeof value);
+    return value;
+}
+
+void StateHash::add(std::uint64_t v) {
+    for (int i = 0; i < 8; ++i) {
+        hash_ ^= (v >> (8 * i)) & 0xff;
+        hash_ *= 1099511628211ull;
+    }
+}
+
+void StateHash::add(const std::string& s) {
+    for (unsigned char c : s) {
+        hash_ ^= c;
+        hash_ *= 1099511628211ull;
+    }
+    add(static_cast<std::uint64_t>(s.size()));   // "ab"+"c" and "a"+"bc" hash differently
+}
+
+/* ---------- recording ---------- */
+
+Journal::~Journal() {
+    close();
+}
+
+bool Journal::startRecording(const std::string& path, const RunInputs& inputs) {
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        std::cerr << "[journal] Could not create " << path << std::endl;
+        return false;
+    }
+    buffer_.reserve(2 * FLUSH_BYTES);   // turns are appended by the chambers without reallocating
+    buffer_.insert(buffer_.end(), std::begin(MAGIC), std::end(MAGIC));
+    buffer_.push_back(VERSION);
+
+    for (const auto& kv : inputs.params) {
+        buffer_.push_back('P');
+        putString(buffer_, kv.first);
+        putSigned(buffer_, kv.second);
+    }
+    buffer_.push_back('S');
+    putVarint(buffer_, 0);   // stream 0: defect seed (chamber c uses seed + c)
+    putFixed64(buffer_, inputs.seed);
+
+    for (const TaskArrival& a : inputs.arrivals) {
+        buffer_.push_back('A');
+        putVarint(buffer_, static_cast<std::uint64_t>(a.minute));
+        putString(buffer_, a.id);
+        putString(buffer_, a.recipe);
+        for (int r : a.requiredTime) putVarint(buffer_, static_cast<std::uint64_t>(r));
+        for (double p : a.defectChance) putDouble(buffer_, p);
+        putString(buffer_, a.lot);
+        putVarint(buffer_, a.after.size());
+        for (const std::string& id : a.after) putString(buffer_, id);
+        if (buffer_.size() >= FLUSH_BYTES) flush();
+    }
+    flush();
+
+    inputs_ = inputs;
+    mode_ = Mode::Record;
+    return true;
+}
+
+void Journal::flush() {
+    if (buffer_.empty()) return;
+    file_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+}
+
+void Journal::close() {
+    if (mode_ != Mode::Record) return;
+    {
+        std::lock_guard<std::mutex> lock(sectionMutex_);
+        flush();
+    }
+    file_.close();
+    mode_ = Mode::Off;
+}
+
+/* ---------- replay ---------- */
+
+bool Journal::loadReplay(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "[journal] Could not open " << path << std::endl;
+        return false;
+    }
+    const std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    Reader r{data.data(), data.data() + data.size()};
+
+    const auto malformed = [&](const char* what) {
+        std::cerr << "[journal] " << path << ": " << what << " at byte " << (r.p - data.data()) << std::endl;
+        minutes_.clear();
+        return false;
+    };
+
+    if (data.size() < sizeof(MAGIC) + 1 || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return malformed("not a journal");
+    }
+    r.p += sizeof(MAGIC);
+    std::uint8_t version;
+    if (!r.byte(version) || version != VERSION) return malformed("unsupported version");
+
+    RunInputs inputs;
+    MinuteLog pending;
+    std::uint8_t tag;
+    while (r.byte(tag)) {
+        switch (tag) {
+            case 'P': {
+                std::string key;
+                std::int64_t value;
+                if (!r.string(key) || !r.signedVarint(value)) return malformed("truncated param");
+                inputs.setParam(key, value);
+                break;
+            }
+            case 'S': {
+                std::uint64_t stream;
+                if (!r.varint(stream) || !r.fixed64(inputs.seed)) return malformed("truncated seed");
+                break;
+            }
+            case 'A': {
+                TaskArrival a;
+                if (!r.integer(a.minute) || !r.string(a.id) || !r.string(a.recipe)) return malformed("truncated arrival");
+                for (int& req : a.requiredTime) {
+                    if (!r.integer(req)) return malformed("truncated arrival");
+                }
+                for (double& p : a.defectChance) {
+                    if (!r.real(p)) return malformed("truncated arrival");
+                }
+                std::uint64_t after;
+                if (!r.string(a.lot) || !r.varint(after) || after > static_cast<std::uint64_t>(r.end - r.p)) {
+                    return malformed("truncated arrival");   // every id takes at least its length byte
+                }
+                a.after.resize(static_cast<std::size_t>(after));
+                for (std::string& id : a.after) {
+                    if (!r.string(id)) return malformed("truncated arrival");
+                }
+                inputs.arrivals.push_back(std::move(a));
+                break;
+            }
+            case 'T': {
+                std::uint8_t point;
+                int chamber;
+                if (!r.byte(point) || !r.integer(chamber)) return malformed("truncated turn");
+                pending.turns.push_back(Turn{static_cast<Point>(point), chamber});
+                break;
+            }
+            case 'M': {
+                int t;
+                std::uint64_t n;
+                if (!r.integer(t) || !r.fixed64(pending.checkpoint.stateHash) || !r.varint(n)) {
+                    return malformed("truncated minute");
+                }
+                if (t != static_cast<int>(minutes_.size())) return malformed("minutes out of order");
+                pending.checkpoint.rngDraws.resize(static_cast<std::size_t>(n));
+                for (auto& draws : pending.checkpoint.rngDraws) {
+                    if (!r.varint(draws)) return malformed("truncated minute");
+                }
+                minutes_.push_back(std::move(pending));
+                pending = MinuteLog{};
+                break;
+            }
+            default:
+                return malformed("unknown record");
+        }
+    }
+    // turns after the last 'M' belong to a minute that never finished recording: dropped
+
+    inputs_ = std::move(inputs);
+    minute_ = 0;
+    cursor_ = 0;
+    divergedAt_ = -1;
+    mode_ = Mode::Replay;
+    return true;
+}
+
+void Journal::markDiverged(int t, const char* why) {
+    if (divergedAt_ >= 0) return;
+    divergedAt_ = t;
+    std::cerr << "[replay] Diverged from the journal at minute " << t << ": " << why
+              << " (chambers no longer follow the recorded order)" << std::endl;
+}
+
+/* ---------- turns ---------- */
+
+void Journal::enter(Point point, int chamber) {
+    if (mode_ == Mode::Record) {
+        sectionMutex_.lock();   // released in leave(): the lock order is the recorded order
+        buffer_.push_back('T');
+        buffer_.push_back(static_cast<std::uint8_t>(point));
+        putVarint(buffer_, static_cast<std::uint64_t>(chamber));
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(turnMutex_);
+    const bool inJournal = minute_ < static_cast<int>(minutes_.size());
+    const auto myTurn = [&]() {
+        if (divergedAt_ >= 0 || !inJournal) return true;
+        const auto& turns = minutes_[static_cast<std::size_t>(minute_)].turns;
+        return cursor_ >= turns.size() || turns[cursor_].chamber == chamber;
+    };
+    if (!myTurn()) {
+        const std::size_t slot = static_cast<std::size_t>(chamber);
+        if (slot < waiting_.size()) waiting_[slot] = 1;
+        ++waitingCount_;
+        checkStalled();
+        turnCv_.wait(lock, myTurn);   // no time limit: a slow or traced chamber is not a divergence
+        --waitingCount_;
+        if (slot < waiting_.size()) waiting_[slot] = 0;
+    }
+    if (divergedAt_ < 0) {
+        if (!inJournal) {
+            markDiverged(minute_, "the run is longer than the journal");
+        } else {
+            const auto& turns = minutes_[static_cast<std::size_t>(minute_)].turns;
+            if (cursor_ >= turns.size())            markDiverged(minute_, "more shared sections than recorded");
+            else if (turns[cursor_].point != point) markDiverged(minute_, "a chamber took a different section");
+        }
+    }
+    if (divergedAt_ >= 0) turnCv_.notify_all();   // release everyone still waiting for a turn
+}
+
+void Journal::leave() {
+    if (mode_ == Mode::Record) {
+        sectionMutex_.unlock();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(turnMutex_);
+        if (divergedAt_ < 0) ++cursor_;
+    }
+    turnCv_.notify_all();
+}
+
+void Journal::arrive() {
+    if (mode_ != Mode::Replay) return;
+    std::lock_guard<std::mutex> lock(turnMutex_);
+    --running_;
+    checkStalled();
+}
+
+void Journal::checkStalled() {
+    if (divergedAt_ >= 0 || waitingCount_ == 0 || waitingCount_ < running_) return;
+    if (minute_ >= static_cast<int>(minutes_.size())) return;
+    const auto& turns = minutes_[static_cast<std::size_t>(minute_)].turns;
+    if (cursor_ >= turns.size()) return;
+    const std::size_t next = static_cast<std::size_t>(turns[cursor_].chamber);
+    if (next < waiting_.size() && waiting_[next]) return;   // woken by the last leave(), not yet running
+    markDiverged(minute_, "the recorded chamber never reached its turn");
+    turnCv_.notify_all();   // release everyone still waiting for a turn
+}
+
+/* ---------- minutes ---------- */
+
+void Journal::beginMinute(int t, int chambers) {
+    if (mode_ != Mode::Replay) return;
+    std::lock_guard<std::mutex> lock(turnMutex_);
+    minute_ = t;
+    cursor_ = 0;
+    running_ = chambers;
+    waitingCount_ = 0;
+    waiting_.assign(static_cast<std::size_t>(chambers), 0);
+}
+
+bool Journal::endMinute(int t, const Checkpoint& checkpoint) {
+    if (mode_ == Mode::Record) {
+        std::lock_guard<std::mutex> lock(sectionMutex_);
+        buffer_.push_back('M');
+        putVarint(buffer_, static_cast<std::uint64_t>(t));
+        putFixed64(buffer_, checkpoint.stateHash);
+        putVarint(buffer_, checkpoint.rngDraws.size());
+        for (std::uint64_t draws : checkpoint.rngDraws) putVarint(buffer_, draws);
+        if (buffer_.size() >= FLUSH_BYTES) flush();
+        return true;
+    }
+    if (mode_ != Mode::Replay) return true;
+
+    std::lock_guard<std::mutex> lock(turnMutex_);
+    if (divergedAt_ >= 0) return false;
+    if (t >= static_cast<int>(minutes_.size())) {
+        markDiverged(t, "the run is longer than the journal");
+        return false;
+    }
+    const MinuteLog& recorded = minutes_[static_cast<std::size_t>(t)];
+    if (cursor_ != recorded.turns.size()) {
+        markDiverged(t, "fewer shared sections than recorded");
+    } else if (recorded.checkpoint.rngDraws != checkpoint.rngDraws) {
+        markDiverged(t, "an RNG stream is at a different position");
+    } else if (recorded.checkpoint.stateHash != checkpoint.stateHash) {
+        markDiverged(t, "state hash differs");
+    }
+    return divergedAt_ < 0;
+}
+
+}  // namespace journal
@@ -7,7 +7,7 @@
  *  (macOS/Linux, Clang/GCC — threads need -pthread)
  *    g++ -std=c++17 main.cpp PowerModule.cpp OrbitModel.cpp deposition_model.cpp Logger.cpp -I ../include -pthread -o simulation
  *
- *  (Optional Ion file present but NOT used in this deposition-only main)
+ *  (ion implantation runs behind deposition: add ion_implantation_model.cpp)
  *    g++ -std=c++17 main.cpp PowerModule.cpp OrbitModel.cpp deposition_model.cpp Logger.cpp ion_implantation_model.cpp -I ../include -pthread -o simulation
  *
  * Run command:
@@ -22,10 +22,27 @@
 // #include "OrbitModel.hpp"
 #include "PowerBus.hpp"           
 #include "DepositionModule.hpp"
-// #include "IonImplantationModule.hpp"
-// #include "CrystalGrowthModule.hpp"
+#include "IonImplantationModule.hpp"
+#include "CrystalGrowthModule.hpp"
 #include "Logger.hpp"
 #include "Task.hpp"
+#include "WakeTracer.hpp"
+#include "WaferMap.hpp"
+#include "StageQueue.hpp"
+#include "TickBarrier.hpp"
+#include "Metrics.hpp"
+#include "Introspection.hpp"
+#include "YieldAnalytics.hpp"    // per-recipe yield / energy / cycle-time summary
+#include "EnergyLedger.hpp"      // solar vs battery attribution per wafer and orbit
+#include "QueueingAnalyzer.hpp"  // per-stage queueing figures, bottleneck
+#include "TaskGraph.hpp"         // lots with precedence, critical-path dispatch
+#include "Planner.hpp"           // SPACEFORGE_PLAN forward plan, repaired as the run drifts
+#include "Journal.hpp"           // SPACEFORGE_JOURNAL / SPACEFORGE_REPLAY record and replay
+#include "FaultInjector.hpp"     // SPACEFORGE_FAULTS power and equipment failures
+#include "TickLatency.hpp"       // per-tick latency histogram and slowest ticks
+#include "ThreadUsage.hpp"       // per-thread CPU / blocked time for the utilisation table
+#include "AllocTracker.hpp"       // SF_ALLOC_SCOPE / steady-state check (SPACEFORGE_TRACK_ALLOCS)
+#include "Trace.hpp"             // SF_TRACE_* (no-ops unless built with SPACEFORGE_ENABLE_TRACE)
 
 // needed imports 
 #include <iostream>
@@ -33,14 +50,22 @@
 #include <vector>   // a vector is a dynamically sized array with O(1)
 #include <sstream>
 #include <cstdlib>  // For rand(), srand()
+#include <cstring>  // strchr
+#include <cmath>    // llround
 #include <ctime>    // for time()
 #include <thread>   // for threads - each module is a unique thread 
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
 #include <chrono>
+#include <memory>
+#include <algorithm>
+#include <iomanip>
 
 const int SIM_DURATION = 1440;  // 24 hours in minutes
+const int DEPO_CALIBRATION_MINUTES = 0;   // per carrier, per chamber (at ChamberConfig::calibrationPower); SPACEFORGE_CHAMBER_TIMING
+const int DEPO_COOLDOWN_MINUTES    = 0;   // after each carrier leaves a chamber; 0 and 0 ⇒ the original single-chamber timeline
+const int PLAN_HORIZON = 7 * 1440;        // minutes the SPACEFORGE_PLAN calendar looks ahead
 int DEFECT_COUNT = 0;
 
 // Function to load tasks from file
@@ -51,7 +76,25 @@ std::vector<Task*> loadTasksFromFile(const std::string& filename) {
 
     while (std::getline(infile, line)) {
         Task* task = new Task();
-        task->id = line;                          // e.g. T_1, T_2 ...
+        std::istringstream fields(line);          // "<id> [recipe] [lot=<name>] [after=<id>,<id>...]"
+        fields >> task->id;                       // e.g. T_1, T_2 ...
+        if (task->id.empty()) {                   // blank line
+            delete task;
+            continue;
+        }
+        std::string field;
+        while (fields >> field) {
+            if (field.rfind("lot=", 0) == 0) {
+                task->lot = field.substr(4);
+            } else if (field.rfind("after=", 0) == 0) {
+                std::istringstream ids(field.substr(6));
+                for (std::string id; std::getline(ids, id, ',');) {
+                    if (!id.empty()) task->after.push_back(id);
+                }
+            } else {
+                task->recipe = field;             // stays "default" if the line has no recipe
+            }
+        }
 
         // ---------- default phase durations ----------
         task->phase[0].requiredTime = 60;   // Deposition
@@ -75,6 +118,64 @@ std::vector<Task*> loadTasksFromFile(const std::string& filename) {
     return tasksVector;
 }
 
+// wafer arrivals as the journal stores them (every wafer arrives at readyMinute, 0 for a tasks file)
+journal::TaskArrival arrivalOf(const Task& task) {
+    journal::TaskArrival arrival;
+    arrival.minute = task.readyMinute;
+    arrival.id = task.id;
+    arrival.recipe = task.recipe;
+    arrival.lot = task.lot;
+    arrival.after = task.after;
+    for (int i = 0; i < 3; ++i) {
+        arrival.requiredTime[i] = task.phase[i].requiredTime;
+        arrival.defectChance[i] = task.phase[i].defectChance;
+    }
+    return arrival;
+}
+
+Task* taskFromArrival(const journal::TaskArrival& arrival) {
+    Task* task = new Task();
+    task->id = arrival.id;
+    task->recipe = arrival.recipe;
+    task->lot = arrival.lot;
+    task->after = arrival.after;
+    task->readyMinute = arrival.minute;
+    task->releasedMinute = arrival.minute;
+    for (int i = 0; i < 3; ++i) {
+        task->phase[i].requiredTime = arrival.requiredTime[i];
+        task->phase[i].defectChance = arrival.defectChance[i];
+    }
+    return task;
+}
+
+// fault specs as the journal stores them: "faults" = count, then "fault<i>.<field>" (mtbf / repair bit-exact)
+void recordFaults(journal::RunInputs& inputs, const std::vector<faults::FaultSpec>& specs) {
+    inputs.setParam("faults", static_cast<std::int64_t>(specs.size()));
+    for (std::size_t i = 0; i < specs.size(); ++i) {
+        const std::string key = "fault" + std::to_string(i) + ".";
+        inputs.setParam(key + "kind",   static_cast<std::int64_t>(specs[i].kind));
+        inputs.setParam(key + "target", specs[i].target);
+        inputs.setParam(key + "at",     specs[i].at);
+        inputs.setRealParam(key + "mtbf",   specs[i].mtbf);
+        inputs.setRealParam(key + "repair", specs[i].repair);
+        inputs.setParam(key + "size",   specs[i].size);
+    }
+}
+
+std::vector<faults::FaultSpec> faultsFromInputs(const journal::RunInputs& inputs) {
+    std::vector<faults::FaultSpec> specs(static_cast<std::size_t>(inputs.param("faults", 0)));
+    for (std::size_t i = 0; i < specs.size(); ++i) {
+        const std::string key = "fault" + std::to_string(i) + ".";
+        specs[i].kind   = static_cast<faults::FaultKind>(inputs.param(key + "kind", 0));
+        specs[i].target = static_cast<int>(inputs.param(key + "target", -1));
+        specs[i].at     = static_cast<int>(inputs.param(key + "at", -1));
+        specs[i].mtbf   = inputs.realParam(key + "mtbf", 0.0);
+        specs[i].repair = inputs.realParam(key + "repair", 0.0);
+        specs[i].size   = static_cast<int>(inputs.param(key + "size", 0));
+    }
+    return specs;
+}
+
 // simply log to a csv file 
 std::ofstream openCSVLogFile(const std::string& filename) {
     std::ofstream file(filename, std::ios::out);
@@ -98,96 +199,705 @@ void logTaskVector(const std::vector<Task*>& tasks, std::ostream& out = std::cou
                 << " | Interrupted: "<< (task->phase[i].wasInterrupted ? "Yes" : "No")
                 << " | DefChance: " << task->phase[i].defectChance
                 << " | Defective: " << (task->phase[i].defective     ? "Yes" : "No")
+                << " | Thickness(nm): " << task->phase[i].meanThickness
+                << " | NonUniformity: " << task->phase[i].nonUniformity
+                << " | ContaminatedCells: " << task->phase[i].contaminatedCells
                 << '\n';
         }
         out << "-------------------------\n";
     }
 }
 
-int main() {
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));  // randomise defect RNG
-
+int main(int argc, char** argv) {
+    SF_ALLOC_SCOPE(alloc::Tag::Main);
     /**     INITIALISATIONS:
      * PowerModule - 250 Wh battery, 300 W solar gen, 0 W eclipse
      *             - can only draw 300 W per minute from the battery at once
      * Wafer Tasks into tasks vector
      * Task Index and current time to 0
      * openCSVLogFile - open the output file for logs
-     * DepositionModuleInstance
-     *  - for (Task& task : tasks) enqueue all tasks into the deposition module
+     * Deposition chambers (argv[1], default 1)
+     *  - all chambers pull from one shared StageQueue and share the PowerModule
+     * Carrier size (argv[3], default 1) and max batch wait in minutes (argv[4], default 0)
+     *  - carrier > 1 runs wafers in batches: throughput up, per-wafer latency up
      * LoggerInstance
      * phaseName - holds the current phase and used for logging purposes 
+     *
+     * Usage: ./simulation [depositionChambers] [tasksFile] [carrierSize] [maxBatchWait]
+     *
+     * SPACEFORGE_NO_ALLOC=report|abort checks that the tick loop stops allocating after the
+     * first minute (needs a -DSPACEFORGE_TRACK_ALLOCS=ON build; see AllocTracker.hpp)
+     * SPACEFORGE_INTROSPECT_SOCKET=<path> starts a query server on that Unix socket
+     * (see Introspection.hpp), e.g.  printf 'all\n' | nc -U <path>
+     * SPACEFORGE_JOURNAL=<file> records the run's inputs and chamber ordering (Journal.hpp);
+     * SPACEFORGE_REPLAY=<file> re-runs it bit-exactly (argv and the tasks file are ignored),
+     * unpaced up to SPACEFORGE_REPLAY_TO=<minute> (default: the whole run), where it prints the state
+     * SPACEFORGE_BUFFER=<capacity>[,<maxDwell>] bounds the deposition → ion implantation buffer:
+     * a full buffer blocks the chambers, wafers waiting longer than maxDwell minutes are scrapped
+     * SPACEFORGE_PLAN=repair|replan keeps a week-long deposition plan (Planner.hpp) next to the run:
+     * repaired locally after every minute that drifts from it, or replanned from scratch (baseline)
+     * SPACEFORGE_CRYSTAL_PAUSE=through|eclipse: crystal growth grows through the eclipse on battery
+     * (default), or pauses at a safe point for it and holds the melt (CrystalGrowthModule.hpp)
+     * SPACEFORGE_CRYSTAL_FIRST=1 lets the furnace draw before the chambers every minute, so its hold is
+     * never starved; by default it takes what deposition left, and the deposition timeline is the baseline's
+     * SPACEFORGE_CHAMBER_TIMING=<calibration>[,<cooldown>] opts the deposition chambers into minutes of
+     * calibration before every carrier and cooldown after it (default 0,0: the baseline timeline)
+     * SPACEFORGE_FAULTS=<file> injects scheduled and stochastic failures (FaultInjector.hpp), one per line:
+     * e.g. "kind=chamber target=0 at=300 repair=45" or "kind=panel mtbf=2000 repair=0"; journaled like argv
      */
+    journal::Journal runJournal;
+    const char* replayPath = std::getenv("SPACEFORGE_REPLAY");
+    if (replayPath && !runJournal.loadReplay(replayPath)) return 1;
+    const bool replaying = runJournal.mode() == journal::Journal::Mode::Replay;
+    const char* journalPath = replaying ? nullptr : std::getenv("SPACEFORGE_JOURNAL");
+
+    journal::RunInputs runInputs;
+    std::vector<Task*> tasks;
+    if (replaying) {
+        runInputs = runJournal.inputs();
+        for (const journal::TaskArrival& arrival : runInputs.arrivals) tasks.push_back(taskFromArrival(arrival));
+    } else {
+        runInputs.setParam("chambers",       (argc > 1) ? std::max(1, std::atoi(argv[1])) : 1);
+        runInputs.setParam("carrier_size",   (argc > 3) ? std::max(1, std::atoi(argv[3])) : 1);
+        runInputs.setParam("max_batch_wait", (argc > 4) ? std::max(0, std::atoi(argv[4])) : 0);
+        if (const char* buffer = std::getenv("SPACEFORGE_BUFFER")) {
+            const char* comma = std::strchr(buffer, ',');
+            runInputs.setParam("buffer_capacity",  std::max(0, std::atoi(buffer)));
+            runInputs.setParam("buffer_max_dwell", comma ? std::max(0, std::atoi(comma + 1)) : 0);
+        }
+        if (const char* timing = std::getenv("SPACEFORGE_CHAMBER_TIMING")) {
+            const char* comma = std::strchr(timing, ',');
+            runInputs.setParam("depo_calibration", std::max(0, std::atoi(timing)));
+            runInputs.setParam("depo_cooldown",    comma ? std::max(0, std::atoi(comma + 1)) : 0);
+        }
+        const char* crystalPause = std::getenv("SPACEFORGE_CRYSTAL_PAUSE");
+        runInputs.setParam("crystal_pause_eclipse", (crystalPause && std::string(crystalPause) == "eclipse") ? 1 : 0);
+        const char* crystalFirst = std::getenv("SPACEFORGE_CRYSTAL_FIRST");
+        runInputs.setParam("crystal_first", (crystalFirst && std::string(crystalFirst) == "1") ? 1 : 0);
+        if (const char* faultsPath = std::getenv("SPACEFORGE_FAULTS")) {
+            std::vector<faults::FaultSpec> specs;
+            std::string faultError;
+            if (!faults::loadSpecs(faultsPath, specs, faultError)) {
+                std::cerr << "[faults] " << faultError << std::endl;
+                return 1;
+            }
+            recordFaults(runInputs, specs);
+        }
+        runInputs.seed = static_cast<std::uint64_t>(std::time(nullptr));
+        tasks = loadTasksFromFile((argc > 2) ? argv[2] : "../../scheduler_dl/tasks1.txt");
+    }
+    const int depoChambers = static_cast<int>(runInputs.param("chambers", 1));
+    const int carrierSize  = static_cast<int>(runInputs.param("carrier_size", 1));
+    const int maxBatchWait = static_cast<int>(runInputs.param("max_batch_wait", 0));
+    const int depoCalibration = static_cast<int>(runInputs.param("depo_calibration", DEPO_CALIBRATION_MINUTES));
+    const int depoCooldown    = static_cast<int>(runInputs.param("depo_cooldown", DEPO_COOLDOWN_MINUTES));
+    BufferConfig ionBufferConfig;   // WIP between deposition and ion implantation
+    ionBufferConfig.capacity        = static_cast<std::size_t>(runInputs.param("buffer_capacity", 0));
+    ionBufferConfig.maxDwellMinutes = static_cast<int>(runInputs.param("buffer_max_dwell", 0));
+
+    if (journalPath) {
+        for (const Task* task : tasks) runInputs.arrivals.push_back(arrivalOf(*task));
+        runJournal.startRecording(journalPath, runInputs);   // a failure is reported; the run goes on unrecorded
+        runInputs.arrivals.clear();
+        runInputs.arrivals.shrink_to_fit();
+    }
+
+    // lots and precedence from the tasks file; wafers wait in the graph until their predecessors pass
+    lots::TaskGraph lotGraph;
+    std::string graphError;
+    if (!lotGraph.build(tasks, graphError)) {
+        std::cerr << "[tasks] " << graphError << std::endl;
+        for (Task* task : tasks) delete task;
+        return 1;
+    }
+
     PowerModule Power(250000, 300, 0);  // 250 000 "W·min" (≈ 250 Wh); bus enforces 300 W/min draw cap
 
     // std::ofstream outputFile = openCSVLogFile("logV1.csv"); - open the log file
     Logger LoggerInstance("../../scheduler_dl/data/logV1.csv");                          
 
-    DepositionModule DepositionModuleInstance;
-    // IonImplantationModule IonImplantationModuleInstance;  // removed for deposition-only run
+    // Wafer maps: contamination comes from one tracer run of the station's shield
+    // (wafermap::shieldScene, an mc_output4 cupola); maps are pooled, one per wafer on a stage.
+    const FluxMap depositionFlux = []() {
+        SF_ALLOC_SCOPE(alloc::Tag::Tracer);
+        return FluxMap::fromShield();
+    }();
+    WaferMapArena waferMapArena(depoChambers * carrierSize);
+
+    // N deposition chambers behind one shared queue (central dispatcher: idle chamber pulls next wafer)
+    StageQueue depositionQueue;
+    StageQueue ionBuffer(ionBufferConfig);   // finished deposition wafers wait here for ion implantation
+    StageQueue crystalBuffer;                // implanted wafers wait here for crystal growth
+    if (lotGraph.hasEdges()) depositionQueue.setDispatch(StageQueue::Dispatch::CriticalPath);
+    ChamberConfig depoConfig;
+    depoConfig.calibrationMinutes = depoCalibration;
+    depoConfig.cooldownMinutes    = depoCooldown;
+    depoConfig.carrierSize        = carrierSize;
+    depoConfig.maxBatchWaitMinutes = maxBatchWait;
 
-    // load & enqueue pointers to the tasks
-    std::vector<Task*> tasks = loadTasksFromFile("../../scheduler_dl/tasks1.txt");
-    for (Task* task : tasks) {
-        DepositionModuleInstance.enqueue(task);
-        // IonImplantationModuleInstance.enqueueIonImplantation(task); // not used in deposition-only
+    const std::uint64_t seed = runInputs.seed;
+    analytics::YieldAnalytics lineYield;   // written by main as wafers leave the line
+    energy::EnergyLedger lineEnergy;       // and their per-wafer battery energy; the stages book the draws
+    std::vector<energy::EnergyLedger> chamberEnergy;   // one writer each, roll-ups reserved for the run
+    chamberEnergy.reserve(static_cast<std::size_t>(depoChambers));
+    for (int c = 0; c < depoChambers; ++c) chamberEnergy.emplace_back(SIM_DURATION);
+    queueing::QueueingAnalyzer pipeline;
+    const int depositionStage = pipeline.addStage("Deposition", depoChambers);
+    const int ionStage = pipeline.addStage("Ion Implantation", 1);
+    const int crystalStage = pipeline.addStage("Crystal Growth", 1);
+    std::vector<queueing::StageObservation> chamberQueueing(static_cast<std::size_t>(depoChambers));
+    std::vector<std::vector<Task*>> chamberFinished(static_cast<std::size_t>(depoChambers));
+    for (auto& finished : chamberFinished) finished.reserve(tasks.size());
+    std::vector<Task*> lineExits;  // wafers that left the line this minute: grown, or scrapped on the way
+    lineExits.reserve(tasks.size());
+    std::vector<Task*> released;   // successors freed by this minute's line exits
+    released.reserve(tasks.size());
+    std::vector<std::unique_ptr<DepositionModule>> depositionChambers;
+    for (int c = 0; c < depoChambers; ++c) {
+        depositionChambers.push_back(std::make_unique<DepositionModule>(c, &depositionQueue, depoConfig));
+        depositionChambers.back()->seedDefects(seed + c);  // randomise defect RNG, one stream per chamber
+        depositionChambers.back()->attachWaferMaps(&waferMapArena, &depositionFlux);
+        depositionChambers.back()->attachJournal(&runJournal);   // no-op unless recording / replaying
+        depositionChambers.back()->attachEnergyLedger(&chamberEnergy[static_cast<std::size_t>(c)]);
+        depositionChambers.back()->attachQueueing(&chamberQueueing[static_cast<std::size_t>(c)]);
+        depositionChambers.back()->attachOutputBuffer(&ionBuffer);
+        depositionChambers.back()->attachCompletions(&chamberFinished[static_cast<std::size_t>(c)]);
     }
+    // one implanter and one furnace behind their buffers, driven by main between the chamber ticks
+    energy::EnergyLedger ionEnergy(SIM_DURATION);
+    queueing::StageObservation ionQueueing;
+    IonImplantationModule ionImplanter(&ionBuffer);
+    ionImplanter.seed(seed + static_cast<std::uint64_t>(depoChambers));   // next stream after the chambers'
+    ionImplanter.attachEnergyLedger(&ionEnergy);
+    ionImplanter.attachQueueing(&ionQueueing);
+    ionImplanter.attachOutputBuffer(&crystalBuffer);
+    ionImplanter.attachScrapped(&lineExits);
+    GrowthConfig growthConfig;
+    growthConfig.policy = runInputs.param("crystal_pause_eclipse", 0) ? PausePolicy::Eclipse : PausePolicy::RunThrough;
+    const bool crystalFirst = runInputs.param("crystal_first", 0) != 0;   // furnace draws before the chambers
+    energy::EnergyLedger crystalEnergy(SIM_DURATION);
+    queueing::StageObservation crystalQueueing;
+    CrystalGrowthModule crystalFurnace(&crystalBuffer, growthConfig);
+    crystalFurnace.seed(seed + static_cast<std::uint64_t>(depoChambers) + 1);
+    crystalFurnace.attachEnergyLedger(&crystalEnergy);
+    crystalFurnace.attachQueueing(&crystalQueueing);
+    crystalFurnace.attachCompletions(&lineExits);
+
+    // failures and repairs are applied by main before the minute's power update; idle minutes cost one compare
+    faults::FaultInjector faultInjector(faultsFromInputs(runInputs), seed + static_cast<std::uint64_t>(depoChambers) + 2);
+    faultInjector.attachPower(&Power);
+    for (const auto& chamber : depositionChambers) faultInjector.attachChamber(chamber.get());
+    faultInjector.attachImplanter(&ionImplanter);
+    faultInjector.attachFurnace(&crystalFurnace);
+
+    // enqueue pointers to the tasks that wait for nobody; the rest are released by lotGraph
+    for (Task* task : lotGraph.initiallyReady()) {
+        depositionQueue.push(task);
+        pipeline.observation(depositionStage).arrive();
+    }
+
+    // advisory forward plan; it does not steer dispatch, so it stays out of the journal
+    std::unique_ptr<plan::Planner> planner;
+    const char* planMode = std::getenv("SPACEFORGE_PLAN");
+    if (planMode) {
+        plan::Planner::Config planConfig;
+        planConfig.setupMinutes    = depoCalibration;
+        planConfig.cooldownMinutes = depoCooldown;
+        planConfig.watts           = DepositionModule::REQUIRED_POWER;
+        planConfig.alwaysReplan    = std::string(planMode) == "replan";
+        planner = std::make_unique<plan::Planner>(depoChambers, plan::orbitPowerProfile(PLAN_HORIZON), planConfig);
+        planner->build(tasks);
+    }
+    int lastUnload = -1;
 
     // concurrency tools 
-    std::mutex depo_mutex, power_mutex;                  // mutexes for deposition and powerBus
-    std::condition_variable depo_cv;                     // tells a thread to "Wake up" 
-    std::atomic<bool> keep_running(true);
+    ProfiledMutex power_mutex("power_mutex");            // mutex for the powerBus
     std::atomic<int>  simMinute(0);                      // since simMinute is atomic it cannot be interrupted by other threads
     std::atomic<int>  orbitState(0);                     // 0 = sunlight, 1 = eclipse
 
-    // --- NEW: minute tick counter to avoid spurious wakeups repeating work ---
-    std::atomic<int> tick(0);                            // incremented by main each minute
+    // one tick per minute; chambers report back so main never updates the power bus while a chamber is still drawing
+    TickBarrier tickBarrier(depoChambers);
 
-    // operate in the background and wait for main thread to call notify_one() to "wake up"
-    std::thread deposition_thread([&]() {
-        int seen = 0;  // last processed tick value (thread-local)
-        while (keep_running) {
-            std::unique_lock<std::mutex> lock(depo_mutex);
+    // operate in the background and wait for main thread to publish a tick to "wake up"
+    std::vector<std::thread> deposition_threads;
+    std::vector<std::uint64_t> chamberUpdateNs(depositionChambers.size(), 0);   // slot per chamber, read by main after waitAll
+    for (std::size_t c = 0; c < depositionChambers.size(); ++c) {
+        DepositionModule* module = depositionChambers[c].get();
+        deposition_threads.emplace_back([&, module, c]() {
+            SF_TRACE_THREAD_NAME(module->name());
+            alloc::setTickThread(true);
+            usage::beginThread(module->name());
+            int seen = 0;  // last processed tick value (thread-local)
+            while (tickBarrier.waitForTick(seen)) {
+                // Do one minute of work for this chamber.
+                const auto updateStart = std::chrono::steady_clock::now();
+                module->update(
+                    simMinute.load(std::memory_order_relaxed),
+                    Power,
+                    LoggerInstance,
+                    &power_mutex,
+                    &orbitState
+                );
+                chamberUpdateNs[c] = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - updateStart).count());
+                runJournal.arrive();   // replay: no more turns from this chamber this minute
+                tickBarrier.arrive();
+            }
+            usage::endThread();
+        });
+    }
 
-            // Wait until either shutdown requested or a NEW tick is available.
-            depo_cv.wait(lock, [&]() {
-                return !keep_running || tick.load(std::memory_order_acquire) > seen;
-            });
+    // run-level gauges, refreshed once per minute after the chambers are done
+    metrics::Counter& minutesSimulated = metrics::registry().counter("sim.minutes");
+    metrics::Gauge& queueDepth   = metrics::registry().gauge("deposition.queue_depth");
+    metrics::Gauge& batteryLevel = metrics::registry().gauge("power.battery_level");
+    metrics::Gauge& ionBufferDepth = metrics::registry().gauge("buffer.ion.occupancy");
+    const metrics::Counter& rowsLogged = metrics::registry().counter("logger.rows");
 
-            if (!keep_running) break;
+    // worst-case tick time for the real-time mode; the 10 ms pacing sleep is not part of a tick
+    TickRecorder tickLatency;
 
-            // Advance our watermark so one notify → at most one update call.
-            seen = tick.load(std::memory_order_relaxed);
+    // optional live introspection: reads only the snapshot published after each minute
+    SnapshotPublisher runSnapshots;
+    std::unique_ptr<IntrospectionServer> introspection;
+    if (const char* socketPath = std::getenv("SPACEFORGE_INTROSPECT_SOCKET")) {
+        introspection = std::make_unique<IntrospectionServer>(socketPath, runSnapshots);
+        if (!introspection->start()) introspection.reset();
+    }
 
-            // Do one minute of work for the deposition module.
-            DepositionModuleInstance.update(
-                simMinute.load(std::memory_order_relaxed),
-                Power,
-                LoggerInstance,
-                &power_mutex,
-                &orbitState
-            );
-        }
-    });
+    // steady-state allocation check: the first minute loads carriers and warms up buffers
+    const char* noAllocMode = std::getenv("SPACEFORGE_NO_ALLOC");
+    const alloc::Policy noAllocPolicy = (noAllocMode && std::string(noAllocMode) == "abort")
+                                        ? alloc::Policy::Abort : alloc::Policy::Report;
+
+    // journal checkpoint, reused every minute; replay runs unpaced up to fastForwardTo (at most the last minute)
+    journal::Checkpoint checkpoint;
+    checkpoint.rngDraws.resize(depositionChambers.size());
+    const char* replayTo = std::getenv("SPACEFORGE_REPLAY_TO");
+    const int fastForwardTo = !replaying ? 0 : std::min(SIM_DURATION - 1, replayTo ? std::max(0, std::atoi(replayTo)) : SIM_DURATION);
+
+    std::uint64_t ionPushed = 0;       // buffer pushes seen so far: the ion stage's arrivals
+    std::uint64_t crystalPushed = 0;   // and crystal growth's
 
     // main while loop
+    SF_TRACE_THREAD_NAME("main");
+    alloc::setTickThread(true);
+    usage::beginThread("main");
     for (int t = 0; t < SIM_DURATION; t++) {
+        tickLatency.beginTick(t);
+        const std::uint64_t rowsBefore = rowsLogged.value();
         simMinute.store(t, std::memory_order_relaxed);                   // publish the current simulated minute
         orbitState.store((t % 90 < 45) ? 0 : 1, std::memory_order_relaxed); // 0 = sunlight, 1 = eclipse
 
-        Power.update(t, (orbitState.load(std::memory_order_relaxed) == 0 ? "sunlight" : "eclipse"));
+        faultInjector.advance(t);   // the chambers are parked at the barrier: no lock needed
+        {
+            std::lock_guard<ProfiledMutex> powerLock(power_mutex);
+            SF_TRACE_SCOPE("power.update", "lock");
+            SF_ALLOC_SCOPE(alloc::Tag::Power);
+            Power.update(t, (orbitState.load(std::memory_order_relaxed) == 0 ? "sunlight" : "eclipse"));
+        }
+        tickLatency.mark("power");
+
+        // deposition has first claim on the bus unless the furnace was given it (SPACEFORGE_CRYSTAL_FIRST)
+        if (crystalFirst) {
+            crystalFurnace.update(t, Power, LoggerInstance, &power_mutex, &orbitState);
+            tickLatency.mark("crystal");
+        }
+
+        // Publish a NEW tick, wake every chamber exactly once and wait until all finished this minute
+        runJournal.beginMinute(t, depoChambers);
+        tickBarrier.publish();
+        tickBarrier.waitAll();
+        tickLatency.mark("chambers");
+
+        // the furnace takes what the chambers left, before ion implantation
+        if (!crystalFirst) {
+            crystalFurnace.update(t, Power, LoggerInstance, &power_mutex, &orbitState);
+            tickLatency.mark("crystal");
+        }
+
+        for (const auto& finished : chamberFinished) {
+            if (!finished.empty()) lastUnload = t;
+        }
+
+        // ion implantation runs on what the chambers left of this minute's power
+        const BufferStats ionBuffered = ionBuffer.stats();
+        pipeline.observation(ionStage).arrivals += ionBuffered.pushed - ionPushed;
+        ionPushed = ionBuffered.pushed;
+        for (std::size_t s = ionBuffer.expire(t, &lineExits); s > 0; --s) {
+            ionQueueing.censorWait(ionBufferConfig.maxDwellMinutes + 1);   // scrapped in the buffer: it never starts
+        }
+        ionImplanter.update(t, Power, LoggerInstance, &power_mutex, &orbitState);
+        tickLatency.mark("ion");
+        ionBuffer.sample();
+        const std::uint64_t crystalBuffered = crystalBuffer.stats().pushed;   // implanted this minute: next minute's wafers
+        pipeline.observation(crystalStage).arrivals += crystalBuffered - crystalPushed;
+        crystalPushed = crystalBuffered;
+        ionBufferDepth.set(static_cast<std::int64_t>(ionBuffer.size()));
+
+        // wafers leaving the line settle their yield and release the next wafers of their lots
+        // (and refresh the slack of the rest); released wafers start from the next minute
+        released.clear();
+        for (Task* wafer : lineExits) {
+            lineYield.record(*wafer, t);
+            lineEnergy.closeWafer(*wafer);
+            lotGraph.complete(wafer, t, released);
+        }
+        lineExits.clear();
+        for (Task* wafer : released) {
+            depositionQueue.push(wafer);
+            pipeline.observation(depositionStage).arrive();
+        }
+
+        // hold the plan against what happened this minute, then repair it from the next one
+        if (planner) {
+            alloc::setTickThread(false);   // the plan's windows and index are allowed to allocate
+            for (const auto& chamber : depositionChambers) {
+                if (chamber->carrierLoad() == 0 || chamber->loadedAt() != t) continue;
+                for (std::size_t i = 0; i < chamber->carrierLoad(); ++i) planner->started(chamber->carrierTask(i), chamber->chamber());
+            }
+            for (auto& finished : chamberFinished) {
+                for (Task* wafer : finished) planner->finished(wafer, t);
+            }
+            for (const auto& chamber : depositionChambers) {
+                int unload = t + 1, until = t + 1;
+                if (chamber->carrierLoad() > 0) {
+                    unload = t + 1 + (chamber->isBlocked() ? 0 : chamber->minutesToUnload());
+                    until = unload + depoCooldown;
+                } else {
+                    until = t + 1 + chamber->cooldownLeft();
+                }
+                planner->pin(chamber->chamber(), t + 1, unload, until, chamber->carrierDraw());
+            }
+            planner->repair(t + 1);
+            alloc::setTickThread(true);
+            tickLatency.mark("plan");
+        }
+        for (auto& finished : chamberFinished) finished.clear();
+
+        if (runJournal.mode() != journal::Journal::Mode::Off) {
+            journal::StateHash state;
+            state.add(Power.getBatteryLevel());
+            state.add(Power.getAvailablePower());
+            state.add(static_cast<std::uint64_t>(faultInjector.active()));
+            state.add(LoggerInstance.getThroughput());
+            state.add(static_cast<std::uint64_t>(depositionQueue.size()));
+            state.add(static_cast<std::uint64_t>(ionBuffer.size()));
+            state.add(ionImplanter.implantStats().completed);
+            state.add(ionImplanter.implantStats().scrapped);
+            if (const Task* wafer = ionImplanter.currentTask()) {
+                state.add(wafer->id);
+                state.add(wafer->phase[1].elapsedTime);
+                state.add(wafer->phase[1].retries);
+            }
+            state.add(crystalFurnace.growthStats().completed);
+            if (const Task* wafer = crystalFurnace.currentTask()) {
+                state.add(wafer->id);
+                state.add(wafer->phase[2].elapsedTime);
+                state.add(wafer->phase[2].pausedMinutes);
+                state.add(wafer->phase[2].defective);
+            }
+            for (std::size_t c = 0; c < depositionChambers.size(); ++c) {
+                const DepositionModule& chamber = *depositionChambers[c];
+                const ChamberStats& st = chamber.chamberStats();
+                state.add(st.completed);
+                state.add(st.busyMinutes);
+                state.add(st.powerDeniedMinutes);
+                state.add(static_cast<std::uint64_t>(chamber.carrierLoad()));
+                if (const Task* wafer = chamber.currentTask()) {
+                    state.add(wafer->id);
+                    state.add(wafer->phase[0].elapsedTime);
+                    state.add(wafer->phase[0].energyUsed);
+                    state.add(wafer->phase[0].defective);
+                }
+                checkpoint.rngDraws[c] = chamber.defectDraws();
+            }
+            checkpoint.stateHash = state.value();
+            runJournal.endMinute(t, checkpoint);
+            tickLatency.mark("journal");
+        }
+
+        minutesSimulated.add();
+        queueDepth.set(static_cast<std::int64_t>(depositionQueue.size()));
+        std::size_t onCarriers = 0;
+        for (const auto& chamber : depositionChambers) onCarriers += chamber->carrierLoad();
+        pipeline.observation(depositionStage).sample(depositionQueue.size(), onCarriers);
+        pipeline.observation(ionStage).sample(ionBuffer.size(), ionImplanter.currentTask() ? 1 : 0);
+        pipeline.observation(crystalStage).sample(crystalBuffer.size(), crystalFurnace.currentTask() ? 1 : 0);
+        batteryLevel.set(Power.getBatteryLevel());
+
+        // chambers are parked at the barrier, so their state can be copied without locks
+        if (introspection) {
+            alloc::setTickThread(false);   // the snapshot is a diagnostic copy, allowed to allocate
+            auto snap = std::make_shared<RunSnapshot>();
+            snap->minute = t;
+            snap->simDuration = SIM_DURATION;
+            snap->orbit = orbitState.load(std::memory_order_relaxed) == 0 ? "sunlight" : "eclipse";
+            snap->batteryLevel = Power.getBatteryLevel();
+            snap->batterySOC = Power.getSOC();
+            snap->powerAvailable = Power.getAvailablePower();
+            snap->throughput = LoggerInstance.getThroughput();
+            snap->wafersTotal = static_cast<int>(tasks.size());
+            snap->depositionQueued = depositionQueue.size();
+            for (const Task* queued : depositionQueue.front(RunSnapshot::QUEUE_PREVIEW)) {
+                snap->depositionQueue.push_back(queued->id);
+            }
+            for (const auto& chamber : depositionChambers) {
+                RunSnapshot::Chamber view;
+                view.name = chamber->name();
+                view.state = chamber->isBlocked()     ? "blocked"
+                           : chamber->isCoolingDown() ? "cooling"
+                           : chamber->isCalibrating() ? "calibrating"
+                           : chamber->currentTask()   ? "running" : "idle";
+                for (const Task* wafer : chamber->carrierTasks()) view.carrier.push_back(wafer->id);
+                view.completed = chamber->chamberStats().completed;
+                view.powerDeniedMinutes = chamber->chamberStats().powerDeniedMinutes;
+                snap->chambers.push_back(std::move(view));
+            }
+            runSnapshots.publish(std::move(snap));
+            alloc::setTickThread(true);
+        }
+
+        // context for the slowest ticks: which chamber held the barrier, and how much was logged
+        const auto slowestChamber = std::max_element(chamberUpdateNs.begin(), chamberUpdateNs.end());
+        tickLatency.note("slowest.chamber", slowestChamber - chamberUpdateNs.begin());
+        tickLatency.note("slowest.chamber_us", static_cast<long long>(*slowestChamber / 1000));
+        tickLatency.note("log.rows", static_cast<long long>(rowsLogged.value() - rowsBefore));
+        tickLatency.mark("publish");   // gauges + introspection snapshot
+        tickLatency.endTick();
+
+        // minute 0 loaded the carriers and sized every buffer; from here on the loop must not allocate
+        if (t == 0 && noAllocMode) alloc::enterSteadyState(noAllocPolicy);
+
+        if (replaying && t == fastForwardTo) {
+            std::cout << "\n[replay] Reached minute " << t << " | Battery " << Power.getBatteryLevel()
+                      << " mWh | Available " << Power.getAvailablePower() << " W | Throughput "
+                      << LoggerInstance.getThroughput() << " | Queued " << depositionQueue.size() << "\n";
+            for (const auto& chamber : depositionChambers) {
+                std::cout << "  " << chamber->name() << ": completed " << chamber->chamberStats().completed
+                          << " | defect draws " << chamber->defectDraws() << " | carrier";
+                for (const Task* wafer : chamber->carrierTasks()) {
+                    std::cout << " " << wafer->id << " (" << wafer->phase[0].elapsedTime << "/" << wafer->phase[0].requiredTime << ")";
+                }
+                std::cout << "\n";
+            }
+        }
+        if (t >= fastForwardTo) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    alloc::leaveSteadyState();
+    alloc::setTickThread(false);
+    usage::endThread();
+    if (introspection) introspection->stop();
+    tickBarrier.stop();  // wake the chambers to let them exit once they see the barrier stopped
+
+    for (auto& th : deposition_threads) th.join();
+    runJournal.close();
+    if (replaying) {
+        if (runJournal.divergedAt() < 0) {
+            std::cout << "[replay] All " << SIM_DURATION << " minutes matched " << replayPath << "\n";
+        } else {
+            std::cout << "[replay] Diverged from " << replayPath << " at minute " << runJournal.divergedAt() << "\n";
+        }
+    } else if (journalPath) {
+        std::cout << "[journal] Recorded to " << journalPath << "\n";
+    }
+    SF_TRACE_WRITE("../../scheduler_dl/data/trace.json");   // Chrome / Perfetto trace of the run
+
+    // ---- chamber utilisation: how many chambers can this power budget feed? ----
+    std::cout << "\nChamber | Completed | Batches | Busy | Calibrating | Cooling | Idle | BatchWait | PowerDenied | Blocked | Down (minutes)\n";
+    int poweredDenied = 0;
+    int blocked = 0;
+    long long waferWait = 0;
+    int loaded = 0;
+    for (const auto& chamber : depositionChambers) {
+        const ChamberStats& st = chamber->chamberStats();
+        std::cout << chamber->name() << " | " << st.completed << " | " << st.batches << " | " << st.busyMinutes << " | "
+                  << st.calibratingMinutes << " | " << st.coolingMinutes << " | "
+                  << st.idleMinutes << " | " << st.batchWaitMinutes << " | " << st.powerDeniedMinutes
+                  << " | " << st.blockedMinutes << " | " << st.downMinutes << "\n";
+        poweredDenied += st.powerDeniedMinutes;
+        blocked += st.blockedMinutes;
+        waferWait += st.waferWaitMinutes;
+        loaded += st.wafersLoaded;   // the same wafers waferWaitMinutes is summed over
+    }
+    std::cout << "Chambers: " << depoChambers
+              << " | Wafers through deposition: " << LoggerInstance.getThroughput() << "/" << tasks.size()
+              << " | Power-denied chamber-minutes: " << poweredDenied << "\n";
+    std::cout << "Carrier: " << carrierSize << " wafers, max wait " << maxBatchWait << " min"
+              << " | Mean queue wait per wafer: " << (loaded ? static_cast<double>(waferWait) / loaded : 0.0) << " min\n";
+    // wafer maps of the deposited wafers: film uniformity and what the shield's wake left on them
+    int mapped = 0, contaminatedWafers = 0, maxCells = 0;
+    double sumNonUniformity = 0.0, sumCells = 0.0;
+    for (const Task* task : tasks) {
+        const Task::PhaseInfo& deposited = task->phase[0];
+        if (!deposited.isDone() || deposited.meanThickness <= 0.0) continue;
+        mapped++;
+        sumNonUniformity += deposited.nonUniformity;
+        sumCells += deposited.contaminatedCells;
+        maxCells = std::max(maxCells, deposited.contaminatedCells);
+        contaminatedWafers += deposited.contaminatedCells > 0;
+    }
+    std::cout << "Wafer maps: " << mapped << " wafers | mean non-uniformity " << (mapped ? sumNonUniformity / mapped : 0.0)
+              << " | contaminated cells mean " << (mapped ? sumCells / mapped : 0.0) << " max " << maxCells
+              << " | wafers with contamination " << contaminatedWafers << "\n";
 
-        // Publish a NEW tick and wake the worker exactly once per minute.
-        tick.fetch_add(1, std::memory_order_release);
-        depo_cv.notify_one();
+    // ---- WIP buffer to ion implantation: size it so blocking costs no deposition throughput ----
+    const BufferStats ionStats = ionBuffer.stats();
+    std::cout << "Buffer Deposition -> Ion Implantation | capacity "
+              << (ionBufferConfig.capacity ? std::to_string(ionBufferConfig.capacity) : std::string("unbounded"))
+              << " | max dwell " << (ionBufferConfig.maxDwellMinutes ? std::to_string(ionBufferConfig.maxDwellMinutes) + " min" : std::string("none"))
+              << "\n  mean occupancy " << ionStats.meanOccupancy() << " | high water " << ionStats.highWater
+              << " | full " << ionStats.fullMinutes << "/" << ionStats.samples << " min"
+              << " | pushed " << ionStats.pushed << " | taken " << ionStats.popped
+              << " | refused pushes " << ionStats.rejected << " | scrapped (dwell) " << ionStats.expired
+              << "\n  chambers blocked " << blocked << " chamber-minutes\n";
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    // ---- ion implantation: dose kept across beam trips is what the time-based stage scrapped ----
+    const ImplantStats& implant = ionImplanter.implantStats();
+    std::cout << "\nIon Implantation | Completed | Scrapped | Beam (reduced) | Calibrating | Cooling | Idle | PowerDenied | Down (minutes)\n"
+              << ionImplanter.name() << " | " << implant.completed << " | " << implant.scrapped << " | "
+              << implant.beamMinutes << " (" << implant.reducedBeamMinutes << ") | " << implant.calibratingMinutes << " | "
+              << implant.coolingMinutes << " | " << implant.idleMinutes << " | " << implant.powerDeniedMinutes << " | " << implant.downMinutes << "\n";
+    std::cout << "Beam trips resumed " << implant.resumed << " (max " << ionImplanter.implantConfig().maxRetries
+              << " per wafer) | drift re-tunes " << implant.retunes
+              << " | dose delivered " << implant.doseDelivered << " | kept across trips " << implant.doseKept
+              << " | lost on scrapped wafers " << implant.doseScrapped << " ions/cm²\n";
+
+    // ---- crystal growth: what pausing for the eclipse cost in hold energy, reheat and quality ----
+    const GrowthStats& growth = crystalFurnace.growthStats();
+    std::cout << "\nCrystal Growth (" << (growthConfig.policy == PausePolicy::Eclipse ? "pause for eclipse" : "run through")
+              << ") | Completed | Growth | Reheat | Held | Cold | Cooling | Idle (minutes)\n"
+              << crystalFurnace.name() << " | " << growth.completed << " | " << growth.growthMinutes << " | "
+              << growth.reheatMinutes << " | " << growth.heldMinutes << " | " << growth.coldMinutes << " | "
+              << growth.coolingMinutes << " | " << growth.idleMinutes << "\n";
+    std::cout << "Pauses at pause points " << growth.pauses << " | forced " << growth.forcedPauses
+              << " | wafers marked defective by a pause " << growth.pauseDefects
+              << " | hold " << growth.holdEnergy << " W·min | reheat " << growth.reheatEnergy << " W·min"
+              << " | heater failed " << growth.heaterFailedMinutes << " min\n";
+
+    // ---- faults: what was injected, and the bus it left behind ----
+    if (!faultInjector.specs().empty()) {
+        faultInjector.report(std::cout, SIM_DURATION);
+        std::cout << "Battery capacity at the end " << Power.getCapacity() << " mWh"
+                  << (Power.isBatteryTripped() ? " (tripped)" : "") << "\n";
     }
 
-    keep_running.store(false, std::memory_order_release);
-    depo_cv.notify_one();  // wake them up to let them exit once they see that the keep_running flag is set to false 
+    // ---- utilisation: host CPU per thread next to the simulated minutes of its stage ----
+    // Other = wall time neither on CPU nor blocked (main's 10 ms pacing sleep, preemption);
+    // LockWait = contended ProfiledMutex acquisitions (every build; lock.* metrics need SPACEFORGE_PROFILE_LOCKS)
+    // Busy = processing + calibrating, Idle = no carrier or cooling down,
+    // Stalled = power denied, blocked by a full output buffer or down (a fault);
+    // the implanter (beam + calibrating | idle + cooling | power denied + down) and the furnace
+    // (growth + reheat | idle + cooling | paused, held or cold) run on main: their CPU is in its row
+    const auto ms  = [](std::uint64_t ns) { return static_cast<double>(ns) / 1e6; };
+    const auto pct = [](double part, double whole) { return whole > 0 ? 100.0 * part / whole : 0.0; };
+    std::cout << "\nThread | CPU ms | Wall ms | CPU % | TickWait % | LockWait % | Other % | Busy | Idle | Stalled (sim minutes)\n"
+              << std::fixed << std::setprecision(1);
+    int stageBusy = 0, stageIdle = 0, stageStalled = 0;
+    for (const usage::ThreadStats& th : usage::threads()) {
+        const double wall  = static_cast<double>(th.wallNs);
+        const double other = std::max(0.0, wall - static_cast<double>(th.cpuNs + th.tickWaitNs + th.lockWaitNs));
+        std::cout << th.name << " | " << ms(th.cpuNs) << " | " << ms(th.wallNs) << " | " << pct(th.cpuNs, wall)
+                  << " | " << pct(th.tickWaitNs, wall) << " | " << pct(th.lockWaitNs, wall) << " | " << pct(other, wall);
+
+        const auto stage = std::find_if(depositionChambers.begin(), depositionChambers.end(),
+                                        [&](const auto& c) { return c->name() == th.name; });
+        if (stage == depositionChambers.end()) {   // main drives the tick, it has no stage of its own
+            std::cout << " | - | - | -\n";
+            continue;
+        }
+        const ChamberStats& st = (*stage)->chamberStats();
+        const int busy = st.busyMinutes + st.calibratingMinutes;
+        const int idle = st.idleMinutes + st.coolingMinutes;
+        const int stalled = st.powerDeniedMinutes + st.blockedMinutes + st.downMinutes;
+        std::cout << " | " << busy << " | " << idle << " | " << stalled << "\n";
+        stageBusy += busy;
+        stageIdle += idle;
+        stageStalled += stalled;
+    }
+    const auto mainStageRow = [&](const std::string& name, int busy, int idle, int stalled) {
+        std::cout << name << " (main) | - | - | - | - | - | - | " << busy << " | " << idle << " | " << stalled << "\n";
+    };
+    const int ionBusy = implant.beamMinutes + implant.calibratingMinutes;
+    const int ionIdle = implant.idleMinutes + implant.coolingMinutes;
+    const int ionStalled = implant.powerDeniedMinutes + implant.downMinutes;
+    mainStageRow(ionImplanter.name(), ionBusy, ionIdle, ionStalled);
+    const int growthBusy = growth.growthMinutes + growth.reheatMinutes;
+    const int growthIdle = growth.idleMinutes + growth.coolingMinutes;
+    const int growthStalled = growth.heldMinutes + growth.coldMinutes;
+    mainStageRow(crystalFurnace.name(), growthBusy, growthIdle, growthStalled);
+
+    const double stageMinutes = stageBusy + stageIdle + stageStalled;
+    std::cout << "Deposition stage: busy " << pct(stageBusy, stageMinutes) << " % | idle " << pct(stageIdle, stageMinutes)
+              << " % | stalled (power, blocked, down) " << pct(stageStalled, stageMinutes) << " % of chamber-minutes\n";
+    const double ionMinutes = ionBusy + ionIdle + ionStalled;
+    std::cout << "Ion Implantation stage: busy " << pct(ionBusy, ionMinutes) << " % | idle " << pct(ionIdle, ionMinutes)
+              << " % | stalled (power, down) " << pct(ionStalled, ionMinutes) << " % of minutes\n";
+    const double growthMinutes = growthBusy + growthIdle + growthStalled;
+    std::cout << "Crystal Growth stage: busy " << pct(growthBusy, growthMinutes) << " % | idle " << pct(growthIdle, growthMinutes)
+              << " % | stalled (paused) " << pct(growthStalled, growthMinutes) << " % of minutes\n";
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+
+    // ---- lots: what the customer sees is the makespan of the whole lot ----
+    if (lotGraph.hasEdges()) lotGraph.report(std::cout);
+    if (planner) planner->report(std::cout, lastUnload);
+
+    // ---- per-recipe outcomes of the wafers that left the line ----
+    lineYield.report(std::cout, SIM_DURATION);
+
+    // ---- queueing: wafers still waiting or on a carrier keep the time they have so far ----
+    queueing::StageObservation& depositionObserved = pipeline.observation(depositionStage);
+    for (const Task* queued : depositionQueue.front(depositionQueue.size())) {
+        depositionObserved.censorWait(SIM_DURATION - queued->readyMinute);
+    }
+    for (std::size_t c = 0; c < depositionChambers.size(); ++c) {
+        depositionChambers[c]->censorQueueing(SIM_DURATION);
+        const ChamberStats& st = depositionChambers[c]->chamberStats();
+        chamberQueueing[c].occupiedMinutes = st.busyMinutes + st.calibratingMinutes + st.coolingMinutes +
+                                             st.powerDeniedMinutes + st.blockedMinutes + st.downMinutes;
+        depositionObserved.merge(chamberQueueing[c]);
+    }
+    queueing::StageObservation& ionObserved = pipeline.observation(ionStage);
+    for (const Task* buffered : ionBuffer.front(ionBuffer.size())) {
+        ionObserved.censorWait(SIM_DURATION - buffered->readyMinute);
+    }
+    ionImplanter.censorQueueing(SIM_DURATION);
+    ionQueueing.occupiedMinutes = implant.beamMinutes + implant.calibratingMinutes + implant.coolingMinutes +
+                                  implant.powerDeniedMinutes + implant.downMinutes;
+    ionObserved.merge(ionQueueing);
+    queueing::StageObservation& crystalObserved = pipeline.observation(crystalStage);
+    for (const Task* buffered : crystalBuffer.front(crystalBuffer.size())) {
+        crystalObserved.censorWait(SIM_DURATION - buffered->readyMinute);
+    }
+    crystalFurnace.censorQueueing(SIM_DURATION);
+    crystalQueueing.occupiedMinutes = growth.growthMinutes + growth.reheatMinutes + growth.heldMinutes +
+                                      growth.coldMinutes + growth.coolingMinutes;
+    crystalObserved.merge(crystalQueueing);
+    pipeline.report(std::cout, SIM_DURATION);
+
+    // ---- where the energy came from; the ledger must account for every W·min the bus handed out ----
+    energy::EnergyLedger energyLedger(SIM_DURATION);
+    for (const auto& ledger : chamberEnergy) energyLedger.merge(ledger);
+    energyLedger.merge(ionEnergy);
+    energyLedger.merge(crystalEnergy);
+    energyLedger.merge(lineEnergy);
+    energyLedger.report(std::cout);
+    const bool balanced = energyLedger.total(energy::Source::Solar) == Power.getSolarDrawn() * energy::SCALE &&
+                          energyLedger.total(energy::Source::Battery) == Power.getBatteryDrawn() * energy::SCALE;
+    std::cout << "Ledger vs power bus: " << (balanced ? "balanced" : "MISMATCH") << " (bus solar "
+              << Power.getSolarDrawn() << " / battery " << Power.getBatteryDrawn() << " W·min)\n";
+    // every wafer is closed once, when it leaves the line: grown, scrapped by the implanter or expired in its buffer
+    const std::uint64_t wafersOut = static_cast<std::uint64_t>(growth.completed) + static_cast<std::uint64_t>(implant.scrapped) +
+                                    ionBuffer.stats().expired;
+    std::cout << "Ledger wafers vs line exits: " << (energyLedger.wafersClosed() == wafersOut ? "match" : "MISMATCH")
+              << " (" << energyLedger.wafersClosed() << " closed / " << wafersOut << " out)\n";
+
+    tickLatency.report(std::cout, "main tick latency (excluding the 10 ms pacing sleep)");
 
-    deposition_thread.join();
+    metrics::registry().dump(std::cout);
+    if (noAllocMode) alloc::report(std::cout);
 
     // tidy up dynamically allocated tasks
     for (Task* t : tasks) {
@@ -0,0 +1,157 @@
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+namespace metrics {
+
+std::size_t threadShard() {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t shard = next.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return shard;
+}
+
+/* ---------- Counter ---------- */
+std::uint64_t Counter::value() const {
+    std::uint64_t total = 0;
+    for (const auto& s : shards_) total += s.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+/* ---------- Gauge ---------- */
+void Gauge::raiseMax(std::int64_t v) {
+    std::int64_t seen = max_.load(std::memory_order_relaxed);
+    while (v > seen && !max_.compare_exchange_weak(seen, v, std::memory_order_relaxed)) {}
+}
+
+void Gauge::set(std::int64_t v) {
+    value_.store(v, std::memory_order_relaxed);
+    raiseMax(v);
+}
+
+void Gauge::add(std::int64_t d) {
+    raiseMax(value_.fetch_add(d, std::memory_order_relaxed) + d);
+}
+
+/* ---------- Histogram ---------- */
+Histogram::Histogram(std::vector<double> upperBounds) : bounds_(std::move(upperBounds)) {
+    std::sort(bounds_.begin(), bounds_.end());
+    for (auto& s : shards_) {
+        s.counts.reset(new std::atomic<std::uint64_t>[bounds_.size() + 1]);
+        for (std::size_t i = 0; i <= bounds_.size(); ++i) s.counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(double v) {
+    const std::size_t bucket = std::lower_bound(bounds_.begin(), bounds_.end(), v) - bounds_.begin();
+    Shard& s = shards_[threadShard()];
+    s.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    s.count.fetch_add(1, std::memory_order_relaxed);
+
+    // shards are mostly single-writer, so this CAS almost never retries
+    double sum = s.sum.load(std::memory_order_relaxed);
+    while (!s.sum.compare_exchange_weak(sum, sum + v, std::memory_order_relaxed)) {}
+}
+
+std::vector<std::uint64_t> Histogram::counts() const {
+    std::vector<std::uint64_t> out(bounds_.size() + 1, 0);
+    for (const auto& s : shards_) {
+        for (std::size_t i = 0; i < out.size(); ++i) out[i] += s.counts[i].load(std::memory_order_relaxed);
+    }
+    return out;
+}
+
+std::uint64_t Histogram::count() const {
+    std::uint64_t total = 0;
+    for (const auto& s : shards_) total += s.count.load(std::memory_order_relaxed);
+    return total;
+}
+
+double Histogram::sum() const {
+    double total = 0.0;
+    for (const auto& s : shards_) total += s.sum.load(std::memory_order_relaxed);
+    return total;
+}
+
+std::vector<double> Histogram::exponential(double start, double factor, int n) {
+    std::vector<double> bounds;
+    bounds.reserve(static_cast<std::size_t>(std::max(0, n)));
+    for (int i = 0; i < n; ++i, start *= factor) bounds.push_back(start);
+    return bounds;
+}
+
+double HistogramSnapshot::quantile(double q) const {
+    if (count == 0) return 0.0;
+    const double target = std::ceil(q * static_cast<double>(count));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (static_cast<double>(seen) >= target) {
+            return i < bounds.size() ? bounds[i] : std::numeric_limits<double>::infinity();
+        }
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+/* ---------- Registry ---------- */
+Counter& Registry::counter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = counters_[name];
+    if (!slot) slot = std::make_unique<Counter>();
+    return *slot;
+}
+
+Gauge& Registry::gauge(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = gauges_[name];
+    if (!slot) slot = std::make_unique<Gauge>();
+    return *slot;
+}
+
+Histogram& Registry::histogram(const std::string& name, const std::vector<double>& upperBounds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = histograms_[name];
+    if (!slot) slot = std::make_unique<Histogram>(upperBounds);   // first registration fixes the buckets
+    return *slot;
+}
+
+Snapshot Registry::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Snapshot snap;
+    for (const auto& [name, c] : counters_) snap.counters[name] = c->value();
+    for (const auto& [name, g] : gauges_) {
+        snap.gauges[name] = GaugeSnapshot{g->value(), g->max() == INT64_MIN ? g->value() : g->max()};
+    }
+    for (const auto& [name, h] : histograms_) {
+        HistogramSnapshot& hs = snap.histograms[name];
+        hs.bounds = h->bounds();
+        hs.counts = h->counts();
+        hs.count = h->count();
+        hs.sum = h->sum();
+    }
+    return snap;
+}
+
+void Registry::dump(std::ostream& out) const {
+    const Snapshot snap = snapshot();
+    out << "\n---- metrics ----\n";
+    for (const auto& [name, v] : snap.counters) {
+        out << std::left << std::setw(40) << name << std::right << v << "\n";
+    }
+    for (const auto& [name, g] : snap.gauges) {
+        out << std::left << std::setw(40) << name << std::right << g.value << " (max " << g.max << ")\n";
+    }
+    for (const auto& [name, h] : snap.histograms) {
+        out << std::left << std::setw(40) << name << std::right << "n=" << h.count
+            << " mean=" << h.mean() << " p50<=" << h.quantile(0.50) << " p99<=" << h.quantile(0.99) << "\n";
+    }
+}
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+}  // namespace metrics
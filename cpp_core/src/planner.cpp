@@ -0,0 +1,386 @@
+#include "Planner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <string>
+
+namespace plan {
+namespace {
+
+std::uint64_t nanosSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+}  // namespace
+
+Planner::Planner(int chambers, const std::vector<std::int64_t>& powerProfile, const Config& config)
+    : calendar_(chambers, powerProfile),
+      config_(config),
+      pins_(static_cast<std::size_t>(std::max(0, chambers))) {}
+
+int Planner::windowMinutes(const Job& job) const {
+    return config_.setupMinutes + std::max(1, job.task->phase[0].timeRemaining()) + config_.cooldownMinutes;
+}
+
+// Earliest minute the job may load: -1 while a predecessor has no window itself
+int Planner::readyAt(const Job& job, int now) const {
+    int ready = now;
+    for (int p : job.preds) {
+        const Job& pred = jobs_[static_cast<std::size_t>(p)];
+        switch (pred.state) {
+            case State::Waiting:
+                if (pred.start < 0) return -1;
+                ready = std::max(ready, pred.finish);
+                break;
+            case State::Running:
+                ready = std::max(ready, pins_[static_cast<std::size_t>(pred.chamber)].unload);
+                break;
+            case State::Done:
+                ready = std::max(ready, pred.finish);
+                break;
+            case State::Dropped:
+                return -1;
+        }
+    }
+    return ready;
+}
+
+bool Planner::place(int j, int now) {
+    Job& job = jobs_[static_cast<std::size_t>(j)];
+    const int ready = readyAt(job, now);
+    const int minutes = windowMinutes(job);
+    if (ready < 0) {
+        job.start = job.finish = -1;
+        return false;
+    }
+
+    // bookings only take capacity away, so a search that found nothing in [from, to) for m minutes
+    // spares the next one of m or more minutes that much (a whole horizon, when it is full)
+    int from = ready;
+    const bool known = ready >= skipFrom_ && ready <= skipTo_ && minutes >= skipMinutes_;
+    if (known) from = skipTo_;
+    int chamber = -1;
+    const int start = from >= calendar_.horizon() ? -1 : calendar_.earliestWindowAny(from, minutes, config_.watts, chamber);
+    skipTo_ = start < 0 ? INT_MAX : start;
+    if (known) {
+        skipMinutes_ = std::max(skipMinutes_, minutes);
+    } else {
+        skipFrom_ = ready;
+        skipMinutes_ = minutes;
+    }
+    if (start < 0) {
+        job.start = job.finish = -1;
+        return false;
+    }
+    job.reservation = calendar_.reserve(chamber, start, minutes, config_.watts);
+    job.chamber = chamber;
+    job.start = start;
+    job.finish = start + minutes - config_.cooldownMinutes;
+    byStart_.emplace(start, j);
+    return true;
+}
+
+void Planner::unbook(int j) {
+    Job& job = jobs_[static_cast<std::size_t>(j)];
+    if (job.reservation >= 0) {
+        calendar_.cancel(job.reservation);
+        byStart_.erase({job.start, j});
+        forgetSkips();   // freed capacity: earlier searches may find room now
+    }
+    job.reservation = -1;
+}
+
+void Planner::forgetSkips() {
+    skipFrom_ = INT_MAX;
+    skipTo_ = INT_MIN;
+}
+
+int Planner::nextOnChamber(int chamber, int from, bool skipDirty) const {
+    for (auto it = byStart_.lower_bound({from, INT_MIN}); it != byStart_.end(); ++it) {
+        const Job& job = jobs_[static_cast<std::size_t>(it->second)];
+        if (job.chamber == chamber && !(skipDirty && job.dirty)) return it->second;
+    }
+    return -1;
+}
+
+void Planner::markDirty(int j) {
+    Job& job = jobs_[static_cast<std::size_t>(j)];
+    if (job.dirty || job.state != State::Waiting) return;
+    job.dirty = true;
+    dirty_.push_back(j);
+}
+
+void Planner::build(const std::vector<Task*>& tasks) {
+    jobs_.assign(tasks.size(), Job());
+    waiting_ = jobs_.size();
+    index_.clear();
+    std::unordered_map<std::string, int> byId;
+    for (std::size_t j = 0; j < tasks.size(); ++j) {
+        jobs_[j].task = tasks[j];
+        index_.emplace(tasks[j], static_cast<int>(j));
+        byId.emplace(tasks[j]->id, static_cast<int>(j));
+    }
+    for (std::size_t j = 0; j < jobs_.size(); ++j) {
+        for (const std::string& predId : jobs_[j].task->after) {
+            const auto it = byId.find(predId);
+            if (it == byId.end()) continue;   // TaskGraph::build has reported it already
+            jobs_[j].preds.push_back(it->second);
+            jobs_[static_cast<std::size_t>(it->second)].succs.push_back(static_cast<int>(j));
+        }
+    }
+
+    // Kahn's order, file order among the ready ones; a cycle leaves its wafers out (never planned)
+    topo_.clear();
+    std::vector<int> indegree(jobs_.size());
+    for (std::size_t j = 0; j < jobs_.size(); ++j) {
+        indegree[j] = static_cast<int>(jobs_[j].preds.size());
+        if (indegree[j] == 0) topo_.push_back(static_cast<int>(j));
+    }
+    for (std::size_t i = 0; i < topo_.size(); ++i) {
+        jobs_[static_cast<std::size_t>(topo_[i])].rank = static_cast<int>(i);
+        for (int s : jobs_[static_cast<std::size_t>(topo_[i])].succs) {
+            if (--indegree[static_cast<std::size_t>(s)] == 0) topo_.push_back(s);
+        }
+    }
+    dirty_.reserve(jobs_.size());
+    heap_.reserve(jobs_.size());
+    replan(0);
+}
+
+void Planner::started(Task* task, int chamber) {
+    const auto it = index_.find(task);
+    if (it == index_.end() || chamber < 0 || chamber >= static_cast<int>(pins_.size())) return;
+    Job& job = jobs_[static_cast<std::size_t>(it->second)];
+    if (job.state != State::Waiting) return;
+    unbook(it->second);   // the chamber's pin covers it from now on
+    job.state = State::Running;
+    waiting_--;
+    job.chamber = chamber;
+    pins_[static_cast<std::size_t>(chamber)].running.push_back(it->second);
+}
+
+// Makes room for a pin: first this chamber's windows, then the latest windows on the others until the power fits
+void Planner::evictFor(int chamber, int now, int until, int watts) {
+    std::vector<int> overlapping;
+    for (const auto& entry : byStart_) {
+        if (entry.first >= until) break;
+        const Job& job = jobs_[static_cast<std::size_t>(entry.second)];
+        if (entry.first + windowMinutes(job) > now) overlapping.push_back(entry.second);
+    }
+    const auto evict = [&](int j) {
+        unbook(j);
+        markDirty(j);
+        stats_.evicted++;
+    };
+    for (int j : overlapping) {
+        if (jobs_[static_cast<std::size_t>(j)].chamber == chamber) evict(j);
+    }
+    for (auto it = overlapping.rbegin(); it != overlapping.rend(); ++it) {
+        if (calendar_.powerHeadroom(now, until - now) >= watts) break;
+        if (jobs_[static_cast<std::size_t>(*it)].reservation >= 0) evict(*it);
+    }
+}
+
+void Planner::pin(int chamber, int now, int unload, int until, int watts) {
+    if (chamber < 0 || chamber >= static_cast<int>(pins_.size())) return;
+    Pin& p = pins_[static_cast<std::size_t>(chamber)];
+    until = std::min(until, calendar_.horizon());
+    const int previousUnload = p.unload;
+    p.unload = unload;
+    if (p.reservation >= 0 && p.until == until && p.watts == watts) return;
+
+    if (p.reservation >= 0) calendar_.cancel(p.reservation);
+    p.reservation = -1;
+    forgetSkips();
+    p.until = until;
+    p.watts = watts;
+    if (until > now) {
+        evictFor(chamber, now, until, watts);
+        // the simulation already draws it: book what is left if others' pins hold the rest
+        const int booked = static_cast<int>(std::max<std::int64_t>(0, std::min<std::int64_t>(watts, calendar_.powerHeadroom(now, until - now))));
+        p.reservation = calendar_.reserve(chamber, now, until - now, booked);
+    }
+
+    // a later unload moves the earliest start of the carrier's successors
+    if (unload <= previousUnload) return;
+    for (int r : p.running) {
+        for (int s : jobs_[static_cast<std::size_t>(r)].succs) {
+            const Job& succ = jobs_[static_cast<std::size_t>(s)];
+            if (succ.start >= 0 && succ.start < unload) markDirty(s);
+        }
+    }
+}
+
+void Planner::finished(Task* task, int t) {
+    const auto it = index_.find(task);
+    if (it == index_.end()) return;
+    Job& job = jobs_[static_cast<std::size_t>(it->second)];
+    if (job.state == State::Running) {
+        std::vector<int>& running = pins_[static_cast<std::size_t>(job.chamber)].running;
+        running.erase(std::remove(running.begin(), running.end(), it->second), running.end());
+    } else if (job.state == State::Waiting) {
+        unbook(it->second);
+        waiting_--;
+    } else {
+        return;
+    }
+    job.state = State::Done;
+    job.finish = t;
+    if (!task->phase[0].defective) return;
+
+    // like TaskGraph: a failed wafer cancels everything it gates, and frees their windows
+    std::vector<int> work(job.succs.begin(), job.succs.end());
+    while (!work.empty()) {
+        const int d = work.back();
+        work.pop_back();
+        Job& desc = jobs_[static_cast<std::size_t>(d)];
+        if (desc.state != State::Waiting) continue;
+        unbook(d);
+        desc.state = State::Dropped;
+        waiting_--;
+        desc.start = desc.finish = -1;
+        work.insert(work.end(), desc.succs.begin(), desc.succs.end());
+    }
+}
+
+std::size_t Planner::repair(int now) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (const auto& entry : byStart_) {
+        if (entry.first >= now) break;
+        stats_.late++;
+        markDirty(entry.second);
+    }
+    if (dirty_.empty()) return 0;
+
+    const auto escalate = [&]() {
+        if (!config_.alwaysReplan) stats_.escalations++;
+        replan(now);
+        return planned();
+    };
+    // a repair touching more than half the waiting wafers costs about what a replan does
+    const std::size_t budget = std::max(config_.repairBudget, waiting_ / 2);
+    if (config_.alwaysReplan || dirty_.size() > budget) return escalate();
+
+    // warm start: the impacted wafers go back in the order the previous plan had them
+    const auto key = [&](int j) {
+        const Job& job = jobs_[static_cast<std::size_t>(j)];
+        const std::int64_t start = job.start < 0 ? INT_MAX : job.start;
+        return std::make_pair(-(start << 32 | job.rank), j);   // max-heap on the negated key
+    };
+    heap_.clear();
+    for (int j : dirty_) {
+        heap_.push_back(key(j));
+        unbook(j);
+    }
+    std::make_heap(heap_.begin(), heap_.end());
+
+    std::size_t reslotted = 0;
+    while (!heap_.empty()) {
+        std::pop_heap(heap_.begin(), heap_.end());
+        const int j = heap_.back().second;
+        heap_.pop_back();
+        if (++reslotted > budget) return escalate();
+
+        const Job& job = jobs_[static_cast<std::size_t>(j)];
+        const auto requeue = [&](int k) {
+            Job& other = jobs_[static_cast<std::size_t>(k)];
+            other.dirty = true;
+            dirty_.push_back(k);
+            heap_.push_back(key(k));
+            std::push_heap(heap_.begin(), heap_.end());
+            unbook(k);
+        };
+
+        // shift rather than jump the queue: a window landing after the next one of its old chamber
+        // pushes that one out instead, so the chamber's sequence is kept and the shift ripples on
+        const int chamber = job.chamber, previous = job.start;
+        while (place(j, now) && previous >= 0) {
+            const int next = nextOnChamber(chamber, previous, true);   // dirty and booked ⇒ re-slotted already
+            if (next < 0 || job.start <= jobs_[static_cast<std::size_t>(next)].start) break;
+            unbook(j);
+            requeue(next);
+        }
+
+        for (int s : job.succs) {
+            const Job& succ = jobs_[static_cast<std::size_t>(s)];
+            if (succ.dirty || succ.state != State::Waiting) continue;
+            if (job.start >= 0 && succ.start >= job.finish) continue;   // still consistent
+            requeue(s);
+        }
+    }
+    for (int j : dirty_) jobs_[static_cast<std::size_t>(j)].dirty = false;
+    dirty_.clear();
+
+    const std::uint64_t ns = nanosSince(begin);
+    stats_.repairs++;
+    stats_.reslotted += reslotted;
+    stats_.repairNs += ns;
+    stats_.repairNsMax = std::max(stats_.repairNsMax, ns);
+    return reslotted;
+}
+
+void Planner::replan(int now) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::size_t j = 0; j < jobs_.size(); ++j) {
+        if (jobs_[j].state == State::Waiting) unbook(static_cast<int>(j));
+    }
+    for (int j : topo_) {
+        Job& job = jobs_[static_cast<std::size_t>(j)];
+        job.dirty = false;
+        if (job.state == State::Waiting) place(j, now);
+    }
+    dirty_.clear();
+
+    const std::uint64_t ns = nanosSince(begin);
+    stats_.replans++;
+    stats_.replanNs += ns;
+    stats_.replanNsMax = std::max(stats_.replanNsMax, ns);
+}
+
+Task* Planner::nextFor(int chamber, int& start) const {
+    const int j = nextOnChamber(chamber, INT_MIN, false);
+    if (j < 0) return nullptr;
+    start = jobs_[static_cast<std::size_t>(j)].start;
+    return jobs_[static_cast<std::size_t>(j)].task;
+}
+
+std::size_t Planner::planned() const { return byStart_.size(); }
+
+int Planner::plannedFinish() const {
+    int last = -1;
+    for (const Job& job : jobs_) {
+        switch (job.state) {
+            case State::Waiting:
+            case State::Done:
+                last = std::max(last, job.finish);
+                break;
+            case State::Running:
+                last = std::max(last, pins_[static_cast<std::size_t>(job.chamber)].unload);
+                break;
+            case State::Dropped:
+                break;
+        }
+    }
+    return last;
+}
+
+void Planner::report(std::ostream& out, int actualFinish) const {
+    std::size_t waiting = 0, dropped = 0;
+    for (const Job& job : jobs_) {
+        if (job.state == State::Waiting) waiting++;
+        if (job.state == State::Dropped) dropped++;
+    }
+    const auto micros = [](std::uint64_t ns, std::uint64_t n) { return n ? static_cast<double>(ns) / 1e3 / static_cast<double>(n) : 0.0; };
+    out << "\nPlan (" << (config_.alwaysReplan ? "full replan" : "local repair") << ") | waiting " << waiting
+        << " (windows " << planned() << ", unplanned " << waiting - planned() << ") | dropped " << dropped
+        << " | last unload: planned " << plannedFinish() << ", actual " << actualFinish << "\n"
+        << "  repairs " << stats_.repairs << " | windows re-slotted " << stats_.reslotted << " | evicted by pins "
+        << stats_.evicted << " | late " << stats_.late << " | full replans " << stats_.replans
+        << " (escalations " << stats_.escalations << ")\n"
+        << "  latency: repair mean " << micros(stats_.repairNs, stats_.repairs) << " us, max " << micros(stats_.repairNsMax, 1)
+        << " us | full replan mean " << micros(stats_.replanNs, stats_.replans) << " us, max " << micros(stats_.replanNsMax, 1) << " us\n";
+}
+
+}  // namespace plan
@@ -0,0 +1,81 @@
+#include "ProfiledMutex.hpp"
+
+#ifdef SPACEFORGE_PROFILE_LOCKS
+
+#include "Metrics.hpp"
+#include "ThreadUsage.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+
+struct LockStats {
+    metrics::Counter&   acquisitions;
+    metrics::Counter&   contended;
+    metrics::Histogram& waitNs;
+    metrics::Histogram& holdNs;
+};
+
+namespace {
+
+// one LockStats per name, shared by every mutex with that name (e.g. all wafers' phase locks)
+LockStats* statsFor(const char* name) {
+    static std::mutex cacheMutex;
+    static std::map<std::string, std::unique_ptr<LockStats>> cache;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto& slot = cache[name];
+    if (!slot) {
+        const std::string prefix = std::string("lock.") + name;
+        const auto buckets = metrics::Histogram::exponential(32, 2, 24);   // 32 ns … ~270 ms
+        metrics::Registry& r = metrics::registry();
+        slot.reset(new LockStats{r.counter(prefix + ".acquisitions"), r.counter(prefix + ".contended"),
+                                 r.histogram(prefix + ".wait_ns", buckets), r.histogram(prefix + ".hold_ns", buckets)});
+    }
+    return slot.get();
+}
+
+}  // namespace
+
+ProfiledMutex::ProfiledMutex(const char* name) : stats_(statsFor(name)) {}
+
+void ProfiledMutex::lock() {
+    if (!mutex_.try_lock()) {
+        stats_->contended.add();
+        const auto waitStart = std::chrono::steady_clock::now();
+        mutex_.lock();
+        acquiredAt_ = std::chrono::steady_clock::now();
+        const auto waited = std::chrono::duration<double, std::nano>(acquiredAt_ - waitStart).count();
+        stats_->waitNs.observe(waited);
+        usage::addLockWait(static_cast<std::uint64_t>(waited));   // the calling thread's LockWait column
+    } else {
+        acquiredAt_ = std::chrono::steady_clock::now();
+        stats_->waitNs.observe(0.0);
+    }
+    stats_->acquisitions.add();
+}
+
+bool ProfiledMutex::try_lock() {
+    if (!mutex_.try_lock()) return false;
+    acquiredAt_ = std::chrono::steady_clock::now();
+    stats_->acquisitions.add();
+    return true;
+}
+
+void ProfiledMutex::unlock() {
+    stats_->holdNs.observe(metrics::nanosSince(acquiredAt_));
+    mutex_.unlock();
+}
+
+#else
+
+#include "ThreadUsage.hpp"
+
+void ProfiledMutex::lockContended() {
+    const auto waitStart = std::chrono::steady_clock::now();
+    std::mutex::lock();
+    usage::addLockWait(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - waitStart).count()));
+}
+
+#endif  // SPACEFORGE_PROFILE_LOCKS
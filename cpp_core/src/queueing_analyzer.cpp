@@ -0,0 +1,168 @@
+#include "QueueingAnalyzer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+namespace queueing {
+namespace {
+
+constexpr double LITTLE_TOLERANCE = 0.05;   // relative error still reported as consistent
+constexpr double MINUTES_PER_DAY = 1440.0;
+
+double relativeError(double measured, double predicted) {
+    if (measured <= 0.0 && predicted <= 0.0) return 0.0;
+    return std::fabs(measured - predicted) / std::max(measured, predicted);
+}
+
+}  // namespace
+
+void RunningStats::merge(const RunningStats& other) {
+    if (other.n_ == 0) return;
+    if (n_ == 0) {
+        *this = other;
+        return;
+    }
+    const double n = static_cast<double>(n_ + other.n_);
+    const double delta = other.mean_ - mean_;
+    m2_ += other.m2_ + delta * delta * static_cast<double>(n_) * static_cast<double>(other.n_) / n;
+    mean_ += delta * static_cast<double>(other.n_) / n;
+    n_ += other.n_;
+    sum_ += other.sum_;
+}
+
+double RunningStats::stddev() const { return std::sqrt(variance()); }
+
+void StageObservation::merge(const StageObservation& other) {
+    arrivals += other.arrivals;
+    departures += other.departures;
+    wait.merge(other.wait);
+    residence.merge(other.residence);
+    cycle.merge(other.cycle);
+    batch.merge(other.batch);
+    occupiedMinutes += other.occupiedMinutes;
+    queueArea += other.queueArea;
+    chamberArea += other.chamberArea;
+    samples = std::max(samples, other.samples);   // one sampler per stage; chambers add none
+}
+
+int QueueingAnalyzer::addStage(const std::string& name, int chambers) {
+    Stage stage;
+    stage.name = name;
+    stage.chambers = std::max(1, chambers);
+    stages_.push_back(stage);
+    return static_cast<int>(stages_.size()) - 1;
+}
+
+int QueueingAnalyzer::addNominalStage(const std::string& name, int chambers, double cycleMinutes, double waferPerCycle) {
+    const int index = addStage(name, chambers);
+    Stage& stage = stages_.back();
+    stage.nominal = true;
+    stage.cycleMinutes = cycleMinutes;
+    stage.waferPerCycle = std::max(1.0, waferPerCycle);
+    return index;
+}
+
+std::vector<StageFigures> QueueingAnalyzer::figures(long long minutes) const {
+    std::vector<StageFigures> out;
+    const double T = static_cast<double>(std::max(1LL, minutes));
+    double offered = 0.0;   // what the previous stage passes on
+    for (std::size_t i = 0; i < stages_.size(); ++i) {
+        const Stage& stage = stages_[i];
+        const StageObservation& o = stage.observed;
+        StageFigures f;
+        f.name = stage.name;
+        f.chambers = stage.chambers;
+        f.nominal = stage.nominal;
+
+        if (stage.nominal) {
+            f.cycleMinutes = stage.cycleMinutes;
+            f.waferPerCycle = stage.waferPerCycle;
+            f.capacity = f.cycleMinutes > 0 ? f.chambers * f.waferPerCycle / f.cycleMinutes : 0.0;
+            f.arrivalRate = offered;
+            f.throughput = std::min(offered, f.capacity);
+            f.utilization = f.capacity > 0 ? f.arrivalRate / f.capacity : 0.0;
+        } else {
+            f.arrivalRate = i == 0 ? static_cast<double>(o.arrivals) / T : offered;
+            f.throughput = static_cast<double>(o.departures) / T;
+            f.cycleMinutes = o.cycle.mean();
+            f.waferPerCycle = o.batch.count() ? o.batch.mean() : 1.0;
+            f.capacity = f.cycleMinutes > 0 ? f.chambers * f.waferPerCycle / f.cycleMinutes : 0.0;
+            f.utilization = static_cast<double>(o.occupiedMinutes) / (f.chambers * T);
+
+            // Little's law over the sampled minutes: Σ samples = Σ per-wafer times, censored included
+            const double sampled = static_cast<double>(std::max(1LL, o.samples));
+            f.meanQueue = static_cast<double>(o.queueArea) / sampled;
+            f.meanWait = o.wait.mean();
+            f.littleQueueError = relativeError(f.meanQueue, static_cast<double>(o.wait.count()) / sampled * f.meanWait);
+            const double inChambers = static_cast<double>(o.chamberArea) / sampled;
+            f.littleChamberError = relativeError(inChambers, static_cast<double>(o.residence.count()) / sampled * o.residence.mean());
+        }
+        offered = f.nominal ? f.throughput : std::max(f.throughput, std::min(f.arrivalRate, f.capacity));
+        out.push_back(f);
+    }
+    return out;
+}
+
+int QueueingAnalyzer::bottleneck(const std::vector<StageFigures>& stages) {
+    int worst = -1;
+    double lowest = std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < stages.size(); ++i) {
+        if (stages[i].capacity > 0 && stages[i].capacity < lowest) {
+            lowest = stages[i].capacity;
+            worst = static_cast<int>(i);
+        }
+    }
+    return worst;
+}
+
+double QueueingAnalyzer::pipelineThroughput(const std::vector<StageFigures>& stages, int extraAt) {
+    if (stages.empty()) return 0.0;
+    double x = stages.front().arrivalRate;
+    for (std::size_t i = 0; i < stages.size(); ++i) {
+        const StageFigures& f = stages[i];
+        const int chambers = f.chambers + (static_cast<int>(i) == extraAt ? 1 : 0);
+        const double capacity = f.cycleMinutes > 0 ? chambers * f.waferPerCycle / f.cycleMinutes : x;
+        x = std::min(x, capacity);
+    }
+    return x;
+}
+
+void QueueingAnalyzer::report(std::ostream& out, long long minutes) const {
+    const std::vector<StageFigures> stages = figures(minutes);
+    const auto perDay = [](double perMinute) { return perMinute * MINUTES_PER_DAY; };
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+
+    out << "\nStage | Chambers | Arrivals/day | Throughput/day | Cycle (min) | Wafers/cycle | Capacity/day"
+        << " | Utilisation % | Lq | Wq (min) | Little Lq | Little L\n"
+        << std::fixed << std::setprecision(2);
+    for (const StageFigures& f : stages) {
+        out << f.name << (f.nominal ? " (nominal)" : "") << " | " << f.chambers << " | " << perDay(f.arrivalRate)
+            << " | " << perDay(f.throughput) << " | " << f.cycleMinutes << " | " << f.waferPerCycle
+            << " | " << perDay(f.capacity) << " | " << 100.0 * f.utilization;
+        if (f.nominal) {
+            out << " | - | - | - | -\n";
+            continue;
+        }
+        out << " | " << f.meanQueue << " | " << f.meanWait
+            << " | " << (f.littleQueueError <= LITTLE_TOLERANCE ? "ok" : "CHECK") << " (" << 100.0 * f.littleQueueError << " %)"
+            << " | " << (f.littleChamberError <= LITTLE_TOLERANCE ? "ok" : "CHECK") << " (" << 100.0 * f.littleChamberError << " %)\n";
+    }
+
+    const int worst = bottleneck(stages);
+    if (worst >= 0) {
+        const StageFigures& b = stages[static_cast<std::size_t>(worst)];
+        const double now = pipelineThroughput(stages);
+        const double more = pipelineThroughput(stages, worst);
+        out << "Bottleneck: " << b.name << " (capacity " << perDay(b.capacity) << " wafers/day, "
+            << (now < stages.front().arrivalRate ? "limits the pipeline" : "arrivals are the limit for now") << ")\n"
+            << "Pipeline throughput bound: " << perDay(now) << " wafers/day | with one more " << b.name
+            << " chamber: " << perDay(more) << " (+" << perDay(more - now) << ")\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+}  // namespace queueing
@@ -0,0 +1,209 @@
+#include "ReservationCalendar.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace plan {
+
+/* ---------- Timeline ---------- */
+
+Timeline::Timeline(const std::vector<std::int64_t>& initial)
+    : horizon_(static_cast<int>(initial.size())) {
+    const std::size_t nodes = 4 * std::max<std::size_t>(1, initial.size());
+    min_.assign(nodes, 0);
+    max_.assign(nodes, 0);
+    lazy_.assign(nodes, 0);
+    if (horizon_ > 0) build(1, 0, horizon_ - 1, initial);
+}
+
+void Timeline::build(std::size_t node, int lo, int hi, const std::vector<std::int64_t>& initial) {
+    if (lo == hi) {
+        min_[node] = max_[node] = initial[static_cast<std::size_t>(lo)];
+        return;
+    }
+    const int mid = lo + (hi - lo) / 2;
+    build(2 * node, lo, mid, initial);
+    build(2 * node + 1, mid + 1, hi, initial);
+    min_[node] = std::min(min_[2 * node], min_[2 * node + 1]);
+    max_[node] = std::max(max_[2 * node], max_[2 * node + 1]);
+}
+
+void Timeline::apply(std::size_t node, std::int64_t delta) {
+    min_[node] += delta;
+    max_[node] += delta;
+    lazy_[node] += delta;
+}
+
+void Timeline::push(std::size_t node) {
+    if (lazy_[node] == 0) return;
+    apply(2 * node, lazy_[node]);
+    apply(2 * node + 1, lazy_[node]);
+    lazy_[node] = 0;
+}
+
+void Timeline::add(int begin, int end, std::int64_t delta) {
+    begin = std::max(begin, 0);
+    end = std::min(end, horizon_);
+    if (begin < end) add(1, 0, horizon_ - 1, begin, end - 1, delta);
+}
+
+void Timeline::add(std::size_t node, int lo, int hi, int begin, int end, std::int64_t delta) {
+    if (end < lo || hi < begin) return;
+    if (begin <= lo && hi <= end) {
+        apply(node, delta);
+        return;
+    }
+    push(node);
+    const int mid = lo + (hi - lo) / 2;
+    add(2 * node, lo, mid, begin, end, delta);
+    add(2 * node + 1, mid + 1, hi, begin, end, delta);
+    min_[node] = std::min(min_[2 * node], min_[2 * node + 1]);
+    max_[node] = std::max(max_[2 * node], max_[2 * node + 1]);
+}
+
+std::int64_t Timeline::min(int begin, int end) {
+    begin = std::max(begin, 0);
+    end = std::min(end, horizon_);
+    if (begin >= end) return std::numeric_limits<std::int64_t>::max();
+    return min(1, 0, horizon_ - 1, begin, end - 1);
+}
+
+std::int64_t Timeline::min(std::size_t node, int lo, int hi, int begin, int end) {
+    if (end < lo || hi < begin) return std::numeric_limits<std::int64_t>::max();
+    if (begin <= lo && hi <= end) return min_[node];
+    push(node);
+    const int mid = lo + (hi - lo) / 2;
+    return std::min(min(2 * node, lo, mid, begin, end), min(2 * node + 1, mid + 1, hi, begin, end));
+}
+
+int Timeline::firstBelow(int from, std::int64_t threshold) {
+    if (from >= horizon_) return horizon_;
+    return firstBelow(1, 0, horizon_ - 1, std::max(from, 0), threshold);
+}
+
+int Timeline::firstBelow(std::size_t node, int lo, int hi, int from, std::int64_t threshold) {
+    if (hi < from || min_[node] >= threshold) return horizon_;
+    if (lo == hi) return lo;
+    push(node);
+    const int mid = lo + (hi - lo) / 2;
+    const int left = firstBelow(2 * node, lo, mid, from, threshold);
+    return left < horizon_ ? left : firstBelow(2 * node + 1, mid + 1, hi, from, threshold);
+}
+
+int Timeline::firstAtLeast(int from, std::int64_t threshold) {
+    if (from >= horizon_) return horizon_;
+    return firstAtLeast(1, 0, horizon_ - 1, std::max(from, 0), threshold);
+}
+
+int Timeline::firstAtLeast(std::size_t node, int lo, int hi, int from, std::int64_t threshold) {
+    if (hi < from || max_[node] < threshold) return horizon_;
+    if (lo == hi) return lo;
+    push(node);
+    const int mid = lo + (hi - lo) / 2;
+    const int left = firstAtLeast(2 * node, lo, mid, from, threshold);
+    return left < horizon_ ? left : firstAtLeast(2 * node + 1, mid + 1, hi, from, threshold);
+}
+
+std::vector<std::int64_t> orbitPowerProfile(int horizon, int sunlightW, int eclipseW, int batteryDrawW) {
+    std::vector<std::int64_t> profile(static_cast<std::size_t>(std::max(0, horizon)));
+    for (int t = 0; t < horizon; ++t) {
+        profile[static_cast<std::size_t>(t)] = ((t % 90 < 45) ? sunlightW : eclipseW) + batteryDrawW;
+    }
+    return profile;
+}
+
+/* ---------- ReservationCalendar ---------- */
+
+ReservationCalendar::ReservationCalendar(int chambers, const std::vector<std::int64_t>& powerProfile)
+    : power_(powerProfile),
+      bookings_(static_cast<std::size_t>(std::max(0, chambers))) {
+    const std::vector<std::int64_t> free(powerProfile.size(), 1);
+    chambers_.reserve(bookings_.size());
+    for (std::size_t c = 0; c < bookings_.size(); ++c) chambers_.emplace_back(free);
+}
+
+int ReservationCalendar::earliestWindow(int chamber, int from, int minutes, int watts) {
+    if (chamber < 0 || chamber >= chambers() || minutes <= 0) return -1;
+    return search(chamber, from, minutes, watts, horizon() - minutes);
+}
+
+// Alternate between the two resources: each step jumps past a whole run that blocks the window
+int ReservationCalendar::search(int chamber, int from, int minutes, int watts, int latest) {
+    Timeline& slots = chambers_[static_cast<std::size_t>(chamber)];
+    int start = std::max(from, 0);
+    while (start <= latest) {
+        const int busy = slots.firstBelow(start, 1);
+        if (busy < start + minutes) {
+            start = slots.firstAtLeast(busy, 1);
+            continue;
+        }
+        const int lacking = power_.firstBelow(start, watts);
+        if (lacking < start + minutes) {
+            start = power_.firstAtLeast(lacking, watts);
+            continue;
+        }
+        return start;
+    }
+    return -1;
+}
+
+int ReservationCalendar::earliestWindowAny(int from, int minutes, int watts, int& chamber) {
+    if (minutes <= 0) return -1;
+    int best = -1;
+    int latest = horizon() - minutes;
+    for (int c = 0; c < chambers(); ++c) {
+        const int start = search(c, from, minutes, watts, latest);   // later chambers only need to beat `best`
+        if (start < 0) continue;
+        best = start;
+        chamber = c;
+        if (best <= std::max(from, 0)) break;
+        latest = best - 1;
+    }
+    return best;
+}
+
+bool ReservationCalendar::fits(int chamber, int start, int minutes, int watts) {
+    if (chamber < 0 || chamber >= chambers() || minutes <= 0 || start < 0 || start + minutes > horizon()) return false;
+    return chambers_[static_cast<std::size_t>(chamber)].min(start, start + minutes) >= 1 &&
+           power_.min(start, start + minutes) >= watts;
+}
+
+int ReservationCalendar::reserve(int chamber, int start, int minutes, int watts) {
+    if (!fits(chamber, start, minutes, watts)) return -1;
+    Reservation r;
+    r.id = static_cast<int>(reservations_.size());
+    r.chamber = chamber;
+    r.start = start;
+    r.end = start + minutes;
+    r.watts = watts;
+    chambers_[static_cast<std::size_t>(chamber)].add(r.start, r.end, -1);
+    power_.add(r.start, r.end, -watts);
+    bookings_[static_cast<std::size_t>(chamber)].emplace(r.start, r.id);
+    reservations_.push_back(r);
+    active_++;
+    return r.id;
+}
+
+bool ReservationCalendar::cancel(int id) {
+    if (id < 0 || id >= static_cast<int>(reservations_.size())) return false;
+    Reservation& r = reservations_[static_cast<std::size_t>(id)];
+    if (r.id < 0) return false;
+    chambers_[static_cast<std::size_t>(r.chamber)].add(r.start, r.end, 1);
+    power_.add(r.start, r.end, r.watts);
+    bookings_[static_cast<std::size_t>(r.chamber)].erase(r.start);
+    r.id = -1;
+    active_--;
+    return true;
+}
+
+const Reservation* ReservationCalendar::occupant(int chamber, int minute) const {
+    if (chamber < 0 || chamber >= chambers()) return nullptr;
+    const auto& booked = bookings_[static_cast<std::size_t>(chamber)];
+    auto it = booked.upper_bound(minute);
+    if (it == booked.begin()) return nullptr;
+    --it;
+    const Reservation& r = reservations_[static_cast<std::size_t>(it->second)];
+    return minute < r.end ? &r : nullptr;
+}
+
+}  // namespace plan
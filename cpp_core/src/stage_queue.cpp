@@ -0,0 +1,112 @@
+#include "StageQueue.hpp"
+#include <algorithm>
+#include "AllocTracker.hpp"
+
+void StageQueue::push(Task* task) {
+    SF_ALLOC_SCOPE(alloc::Tag::Queue);
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    tasks_.push_back(Entry{task, task->readyMinute});
+    stats_.pushed++;
+    stats_.highWater = std::max(stats_.highWater, tasks_.size());
+}
+
+bool StageQueue::tryPush(Task* task, int t) {
+    SF_ALLOC_SCOPE(alloc::Tag::Queue);
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    if (full()) {
+        stats_.rejected++;
+        return false;
+    }
+    tasks_.push_back(Entry{task, t});
+    stats_.pushed++;
+    stats_.highWater = std::max(stats_.highWater, tasks_.size());
+    return true;
+}
+
+void StageQueue::setDispatch(Dispatch dispatch) {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    dispatch_ = dispatch;
+}
+
+Task* StageQueue::tryPop() {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    if (tasks_.empty()) return nullptr;
+    auto next = tasks_.begin();
+    if (dispatch_ == Dispatch::CriticalPath) {
+        // linear scan: the queue holds the released WIP, not the whole order book
+        for (auto it = tasks_.begin() + 1; it != tasks_.end(); ++it) {
+            const Task& a = *it->task;
+            const Task& b = *next->task;
+            if (a.dispatchSlack < b.dispatchSlack || (a.dispatchSlack == b.dispatchSlack && a.dispatchTail > b.dispatchTail)) {
+                next = it;
+            }
+        }
+    }
+    Task* task = next->task;
+    tasks_.erase(next);
+    stats_.popped++;
+    return task;
+}
+
+bool StageQueue::remove(Task* task) {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    const auto it = std::find_if(tasks_.begin(), tasks_.end(), [task](const Entry& e) { return e.task == task; });
+    if (it == tasks_.end()) return false;
+    tasks_.erase(it);
+    stats_.popped++;
+    return true;
+}
+
+bool StageQueue::empty() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return tasks_.empty();
+}
+
+std::size_t StageQueue::size() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return tasks_.size();
+}
+
+std::vector<Task*> StageQueue::front(std::size_t n) const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    const std::size_t count = std::min(n, tasks_.size());
+    std::vector<Task*> out;
+    out.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) out.push_back(tasks_[i].task);
+    return out;
+}
+
+int StageQueue::oldestSince() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    int oldest = -1;
+    for (const Entry& e : tasks_) {
+        if (oldest < 0 || e.since < oldest) oldest = e.since;
+    }
+    return oldest;
+}
+
+std::size_t StageQueue::expire(int t, std::vector<Task*>* scrapped) {
+    if (config_.maxDwellMinutes <= 0) return 0;
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    std::size_t expired = 0;
+    while (!tasks_.empty() && t - tasks_.front().since > config_.maxDwellMinutes) {
+        tasks_.front().task->scrapped = true;
+        if (scrapped) scrapped->push_back(tasks_.front().task);
+        tasks_.pop_front();
+        expired++;
+    }
+    stats_.expired += expired;
+    return expired;
+}
+
+void StageQueue::sample() {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    stats_.occupancyArea += static_cast<long long>(tasks_.size());
+    if (full()) stats_.fullMinutes++;
+    stats_.samples++;
+}
+
+BufferStats StageQueue::stats() const {
+    std::lock_guard<ProfiledMutex> lock(mutex_);
+    return stats_;
+}
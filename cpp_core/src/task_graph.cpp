@@ -0,0 +1,232 @@
+#include "TaskGraph.hpp"
+
+#include <algorithm>
+
+namespace lots {
+
+int TaskGraph::remainingWork(const Task& task) {
+    int minutes = 0;
+    for (const auto& phase : task.phase) minutes += phase.timeRemaining();
+    return minutes;
+}
+
+bool TaskGraph::build(const std::vector<Task*>& tasks, std::string& error) {
+    nodes_.clear();
+    lots_.clear();
+    index_.clear();
+    edges_ = 0;
+
+    std::unordered_map<std::string, int> byId;
+    std::unordered_map<std::string, int> byLot;
+    for (Task* task : tasks) {
+        const int n = static_cast<int>(nodes_.size());
+        if (!byId.emplace(task->id, n).second) {
+            error = "duplicate task id " + task->id;
+            return false;
+        }
+        const std::string& lotName = task->lot.empty() ? task->id : task->lot;
+        const auto lot = byLot.emplace(lotName, static_cast<int>(lots_.size()));
+        if (lot.second) {
+            lots_.emplace_back();
+            lots_.back().name = lotName;
+        }
+        Node node;
+        node.task = task;
+        node.lot = lot.first->second;
+        node.rem = remainingWork(*task);
+        lots_[static_cast<std::size_t>(node.lot)].nodes.push_back(n);
+        nodes_.push_back(node);
+        index_.emplace(task, n);
+    }
+
+    for (std::size_t v = 0; v < nodes_.size(); ++v) {
+        for (const std::string& predId : nodes_[v].task->after) {
+            const auto it = byId.find(predId);
+            if (it == byId.end()) {
+                error = nodes_[v].task->id + " waits for unknown task " + predId;
+                return false;
+            }
+            nodes_[static_cast<std::size_t>(it->second)].succs.push_back(static_cast<int>(v));
+            nodes_[v].preds.push_back(it->second);
+            edges_++;
+        }
+        nodes_[v].waitingOn = static_cast<int>(nodes_[v].preds.size());
+    }
+
+    // Kahn's order: finds cycles, then heads forward and tails backward in one pass each
+    std::vector<int> order;
+    order.reserve(nodes_.size());
+    std::vector<int> indegree(nodes_.size());
+    for (std::size_t v = 0; v < nodes_.size(); ++v) {
+        indegree[v] = nodes_[v].waitingOn;
+        if (indegree[v] == 0) order.push_back(static_cast<int>(v));
+    }
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        for (int s : nodes_[static_cast<std::size_t>(order[i])].succs) {
+            if (--indegree[static_cast<std::size_t>(s)] == 0) order.push_back(s);
+        }
+    }
+    if (order.size() != nodes_.size()) {
+        for (std::size_t v = 0; v < nodes_.size(); ++v) {
+            if (indegree[v] > 0) {
+                error = "precedence cycle through " + nodes_[v].task->id;
+                return false;
+            }
+        }
+    }
+    for (int v : order) {
+        Node& node = nodes_[static_cast<std::size_t>(v)];
+        for (int p : node.preds) {
+            const Node& pred = nodes_[static_cast<std::size_t>(p)];
+            node.head = std::max(node.head, pred.head + pred.rem);
+        }
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        Node& node = nodes_[static_cast<std::size_t>(*it)];
+        int after = 0;
+        for (int s : node.succs) after = std::max(after, nodes_[static_cast<std::size_t>(s)].tail);
+        node.tail = node.rem + after;
+    }
+
+    for (Node& node : nodes_) {
+        if (node.waitingOn > 0) continue;
+        node.state = State::Ready;
+        int& firstReady = lots_[static_cast<std::size_t>(node.lot)].firstReady;
+        firstReady = firstReady < 0 ? node.task->readyMinute : std::min(firstReady, node.task->readyMinute);
+    }
+    for (std::size_t l = 0; l < lots_.size(); ++l) {
+        refreshLot(static_cast<int>(l));
+        lots_[l].nominalCriticalPath = lots_[l].criticalPath;
+    }
+    work_.reserve(nodes_.size());
+    return true;
+}
+
+std::vector<Task*> TaskGraph::initiallyReady() const {
+    std::vector<Task*> ready;
+    for (const Node& node : nodes_) {
+        if (node.state == State::Ready) ready.push_back(node.task);
+    }
+    return ready;
+}
+
+void TaskGraph::complete(Task* task, int t, std::vector<Task*>& released) {
+    const auto it = index_.find(task);
+    if (it == index_.end()) return;
+    const int v = it->second;
+    Node& node = nodes_[static_cast<std::size_t>(v)];
+    if (node.state == State::Done || node.state == State::Cancelled) return;
+
+    node.state = State::Done;
+    node.rem = 0;
+    Lot& lot = lots_[static_cast<std::size_t>(node.lot)];
+    lot.done++;
+    lot.lastCompletion = std::max(lot.lastCompletion, t);
+
+    if (task->failed()) {
+        for (int s : node.succs) cancelFrom(s);   // a failed test wafer stops what it gates
+    } else {
+        for (int s : node.succs) {
+            Node& succ = nodes_[static_cast<std::size_t>(s)];
+            if (succ.state == State::Held && --succ.waitingOn == 0) {
+                succ.state = State::Ready;
+                succ.task->readyMinute = t;
+                succ.task->releasedMinute = t;
+                released.push_back(succ.task);
+                int& firstReady = lots_[static_cast<std::size_t>(succ.lot)].firstReady;
+                if (firstReady < 0) firstReady = t;   // a lot gated entirely by another lot
+            }
+        }
+    }
+
+    propagateTails(v);
+    propagateHeads(v);
+    refreshLot(node.lot);
+    for (int s : node.succs) {
+        const int succLot = nodes_[static_cast<std::size_t>(s)].lot;
+        if (succLot != node.lot) refreshLot(succLot);
+    }
+}
+
+void TaskGraph::cancelFrom(int from) {
+    work_.clear();
+    work_.push_back(from);
+    while (!work_.empty()) {
+        const int v = work_.back();
+        work_.pop_back();
+        Node& node = nodes_[static_cast<std::size_t>(v)];
+        if (node.state == State::Cancelled || node.state == State::Done) continue;
+        node.state = State::Cancelled;
+        node.rem = node.head = node.tail = 0;
+        lots_[static_cast<std::size_t>(node.lot)].cancelled++;
+        for (int s : node.succs) work_.push_back(s);
+    }
+}
+
+// Tails only shrink as work finishes: walk up from `from` while they change
+void TaskGraph::propagateTails(int from) {
+    work_.clear();
+    work_.push_back(from);
+    bool first = true;
+    while (!work_.empty()) {
+        const int v = work_.back();
+        work_.pop_back();
+        Node& node = nodes_[static_cast<std::size_t>(v)];
+        int after = 0;
+        for (int s : node.succs) after = std::max(after, nodes_[static_cast<std::size_t>(s)].tail);
+        const int tail = node.state == State::Cancelled ? 0 : node.rem + after;
+        if (tail == node.tail && !first) continue;
+        node.tail = tail;
+        first = false;
+        for (int p : node.preds) work_.push_back(p);
+    }
+}
+
+// Heads of the successors: walk down from `from` while they change
+void TaskGraph::propagateHeads(int from) {
+    work_.clear();
+    for (int s : nodes_[static_cast<std::size_t>(from)].succs) work_.push_back(s);
+    while (!work_.empty()) {
+        const int v = work_.back();
+        work_.pop_back();
+        Node& node = nodes_[static_cast<std::size_t>(v)];
+        if (node.state == State::Cancelled) continue;
+        int head = 0;
+        for (int p : node.preds) {
+            const Node& pred = nodes_[static_cast<std::size_t>(p)];
+            if (pred.state != State::Cancelled) head = std::max(head, pred.head + pred.rem);
+        }
+        if (head == node.head) continue;
+        node.head = head;
+        for (int s : node.succs) work_.push_back(s);
+    }
+}
+
+void TaskGraph::refreshLot(int l) {
+    Lot& lot = lots_[static_cast<std::size_t>(l)];
+    lot.criticalPath = 0;
+    for (int v : lot.nodes) {
+        const Node& node = nodes_[static_cast<std::size_t>(v)];
+        if (node.state == State::Held || node.state == State::Ready) {
+            lot.criticalPath = std::max(lot.criticalPath, node.head + node.tail);
+        }
+    }
+    for (int v : lot.nodes) {
+        Node& node = nodes_[static_cast<std::size_t>(v)];
+        if (node.state != State::Held && node.state != State::Ready) continue;
+        node.task->dispatchSlack = lot.criticalPath - node.head - node.tail;
+        node.task->dispatchTail = node.tail;
+    }
+}
+
+void TaskGraph::report(std::ostream& out) const {
+    out << "\nLot | Wafers | Done | Cancelled | Critical path (nominal min) | Makespan (min)\n";
+    for (const Lot& lot : lots_) {
+        const int size = static_cast<int>(lot.nodes.size());
+        out << lot.name << " | " << size << " | " << lot.done << " | " << lot.cancelled << " | " << lot.nominalCriticalPath << " | ";
+        if (lot.done + lot.cancelled < size) out << "open (" << size - lot.done - lot.cancelled << " left)\n";
+        else out << lot.lastCompletion - std::max(0, lot.firstReady) << "\n";
+    }
+}
+
+}  // namespace lots
@@ -0,0 +1,98 @@
+#include "ThreadUsage.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <mutex>
+
+namespace usage {
+namespace {
+
+// written by the owning thread only; atomics so threads() may read while the run is going
+struct Slot {
+    std::string name;
+    std::int64_t wallStartNs = 0;
+    std::uint64_t cpuStartNs = 0;
+    std::atomic<std::uint64_t> wallNs{0};
+    std::atomic<std::uint64_t> cpuNs{0};
+    std::atomic<std::uint64_t> tickWaitNs{0};
+    std::atomic<std::uint64_t> lockWaitNs{0};
+    std::atomic<bool> finished{false};
+};
+
+std::mutex registryMutex;
+std::deque<Slot> slots;             // deque: references stay valid as threads register
+thread_local Slot* self = nullptr;
+
+std::int64_t monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void add(std::atomic<std::uint64_t>& field, std::uint64_t ns) {
+    // single writer: a load + store is enough and avoids a locked RMW per wait
+    field.store(field.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+std::uint64_t threadCpuNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000ull + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+void beginThread(const std::string& name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    slots.emplace_back();
+    self = &slots.back();
+    self->name = name;
+    self->wallStartNs = monotonicNs();
+    self->cpuStartNs = threadCpuNs();
+}
+
+void endThread() {
+    if (!self) return;
+    self->wallNs.store(static_cast<std::uint64_t>(monotonicNs() - self->wallStartNs), std::memory_order_relaxed);
+    self->cpuNs.store(threadCpuNs() - self->cpuStartNs, std::memory_order_relaxed);
+    self->finished.store(true, std::memory_order_release);
+    self = nullptr;
+}
+
+void addTickWait(std::uint64_t ns) {
+    if (self) add(self->tickWaitNs, ns);
+}
+
+void addLockWait(std::uint64_t ns) {
+    if (self) add(self->lockWaitNs, ns);
+}
+
+std::vector<ThreadStats> threads() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<ThreadStats> out;
+    out.reserve(slots.size());
+    for (const Slot& s : slots) {
+        ThreadStats st;
+        st.name = s.name;
+        if (s.finished.load(std::memory_order_acquire)) {
+            st.wallNs = s.wallNs.load(std::memory_order_relaxed);
+            st.cpuNs  = s.cpuNs.load(std::memory_order_relaxed);
+        } else {
+            // still running: wall time so far; another thread's CPU clock is not readable here
+            st.wallNs = static_cast<std::uint64_t>(monotonicNs() - s.wallStartNs);
+        }
+        st.tickWaitNs = s.tickWaitNs.load(std::memory_order_relaxed);
+        st.lockWaitNs = s.lockWaitNs.load(std::memory_order_relaxed);
+        out.push_back(std::move(st));
+    }
+    return out;
+}
+
+TickWait::TickWait() : startNs_(self ? monotonicNs() : 0) {}
+
+TickWait::~TickWait() {
+    if (self) add(self->tickWaitNs, static_cast<std::uint64_t>(monotonicNs() - startNs_));
+}
+
+}  // namespace usage
@@ -0,0 +1,57 @@
+#include "TickBarrier.hpp"
+#include "Trace.hpp"
+#include "ThreadUsage.hpp"
+
+TickBarrier::TickBarrier(int workers) : workers_(workers) {}
+
+void TickBarrier::publish() {
+    SF_TRACE_SCOPE("tick.publish", "tick");
+    {
+        std::lock_guard<ProfiledMutex> lock(doneMutex_);
+        done_ = 0;
+    }
+    {
+        std::lock_guard<ProfiledMutex> lock(tickMutex_);
+        tick_.fetch_add(1, std::memory_order_release);
+    }
+    tickCv_.notify_all();
+}
+
+void TickBarrier::waitAll() {
+    SF_TRACE_SCOPE("tick.waitAll", "tick");
+    usage::TickWait blocked;
+    std::unique_lock<ProfiledMutex::lock_type> lock(doneMutex_);
+    doneCv_.wait(lock, [&]() { return done_ == workers_; });
+}
+
+void TickBarrier::stop() {
+    {
+        std::lock_guard<ProfiledMutex> lock(tickMutex_);
+        running_.store(false, std::memory_order_release);
+    }
+    tickCv_.notify_all();
+}
+
+bool TickBarrier::waitForTick(int& seen) {
+    SF_TRACE_SCOPE("tick.wait", "tick");   // ends when this worker is actually running again
+    usage::TickWait blocked;
+    std::unique_lock<ProfiledMutex::lock_type> lock(tickMutex_);
+
+    // Wait until either shutdown requested or a NEW tick is available.
+    tickCv_.wait(lock, [&]() {
+        return !running_.load(std::memory_order_acquire) || tick_.load(std::memory_order_acquire) > seen;
+    });
+    if (!running_.load(std::memory_order_acquire)) return false;
+
+    // Advance the watermark so one notify → at most one update call.
+    seen = tick_.load(std::memory_order_relaxed);
+    return true;
+}
+
+void TickBarrier::arrive() {
+    {
+        std::lock_guard<ProfiledMutex> lock(doneMutex_);
+        ++done_;
+    }
+    doneCv_.notify_one();
+}
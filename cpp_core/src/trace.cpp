@@ -0,0 +1,123 @@
+#include "Trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+namespace {
+
+struct Event {
+    const char* name;
+    const char* category;
+    std::uint64_t beginNs;
+    std::uint64_t durationNs;
+};
+
+// written only by its owning thread; `size` is published with release so a reader sees whole events
+struct ThreadBuffer {
+    int tid = 0;
+    std::string name;
+    std::unique_ptr<Event[]> events{new Event[EVENTS_PER_THREAD]};
+    std::atomic<std::size_t> size{0};
+    std::atomic<std::size_t> dropped{0};
+};
+
+const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+
+// registration is the only locked step, once per thread
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+ThreadBuffer& localBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::make_unique<ThreadBuffer>());
+        buffer = registry.back().get();
+        buffer->tid = static_cast<int>(registry.size());
+        buffer->name = "thread " + std::to_string(buffer->tid);
+    }
+    return *buffer;
+}
+
+void writeEscaped(std::ostream& out, const std::string& s) {
+    for (char c : s) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+}
+
+}  // namespace
+
+std::uint64_t nowNs() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - processStart).count());
+}
+
+void record(const char* name, const char* category, std::uint64_t beginNs, std::uint64_t endNs) {
+    ThreadBuffer& buffer = localBuffer();
+    const std::size_t n = buffer.size.load(std::memory_order_relaxed);
+    if (n >= EVENTS_PER_THREAD) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[n] = Event{name, category, beginNs, endNs - beginNs};
+    buffer.size.store(n + 1, std::memory_order_release);
+}
+
+void setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);   // the writer may read names concurrently
+    buffer.name = name;
+}
+
+std::size_t droppedEvents() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::size_t dropped = 0;
+    for (const auto& buffer : registry) dropped += buffer->dropped.load(std::memory_order_relaxed);
+    return dropped;
+}
+
+bool writeChromeJson(const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "[trace] Could not open " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << std::fixed << std::setprecision(3);
+    bool first = true;
+    std::size_t dropped = 0;
+    for (const auto& buffer : registry) {
+        out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->tid
+            << ",\"args\":{\"name\":\"";
+        writeEscaped(out, buffer->name);
+        out << "\"}}";
+        first = false;
+
+        const std::size_t n = buffer->size.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < n; ++i) {
+            const Event& e = buffer->events[i];
+            out << ",\n{\"ph\":\"X\",\"name\":\"" << e.name << "\",\"cat\":\"" << e.category
+                << "\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"ts\":" << e.beginNs / 1000.0 << ",\"dur\":" << e.durationNs / 1000.0 << "}";
+        }
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    out << "\n]}\n";
+
+    std::cout << "[trace] Wrote " << path << " (" << registry.size() << " threads";
+    if (dropped) std::cout << ", " << dropped << " spans dropped: buffer full";
+    std::cout << ")" << std::endl;
+    return true;
+}
+
+}  // namespace trace
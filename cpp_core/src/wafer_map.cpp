@@ -0,0 +1,199 @@
+#include "WaferMap.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// true for cells whose centre lies on the wafer disc (same binning as the tracer)
+struct DiscMask {
+    bool inside[WAFER_MAP_CELLS];
+    int  count = 0;
+    DiscMask() {
+        for (int row = 0; row < WAFER_MAP_N; ++row) {
+            for (int col = 0; col < WAFER_MAP_N; ++col) {
+                const double u = (col + 0.5) / WAFER_MAP_N * 2.0 - 1.0;
+                const double v = (row + 0.5) / WAFER_MAP_N * 2.0 - 1.0;
+                inside[row * WAFER_MAP_N + col] = (u * u + v * v) <= 1.0;
+                count += inside[row * WAFER_MAP_N + col];
+            }
+        }
+    }
+};
+
+const DiscMask& discMask() {
+    static const DiscMask mask;
+    return mask;
+}
+
+// y += a · x  over n floats
+void axpy(float* y, const float* x, float a, int n) {
+    int i = 0;
+#if defined(__AVX__)
+    const __m256 va = _mm256_set1_ps(a);
+    for (; i + 8 <= n; i += 8) {
+        const __m256 vy = _mm256_loadu_ps(y + i);
+        const __m256 vx = _mm256_loadu_ps(x + i);
+        _mm256_storeu_ps(y + i, _mm256_add_ps(vy, _mm256_mul_ps(va, vx)));
+    }
+#elif defined(__SSE2__)
+    const __m128 va = _mm_set1_ps(a);
+    for (; i + 4 <= n; i += 4) {
+        const __m128 vy = _mm_loadu_ps(y + i);
+        const __m128 vx = _mm_loadu_ps(x + i);
+        _mm_storeu_ps(y + i, _mm_add_ps(vy, _mm_mul_ps(va, vx)));
+    }
+#endif
+    for (; i < n; ++i) y[i] += a * x[i];
+}
+
+}  // namespace
+
+/* ---------- FluxMap ---------- */
+
+FluxMap FluxMap::uniform() {
+    FluxMap f;
+    const DiscMask& mask = discMask();
+    for (int k = 0; k < WAFER_MAP_CELLS; ++k) {
+        f.depositionProfile[k] = mask.inside[k] ? 1.0f : 0.0f;
+        f.contaminationRate[k] = 0.0f;
+    }
+    return f;
+}
+
+FluxMap FluxMap::radial(double sourceHeight) {
+    FluxMap f = uniform();
+    const DiscMask& mask = discMask();
+    const double h2 = std::max(sourceHeight * sourceHeight, 1e-12);
+    double sum = 0.0;
+    for (int row = 0; row < WAFER_MAP_N; ++row) {
+        for (int col = 0; col < WAFER_MAP_N; ++col) {
+            const int k = row * WAFER_MAP_N + col;
+            if (!mask.inside[k]) continue;
+            const double u = (col + 0.5) / WAFER_MAP_N * 2.0 - 1.0;
+            const double v = (row + 0.5) / WAFER_MAP_N * 2.0 - 1.0;
+            const double falloff = 1.0 + (u * u + v * v) / h2;
+            f.depositionProfile[k] = static_cast<float>(1.0 / (falloff * falloff));
+            sum += f.depositionProfile[k];
+        }
+    }
+    const double scale = mask.count / sum;   // mean 1.0 over the disc
+    for (int k = 0; k < WAFER_MAP_CELLS; ++k)
+        f.depositionProfile[k] = static_cast<float>(f.depositionProfile[k] * scale);
+    return f;
+}
+
+FluxMap FluxMap::fromTrace(const wake::TraceResult& trace, double sourceHeight) {
+    FluxMap f = radial(sourceHeight);
+
+    // waferFluxM2s is the disc average; spread it over the cells in proportion to hits
+    std::uint64_t totalHits = 0;
+    for (auto h : trace.grid) totalHits += h;
+    if (totalHits == 0) return f;
+
+    const double perMinute = trace.waferFluxM2s * 60.0 * discMask().count;
+    for (int k = 0; k < WAFER_MAP_CELLS; ++k)
+        f.contaminationRate[k] = static_cast<float>(perMinute * trace.grid[k] / static_cast<double>(totalHits));
+    return f;
+}
+
+FluxMap FluxMap::fromShield(std::uint64_t rays) {
+    return fromTrace(wake::traceBatch(wafermap::shieldScene(), rays, 1));
+}
+
+/* ---------- WaferMapArena ---------- */
+
+WaferMapArena::WaferMapArena(std::size_t capacity, std::size_t slabSize)
+    : capacity_(capacity), slabSize_(std::max<std::size_t>(slabSize, 1)) {
+    free_.reserve(capacity_);
+}
+
+WaferMap* WaferMapArena::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (free_.empty()) {
+        if (allocated_ >= capacity_) return nullptr;
+        const std::size_t n = std::min(slabSize_, capacity_ - allocated_);
+        slabs_.emplace_back(new WaferMap[n]);
+        for (std::size_t i = n; i-- > 0;) free_.push_back(&slabs_.back()[i]);
+        allocated_ += n;
+    }
+
+    WaferMap* map = free_.back();
+    free_.pop_back();
+    std::memset(map, 0, sizeof(WaferMap));
+    return map;
+}
+
+void WaferMapArena::release(WaferMap* map) {
+    if (!map) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(map);
+}
+
+std::size_t WaferMapArena::inUse() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocated_ - free_.size();
+}
+
+/* ---------- per-minute update + phase-end metrics ---------- */
+
+namespace wafermap {
+
+void accumulateMinute(WaferMap& map, const FluxMap& flux, float depositionRateNm, bool powered) {
+    if (powered) axpy(map.thickness, flux.depositionProfile, depositionRateNm, WAFER_MAP_CELLS);
+    axpy(map.contamination, flux.contaminationRate, 1.0f, WAFER_MAP_CELLS);
+}
+
+void accumulateMinutes(WaferMap& map, const FluxMap& flux, float depositionRateNm, int minutes) {
+    const float n = static_cast<float>(minutes);
+    axpy(map.thickness, flux.depositionProfile, depositionRateNm * n, WAFER_MAP_CELLS);
+    axpy(map.contamination, flux.contaminationRate, n, WAFER_MAP_CELLS);
+}
+
+WaferMapStats summarize(const WaferMap& map) {
+    const DiscMask& mask = discMask();
+    WaferMapStats s;
+
+    double sum = 0.0, sumSq = 0.0;
+    double lo = std::numeric_limits<double>::max(), hi = 0.0;
+    for (int k = 0; k < WAFER_MAP_CELLS; ++k) {
+        if (!mask.inside[k]) continue;
+        const double t = map.thickness[k];
+        sum += t; sumSq += t * t;
+        lo = std::min(lo, t); hi = std::max(hi, t);
+
+        const double c = map.contamination[k];
+        s.peakContamination = std::max(s.peakContamination, c);
+        if (c > CONTAMINATION_LIMIT_M2) s.contaminatedCells++;
+    }
+
+    const double n = static_cast<double>(mask.count);
+    s.meanThickness   = sum / n;
+    s.thicknessStdDev = std::sqrt(std::max(0.0, sumSq / n - s.meanThickness * s.meanThickness));
+    s.nonUniformity   = s.meanThickness > 0.0 ? (hi - lo) / (2.0 * s.meanThickness) : 0.0;
+    s.contaminatedFraction = s.contaminatedCells / n;
+    return s;
+}
+
+wake::Scene shieldScene() {
+    wake::Scene scene;
+    wake::makeScene("cupola", 1.9148959878712615, 1.0, "specular", -1.007894199459988,
+                    -0.015594969387128656, 0.01615069021371253, "WakeCone", 0.15, scene);
+    return scene;
+}
+
+double meanContamination(const FluxMap& flux) {
+    const DiscMask& mask = discMask();
+    double sum = 0.0;
+    for (int k = 0; k < WAFER_MAP_CELLS; ++k)
+        if (mask.inside[k]) sum += flux.contaminationRate[k];
+    return sum / mask.count;
+}
+
+}  // namespace wafermap
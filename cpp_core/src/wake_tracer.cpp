@@ -0,0 +1,415 @@
+#include "WakeTracer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+
+// Line-for-line port of monte-carlo-sim/physics.py::trace_batch.
+// The Python works on (N,3) arrays; here each ray is traced to completion and
+// the per-ray results are folded into a per-thread accumulator.
+
+namespace wake {
+
+namespace {
+
+/* ---------- physical constants (physics.py) ---------- */
+constexpr double PI             = 3.14159265358979323846;
+constexpr double K_B            = 1.380649e-23;     // J/K
+constexpr double T_EXO          = 1000.0;           // K
+constexpr double ORBITAL_VEL    = 7'700.0;          // m/s
+constexpr double ATT_JITTER_DEG = 0.3;              // 1 sigma attitude jitter
+constexpr double AMU            = 1.66053906660e-27;
+
+struct Species { double mass; double density; };   // kg, #/m^3
+constexpr Species SPECIES[] = {
+    {16 * AMU, 5.0e8 * 1e6},    // O
+    {32 * AMU, 1.2e7 * 1e6},    // O2
+    {28 * AMU, 1.0e8 * 1e6},    // N2
+    {16 * AMU, 1.0e5 * 1e6},    // O+
+    {32 * AMU, 1.0e4 * 1e6},    // O2+
+};
+constexpr int N_SPECIES = sizeof(SPECIES) / sizeof(SPECIES[0]);
+
+constexpr std::uint64_t CHUNK_RAYS = 4096;          // rays per RNG stream
+
+struct Vec3 { double x, y, z; };
+
+inline Vec3   operator+(Vec3 a, Vec3 b)    { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline Vec3   operator-(Vec3 a, Vec3 b)    { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline Vec3   operator*(Vec3 a, double s)  { return {a.x * s, a.y * s, a.z * s}; }
+inline double dot(Vec3 a, Vec3 b)          { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3   cross(Vec3 a, Vec3 b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+inline Vec3   normalized(Vec3 a)           { return a * (1.0 / std::sqrt(dot(a, a))); }
+
+inline std::uint64_t splitmix64(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/* ---------- scene constants hoisted out of the per-ray loop ---------- */
+struct Prepared {
+    Scene scene;
+    double rMax = 0.0;                       // launch disc radius
+    double speciesCdf[N_SPECIES] = {};
+    double speciesSigma[N_SPECIES] = {};
+    // cap
+    double capR = 0.0;
+    // pyramid
+    double pyrHalfBase = 0.0;
+    Vec3   pyrN[4] = {};                     // outward normals (+Z side)
+    double pyrSlope = 0.0;
+    // cupola
+    Vec3   cupN[10] = {};
+    double cupD[10] = {};
+};
+
+// _j5_planes(a) – 5 square + 5 triangular walls of a Johnson J5 cupola
+void buildCupola(Prepared& p, double a) {
+    const double rP = a / (2.0 * std::sin(PI / 5.0));
+    const double rD = a / (2.0 * std::sin(PI / 10.0));
+    Vec3 verts[15];
+    for (int i = 0; i < 5; ++i) {
+        const double phi = PI / 2.0 + 2.0 * PI * i / 5.0;
+        verts[i] = {rP * std::cos(phi), rP * std::sin(phi), 0.0};
+        const double lo = phi - 18.0 * PI / 180.0;
+        const double hi = phi + 18.0 * PI / 180.0;
+        verts[5 + 2 * i]     = {rD * std::cos(lo), rD * std::sin(lo), -a};
+        verts[5 + 2 * i + 1] = {rD * std::cos(hi), rD * std::sin(hi), -a};
+    }
+    for (int f = 0; f < 10; ++f) {
+        int i0, i1, i2;
+        if (f < 5) { const int i = f;     i0 = i; i1 = (i + 1) % 5; i2 = 5 + (2 * i + 1) % 10; }
+        else       { const int i = f - 5; i0 = i; i1 = 5 + 2 * i;   i2 = 5 + (2 * i + 1) % 10; }
+        Vec3 n = normalized(cross(verts[i1] - verts[i0], verts[i2] - verts[i0]));
+        if (n.z < 0) n = n * -1.0;
+        p.cupN[f] = n;
+        p.cupD[f] = dot(n, verts[i0]);
+    }
+}
+
+Prepared prepare(const Scene& scene) {
+    Prepared p;
+    p.scene = scene;
+    p.rMax  = scene.shield.primaryDim * 1.2;
+
+    double total = 0.0;
+    for (const auto& s : SPECIES) total += s.density;
+    double acc = 0.0;
+    for (int k = 0; k < N_SPECIES; ++k) {
+        acc += SPECIES[k].density / total;
+        p.speciesCdf[k]   = acc;
+        p.speciesSigma[k] = std::sqrt(K_B * T_EXO / SPECIES[k].mass);
+    }
+    p.speciesCdf[N_SPECIES - 1] = 1.0;
+
+    const Shield& sh = scene.shield;
+    switch (sh.profile) {
+    case ShieldProfile::Cap:
+        p.capR = 1.0 / sh.shapeParam;
+        if (sh.primaryDim > p.capR) p.capR = sh.primaryDim * 0.99;
+        break;
+    case ShieldProfile::Pyramid: {
+        const double h = sh.primaryDim * std::max(sh.shapeParam, 0.3);
+        p.pyrHalfBase = sh.primaryDim;
+        p.pyrSlope    = p.pyrHalfBase / h;
+        const double s = p.pyrSlope;
+        p.pyrN[0] = normalized({-s, 0.0, 1.0});
+        p.pyrN[1] = normalized({ s, 0.0, 1.0});
+        p.pyrN[2] = normalized({0.0, -s, 1.0});
+        p.pyrN[3] = normalized({0.0,  s, 1.0});
+        break;
+    }
+    case ShieldProfile::Cupola:
+        buildCupola(p, sh.primaryDim);
+        break;
+    case ShieldProfile::Flat:
+        break;
+    }
+    return p;
+}
+
+/**
+ * Shield hit for one ray. Returns false on a miss; on a hit fills point + normal.
+ */
+bool hitShield(const Prepared& p, Vec3 o, Vec3 d, Vec3& hit, Vec3& n) {
+    const Shield& sh = p.scene.shield;
+    switch (sh.profile) {
+    case ShieldProfile::Cap: {
+        const Vec3 c  = {0.0, 0.0, -p.capR};
+        const Vec3 oc = o - c;
+        const double b    = dot(oc, d);
+        const double disc = b * b - (dot(oc, oc) - p.capR * p.capR);
+        if (disc < 0.0) return false;
+        hit = o + d * (-b - std::sqrt(disc));
+        if (hit.x * hit.x + hit.y * hit.y > sh.primaryDim * sh.primaryDim) return false;
+        n = (hit - c) * (1.0 / p.capR);
+        return true;
+    }
+    case ShieldProfile::Flat: {
+        if (std::fabs(d.z) < 1e-8) return false;
+        const double t = -o.z / d.z;
+        if (t < 0.0) return false;
+        hit = o + d * t;
+        if (hit.x * hit.x + hit.y * hit.y > sh.primaryDim * sh.primaryDim) return false;
+        n = {0.0, 0.0, 1.0};
+        return true;
+    }
+    case ShieldProfile::Pyramid: {
+        const double s = p.pyrSlope, hb = p.pyrHalfBase;
+        const double planes[4][3] = {{-1, 0, s}, {1, 0, s}, {0, -1, s}, {0, 1, s}};
+        int best = -1;
+        double tBest = std::numeric_limits<double>::infinity();
+        for (int k = 0; k < 4; ++k) {
+            const Vec3 a = {planes[k][0], planes[k][1], planes[k][2]};
+            const double denom = dot(a, d);
+            if (std::fabs(denom) <= 1e-8) continue;
+            const double t = -dot(a, o) / denom;
+            if (!(t > 0.0) || t >= tBest) continue;
+            const Vec3 q = o + d * t;
+            if (std::fabs(q.x) <= hb && std::fabs(q.y) <= hb && q.z <= 0.0) {
+                best = k; tBest = t; hit = q;
+            }
+        }
+        if (best < 0) return false;
+        n = p.pyrN[best];
+        return true;
+    }
+    case ShieldProfile::Cupola: {
+        int best = -1;
+        double tBest = std::numeric_limits<double>::infinity();
+        for (int k = 0; k < 10; ++k) {
+            const double denom = dot(d, p.cupN[k]);
+            if (std::fabs(denom) <= 1e-8) continue;
+            const double t = (p.cupD[k] - dot(o, p.cupN[k])) / denom;
+            if (!(t > 0.0) || t >= tBest) continue;
+            const Vec3 q = o + d * t;
+            bool inside = true;
+            for (int j = 0; j < 10 && inside; ++j)
+                inside = dot(q, p.cupN[j]) - p.cupD[j] <= 1e-8;
+            if (inside) { best = k; tBest = t; hit = q; }
+        }
+        if (best < 0) return false;
+        n = p.cupN[best];
+        return true;
+    }
+    }
+    return false;
+}
+
+// rays_hit_infinite_cone with apex at the origin and axis (0,0,-1)
+bool hitsWakeCone(Vec3 o, Vec3 d, double cos2) {
+    const double dv = -d.z;
+    const double av = -o.z;
+    const double A = dv * dv - cos2 * dot(d, d);
+    const double B = dv * av - cos2 * dot(d, o);
+    const double C = av * av - cos2 * dot(o, o);
+    return (B * B - A * C >= 0.0) && (dv > 0.0);
+}
+
+struct Accum {
+    std::uint64_t hits = 0;          // shield hits
+    double deflSum = 0.0;
+    std::uint64_t waferHits = 0;
+    std::uint64_t wakeHits = 0;
+    double cosIncSum = 0.0;
+    WaferGrid grid{};
+
+    void merge(const Accum& o) {
+        hits += o.hits; deflSum += o.deflSum;
+        waferHits += o.waferHits; wakeHits += o.wakeHits;
+        cosIncSum += o.cosIncSum;
+        for (int i = 0; i < GRID_N * GRID_N; ++i) grid[i] += o.grid[i];
+    }
+};
+
+void traceChunk(const Prepared& p, std::uint64_t chunk, std::uint64_t count,
+                std::uint64_t seed, SamplingMode mode, Accum& acc) {
+    std::mt19937_64 rng(splitmix64(seed ^ splitmix64(chunk)));
+    std::uniform_real_distribution<double> U(0.0, 1.0);
+    std::normal_distribution<double> N01(0.0, 1.0);
+    const double jitter = ATT_JITTER_DEG * PI / 180.0;
+    const Wafer& wf = p.scene.wafer;
+    const double wr2 = wf.radius * wf.radius;
+
+    for (std::uint64_t i = 0; i < count; ++i) {
+        /* ---- sample_incident ---- */
+        double uR, uTheta;
+        if (mode == SamplingMode::Stratified) {
+            uR     = (static_cast<double>(i) + U(rng)) / static_cast<double>(count);
+            uTheta = std::fmod(static_cast<double>(i) * 0.6180339887498949 + U(rng), 1.0);
+        } else {
+            uTheta = U(rng);
+            uR     = U(rng);
+        }
+        const double theta = 2.0 * PI * uTheta;
+        const double r     = p.rMax * std::sqrt(uR);
+        const Vec3 pos = {r * std::cos(theta), r * std::sin(theta), 1.0};
+
+        const double pitch = N01(rng) * jitter;
+        const double yaw   = N01(rng) * jitter;
+        const double cy = std::cos(yaw);
+        const Vec3 flow = normalized({-std::sin(yaw), std::sin(pitch) * cy, -std::cos(pitch) * cy});
+
+        const double us = U(rng);
+        int sp = 0;
+        while (sp < N_SPECIES - 1 && us >= p.speciesCdf[sp]) ++sp;
+        const double sigma = p.speciesSigma[sp];
+        const Vec3 vel = flow * ORBITAL_VEL + Vec3{N01(rng) * sigma, N01(rng) * sigma, N01(rng) * sigma};
+        double speed = std::sqrt(dot(vel, vel));
+        if (!(speed > 0.0)) speed = 1e-12;
+        const Vec3 vIn = vel * (1.0 / speed);
+
+        /* ---- shield + outgoing ray ---- */
+        Vec3 rayPos = pos, rayDir = vIn, hit{}, n{};
+        if (hitShield(p, pos, vIn, hit, n)) {
+            Vec3 vOut;
+            if (p.scene.shield.coating == Coating::Specular) {
+                vOut = vIn - n * (2.0 * dot(vIn, n));
+            } else {
+                // cosine-weighted local direction rotated from +Z onto n (Rodrigues)
+                const double u1 = U(rng), u2 = U(rng);
+                const double lr = std::sqrt(u1), lt = 2.0 * PI * u2;
+                const Vec3 l = {lr * std::cos(lt), lr * std::sin(lt), std::sqrt(1.0 - u1)};
+                const Vec3 axis = cross({0.0, 0.0, 1.0}, n);
+                const double axisNorm = std::sqrt(dot(axis, axis));
+                const double cosA = n.z;
+                const double sinA = std::sqrt(std::clamp(1.0 - cosA * cosA, 0.0, 1.0));
+                const Vec3 k = axisNorm > 1e-8 ? axis * (1.0 / axisNorm) : Vec3{0.0, 0.0, 0.0};
+                vOut = l * cosA + cross(k, l) * sinA + k * (dot(k, l) * (1.0 - cosA));
+                if (axisNorm < 1e-8 && n.z < 0.0) vOut = vOut * -1.0;
+            }
+            rayPos = hit;
+            rayDir = vOut;
+            acc.hits++;
+            acc.deflSum += std::acos(std::clamp(-dot(vIn, vOut), -1.0, 1.0)) * 180.0 / PI;
+        }
+
+        /* ---- wafer ---- */
+        bool waferHit = false;
+        if (std::fabs(rayDir.z) >= 1e-8) {
+            const double t = (wf.zOffset - rayPos.z) / rayDir.z;
+            if (t >= 0.0) {
+                const double dx = rayPos.x + rayDir.x * t - wf.xOffset;
+                const double dy = rayPos.y + rayDir.y * t - wf.yOffset;
+                if (dx * dx + dy * dy <= wr2) {
+                    waferHit = true;
+                    const double u = (dx / wf.radius + 1.0) * 0.5;
+                    const double v = (dy / wf.radius + 1.0) * 0.5;
+                    const int col = std::clamp(static_cast<int>(u * GRID_N), 0, GRID_N - 1);
+                    const int row = std::clamp(static_cast<int>(v * GRID_N), 0, GRID_N - 1);
+                    acc.grid[row * GRID_N + col]++;
+                    acc.waferHits++;
+                    acc.cosIncSum += std::max(-rayDir.z, 0.0);
+                }
+            }
+        }
+
+        /* ---- wake intrusion ---- */
+        if (waferHit || hitsWakeCone(rayPos, rayDir, p.scene.wake.cos2)) acc.wakeHits++;
+    }
+}
+
+}  // namespace
+
+bool makeScene(const std::string& profile,
+               double primaryDim,
+               double shapeParam,
+               const std::string& coating,
+               double zOffset,
+               double xOffset,
+               double yOffset,
+               const std::string& wakeType,
+               double waferRadius,
+               Scene& out) {
+    Scene s;
+    if      (profile == "cap")     s.shield.profile = ShieldProfile::Cap;
+    else if (profile == "flat")    s.shield.profile = ShieldProfile::Flat;
+    else if (profile == "pyramid") s.shield.profile = ShieldProfile::Pyramid;
+    else if (profile == "cupola")  s.shield.profile = ShieldProfile::Cupola;
+    else return false;
+
+    if      (coating == "specular") s.shield.coating = Coating::Specular;
+    else if (coating == "diffuse")  s.shield.coating = Coating::Diffuse;
+    else return false;
+
+    s.shield.primaryDim = primaryDim;
+    s.shield.shapeParam = shapeParam;
+    s.wafer = {waferRadius, zOffset, xOffset, yOffset};
+
+    if (wakeType == "WakeCone") {
+        // half_angle = atan(dim / |z|)  ⇒  cos² = 1 / (1 + tan²)
+        const double tanA = primaryDim / std::fabs(zOffset);
+        s.wake = {WakeShape::Cone, 1.0 / (1.0 + tanA * tanA)};
+    } else if (wakeType == "PyramidWake") {
+        // half_base = dim, length = 10 × dim  ⇒  slope = 0.1
+        const double slope = 0.1;
+        s.wake = {WakeShape::Pyramid, 1.0 / (1.0 + slope * slope)};
+    } else {
+        return false;
+    }
+    out = s;
+    return true;
+}
+
+TraceResult traceBatch(const Scene& scene,
+                       std::uint64_t rays,
+                       std::uint64_t seed,
+                       SamplingMode mode,
+                       int threads) {
+    const Prepared p = prepare(scene);
+    const std::uint64_t chunks = (rays + CHUNK_RAYS - 1) / CHUNK_RAYS;
+    const int workers = static_cast<int>(std::min<std::uint64_t>(std::max(threads, 1), std::max<std::uint64_t>(chunks, 1)));
+
+    // chunks are claimed dynamically but results are merged in chunk order,
+    // so the floating-point sums do not depend on scheduling
+    std::vector<Accum> perChunk(chunks);
+    std::atomic<std::uint64_t> next(0);
+    auto worker = [&]() {
+        for (std::uint64_t c = next.fetch_add(1); c < chunks; c = next.fetch_add(1)) {
+            const std::uint64_t count = std::min(CHUNK_RAYS, rays - c * CHUNK_RAYS);
+            traceChunk(p, c, count, seed, mode, perChunk[c]);
+        }
+    };
+
+    if (workers <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> pool;
+        pool.reserve(workers);
+        for (int w = 0; w < workers; ++w) pool.emplace_back(worker);
+        for (auto& th : pool) th.join();
+    }
+
+    Accum total;
+    for (const auto& a : perChunk) total.merge(a);
+
+    TraceResult r;
+    r.rays = rays;
+    if (rays == 0) return r;
+    r.meanDeflectionDeg  = total.hits ? total.deflSum / static_cast<double>(total.hits) : 0.0;
+    r.hitRatio           = static_cast<double>(total.waferHits) / static_cast<double>(rays);
+    r.wakeIntrusionRatio = static_cast<double>(total.wakeHits)  / static_cast<double>(rays);
+
+    // flux: one launched sample stands for F0·A_src/N real particles per second
+    double nTotal = 0.0;
+    for (const auto& s : SPECIES) nTotal += s.density;
+    const double F0        = nTotal * ORBITAL_VEL;
+    const double aSrc      = PI * p.rMax * p.rMax;
+    const double perSample = F0 * aSrc / static_cast<double>(rays);
+    const double waferArea = PI * scene.wafer.radius * scene.wafer.radius;
+    r.waferFluxM2s = total.waferHits ? perSample * total.cosIncSum / waferArea : 0.0;
+    r.grid = total.grid;
+    return r;
+}
+
+const char* toString(SamplingMode mode) {
+    return mode == SamplingMode::Stratified ? "stratified" : "uniform";
+}
+
+}  // namespace wake
@@ -0,0 +1,263 @@
+#include "YieldAnalytics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <utility>
+
+namespace analytics {
+namespace {
+
+constexpr std::size_t MIN_LEVEL_CAPACITY = 8;
+constexpr double LEVEL_DECAY = 2.0 / 3.0;
+
+template <typename T>
+void put(std::vector<std::uint8_t>& out, T v) {
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(&v);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+bool get(const std::uint8_t*& p, const std::uint8_t* end, T& v) {
+    if (static_cast<std::size_t>(end - p) < sizeof(T)) return false;
+    std::memcpy(&v, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+}  // namespace
+
+/* ---------- KllSketch ---------- */
+
+KllSketch::KllSketch(int k) : k_(std::max(static_cast<int>(MIN_LEVEL_CAPACITY), k)) {
+    addLevel();
+}
+
+std::size_t KllSketch::capacity(std::size_t level) const {
+    const auto depth = static_cast<double>(levels_.size() - 1 - level);
+    const auto cap = static_cast<std::size_t>(std::ceil(k_ * std::pow(LEVEL_DECAY, depth)));
+    return std::max(MIN_LEVEL_CAPACITY, cap);
+}
+
+void KllSketch::addLevel() {
+    levels_.emplace_back();
+    levels_.back().reserve(static_cast<std::size_t>(k_) + 1);
+}
+
+std::size_t KllSketch::retained() const {
+    std::size_t items = 0;
+    for (const auto& level : levels_) items += level.size();
+    return items;
+}
+
+void KllSketch::add(double v) {
+    if (n_ == 0) {
+        min_ = max_ = v;
+    } else {
+        min_ = std::min(min_, v);
+        max_ = std::max(max_, v);
+    }
+    ++n_;
+    levels_[0].push_back(v);
+    if (levels_[0].size() >= capacity(0)) compress();
+}
+
+// Compact the lowest over-full level until the sketch is back under its total capacity
+void KllSketch::compress() {
+    for (;;) {
+        std::size_t items = 0, cap = 0;
+        for (std::size_t h = 0; h < levels_.size(); ++h) {
+            items += levels_[h].size();
+            cap += capacity(h);
+        }
+        if (items < cap) return;
+        for (std::size_t h = 0; h < levels_.size(); ++h) {
+            if (levels_[h].size() >= capacity(h)) {
+                compact(h);
+                break;
+            }
+        }
+    }
+}
+
+void KllSketch::compact(std::size_t level) {
+    if (level + 1 == levels_.size()) addLevel();
+    std::vector<double>& items = levels_[level];
+    std::sort(items.begin(), items.end());
+
+    coin_ ^= coin_ << 13;
+    coin_ ^= coin_ >> 7;
+    coin_ ^= coin_ << 17;
+    const std::size_t paired = items.size() & ~std::size_t(1);   // an odd one out stays here
+    std::vector<double>& up = levels_[level + 1];
+    for (std::size_t i = coin_ & 1; i < paired; i += 2) up.push_back(items[i]);
+    items.erase(items.begin(), items.begin() + static_cast<std::ptrdiff_t>(paired));
+}
+
+void KllSketch::merge(const KllSketch& other) {
+    if (other.n_ == 0) return;
+    if (n_ == 0) {
+        min_ = other.min_;
+        max_ = other.max_;
+    } else {
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+    n_ += other.n_;
+    while (levels_.size() < other.levels_.size()) addLevel();
+    for (std::size_t h = 0; h < other.levels_.size(); ++h) {
+        levels_[h].insert(levels_[h].end(), other.levels_[h].begin(), other.levels_[h].end());
+    }
+    compress();
+}
+
+double KllSketch::quantile(double q) const {
+    if (n_ == 0) return 0.0;
+    if (q <= 0.0) return min_;
+    if (q >= 1.0) return max_;
+
+    std::vector<std::pair<double, std::uint64_t>> weighted;
+    weighted.reserve(retained());
+    for (std::size_t h = 0; h < levels_.size(); ++h) {
+        for (double v : levels_[h]) weighted.emplace_back(v, std::uint64_t(1) << h);
+    }
+    std::sort(weighted.begin(), weighted.end());
+
+    const double target = q * static_cast<double>(n_);
+    std::uint64_t cumulative = 0;
+    for (const auto& item : weighted) {
+        cumulative += item.second;
+        if (static_cast<double>(cumulative) >= target) return item.first;
+    }
+    return max_;
+}
+
+void KllSketch::serialize(std::vector<std::uint8_t>& out) const {
+    put<std::int32_t>(out, k_);
+    put<std::uint64_t>(out, n_);
+    put<double>(out, min_);
+    put<double>(out, max_);
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(levels_.size()));
+    for (const auto& level : levels_) {
+        put<std::uint32_t>(out, static_cast<std::uint32_t>(level.size()));
+        for (double v : level) put<double>(out, v);
+    }
+}
+
+bool KllSketch::deserialize(const std::uint8_t*& p, const std::uint8_t* end) {
+    std::int32_t k;
+    std::uint32_t levels;
+    if (!get(p, end, k) || !get(p, end, n_) || !get(p, end, min_) || !get(p, end, max_) || !get(p, end, levels)) {
+        return false;
+    }
+    k_ = std::max(static_cast<int>(MIN_LEVEL_CAPACITY), static_cast<int>(k));
+    levels_.clear();
+    for (std::uint32_t h = 0; h < std::max(levels, 1u); ++h) addLevel();
+    for (std::uint32_t h = 0; h < levels; ++h) {
+        std::uint32_t size;
+        if (!get(p, end, size)) return false;
+        for (std::uint32_t i = 0; i < size; ++i) {
+            double v;
+            if (!get(p, end, v)) return false;
+            levels_[h].push_back(v);
+        }
+    }
+    return true;
+}
+
+/* ---------- YieldAnalytics ---------- */
+
+void YieldAnalytics::record(const Task& wafer, int t) {
+    RecipeStats& stats = recipes_.try_emplace(wafer.recipe).first->second;   // allocates for a recipe's first wafer only
+
+    const double energy = wafer.totalEnergy();
+    const double cycle = t - wafer.releasedMinute;
+    const bool interrupted = std::any_of(wafer.phase.begin(), wafer.phase.end(),
+                                         [](const Task::PhaseInfo& p) { return p.wasInterrupted; });
+    stats.completed++;
+    if (wafer.failed()) stats.defective++;
+    if (interrupted)    stats.interrupted++;
+    stats.energySum += energy;
+    stats.cycleSum  += cycle;
+    stats.energy.add(energy);
+    stats.cycle.add(cycle);
+}
+
+void YieldAnalytics::merge(const YieldAnalytics& other) {
+    for (const auto& [recipe, theirs] : other.recipes_) {
+        RecipeStats& ours = recipes_[recipe];
+        ours.completed   += theirs.completed;
+        ours.defective   += theirs.defective;
+        ours.interrupted += theirs.interrupted;
+        ours.energySum   += theirs.energySum;
+        ours.cycleSum    += theirs.cycleSum;
+        ours.energy.merge(theirs.energy);
+        ours.cycle.merge(theirs.cycle);
+    }
+}
+
+void YieldAnalytics::report(std::ostream& out, long long minutesSimulated) const {
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << "\nRecipe | Wafers | Yield % | Interrupted % | Wafers/day | Energy/wafer (W·min) mean p50 p90 p99"
+        << " | Cycle time (min) mean p50 p90 p99\n"
+        << std::fixed << std::setprecision(1);
+
+    std::size_t retained = 0;
+    std::uint64_t wafers = 0;
+    for (const auto& [recipe, s] : recipes_) {
+        const double n = static_cast<double>(std::max<std::uint64_t>(1, s.completed));
+        out << recipe << " | " << s.completed << " | " << 100.0 * s.yield()
+            << " | " << 100.0 * static_cast<double>(s.interrupted) / n
+            << " | " << (minutesSimulated > 0 ? static_cast<double>(s.completed) * 1440.0 / static_cast<double>(minutesSimulated) : 0.0)
+            << " | " << s.energySum / n << " " << s.energy.quantile(0.5) << " " << s.energy.quantile(0.9) << " " << s.energy.quantile(0.99)
+            << " | " << s.cycleSum / n << " " << s.cycle.quantile(0.5) << " " << s.cycle.quantile(0.9) << " " << s.cycle.quantile(0.99)
+            << "\n";
+        retained += s.energy.retained() + s.cycle.retained();
+        wafers += s.completed;
+    }
+    out << "Quantile sketches: " << retained << " values retained for " << wafers << " wafers\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void YieldAnalytics::serialize(std::vector<std::uint8_t>& out) const {
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(recipes_.size()));
+    for (const auto& [recipe, s] : recipes_) {
+        put<std::uint32_t>(out, static_cast<std::uint32_t>(recipe.size()));
+        out.insert(out.end(), recipe.begin(), recipe.end());
+        put<std::uint64_t>(out, s.completed);
+        put<std::uint64_t>(out, s.defective);
+        put<std::uint64_t>(out, s.interrupted);
+        put<double>(out, s.energySum);
+        put<double>(out, s.cycleSum);
+        s.energy.serialize(out);
+        s.cycle.serialize(out);
+    }
+}
+
+bool YieldAnalytics::deserialize(const std::vector<std::uint8_t>& blob) {
+    const std::uint8_t* p = blob.data();
+    const std::uint8_t* end = blob.data() + blob.size();
+    std::uint32_t count;
+    if (!get(p, end, count)) return false;
+
+    YieldAnalytics incoming;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::uint32_t length;
+        if (!get(p, end, length) || static_cast<std::size_t>(end - p) < length) return false;
+        const std::string recipe(reinterpret_cast<const char*>(p), length);
+        p += length;
+        RecipeStats& s = incoming.recipes_[recipe];
+        if (!get(p, end, s.completed) || !get(p, end, s.defective) || !get(p, end, s.interrupted) ||
+            !get(p, end, s.energySum) || !get(p, end, s.cycleSum) ||
+            !s.energy.deserialize(p, end) || !s.cycle.deserialize(p, end)) {
+            return false;
+        }
+    }
+    merge(incoming);
+    return true;
+}
+
+}  // namespace analytics
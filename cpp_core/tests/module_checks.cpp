@@ -0,0 +1,396 @@
+/** Module-level checks, run by ctest
+ *
+ *   wafermap.nonuniform   — a radial (non-flat) deposition profile leaves a non-zero
+ *                           thickness non-uniformity; a flat one leaves none
+ *   wafermap.contamination — a wafer deposited under the station's shield (FluxMap::fromShield)
+ *                           collects contamination: cells above the limit and a defect chance
+ *                           above the base one; a flux without the shield collects none
+ *   deposition.fastforward — for the same seed, a carrier jumped with fastForward() reaches the
+ *                           same completion minute, defect minute and film as update() per minute
+ *   ion.dosekept          — a wafer resumed from several beam trips adds the dose it carried into
+ *                           its last resume to ImplantStats::doseKept once, not once per trip
+ *   line.failed           — a wafer defective only in crystal growth, or scrapped, counts against
+ *                           yield and cancels the wafers its lot gates on it
+ *   faults.chambertarget  — a chamber fault without target= is rejected; the report shows the
+ *                           repair time as parsed
+ *   journal.realparam     — a double param (fault mtbf / repair) comes back bit-exact from a
+ *                           recorded journal
+ *   usage.lockwait        — a registered thread blocked on a held ProfiledMutex reports the wait
+ *                           as LockWait in every build, not only SPACEFORGE_PROFILE_LOCKS ones
+ *   crystal.eclipse       — under PausePolicy::Eclipse one wafer grows no minute in eclipse
+ *                           (t % 90 >= 45), reheats only in sunlight, and still finishes
+ *
+ * Each check prints PASS / FAIL with the values it compared; the exit code is the
+ * number of failed checks.
+ *
+ * Run command:
+ *    ./module_checks
+ */
+
+#include "CrystalGrowthModule.hpp"
+#include "DefectModel.hpp"
+#include "DepositionModule.hpp"
+#include "FaultInjector.hpp"
+#include "IonImplantationModule.hpp"
+#include "Journal.hpp"
+#include "Logger.hpp"
+#include "PowerBus.hpp"
+#include "StageQueue.hpp"
+#include "TaskGraph.hpp"
+#include "Task.hpp"
+#include "ThreadUsage.hpp"
+#include "WaferMap.hpp"
+#include "YieldAnalytics.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+namespace {
+
+int failures = 0;
+
+// swallows the modules' std::cout chatter
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c == EOF ? 0 : c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+void check(const std::string& name, bool ok, const std::string& detail) {
+    std::cout << (ok ? "PASS " : "FAIL ") << name << " | " << detail << "\n";
+    if (!ok) failures++;
+}
+
+WaferMapStats depositMinutes(const FluxMap& flux, int minutes) {
+    WaferMap map{};
+    for (int m = 0; m < minutes; ++m) wafermap::accumulateMinute(map, flux, 15.0f, true);
+    return wafermap::summarize(map);
+}
+
+void checkWaferMapNonUniformity() {
+    const WaferMapStats flat = depositMinutes(FluxMap::uniform(), 60);
+    const WaferMapStats radial = depositMinutes(FluxMap::radial(), 60);
+    const WaferMapStats traced = depositMinutes(FluxMap::fromTrace(wake::TraceResult{}), 60);
+
+    check("wafermap.nonuniform/flat", flat.nonUniformity < 1e-6,
+          "nonUniformity " + std::to_string(flat.nonUniformity));
+    check("wafermap.nonuniform/radial", radial.nonUniformity > 0.01,
+          "nonUniformity " + std::to_string(radial.nonUniformity));
+    check("wafermap.nonuniform/trace", traced.nonUniformity > 0.01,
+          "nonUniformity " + std::to_string(traced.nonUniformity));
+    // the profile is relative: the radial map deposits the same mean film as the flat one
+    check("wafermap.nonuniform/mean", std::fabs(radial.meanThickness - flat.meanThickness) < 1e-3 * flat.meanThickness,
+          "mean " + std::to_string(radial.meanThickness) + " vs " + std::to_string(flat.meanThickness) + " nm");
+}
+
+// what one wafer's deposition phase came to
+struct PhaseOutcome {
+    int completedAt = -1;   // minute of the last powered minute
+    int defectAt = -1;      // minute the defect was marked (-1 ⇒ none)
+    double thickness = 0.0;
+    double nonUniformity = 0.0;
+    int contaminatedCells = 0;
+};
+
+/// One wafer through a calibrating chamber on an unlimited bus; `jump` ⇒ fastForward() once calibrated.
+PhaseOutcome runPhase(std::uint64_t seed, bool jump, const FluxMap& flux, Logger& logger) {
+    ChamberConfig config;
+    config.calibrationMinutes = 3;
+    StageQueue queue;
+    Task wafer;
+    wafer.id = "check";
+    wafer.phase[0].requiredTime = 60;
+    wafer.phase[0].defectChance = 0.02;
+    queue.push(&wafer);
+
+    WaferMapArena arena(1);
+    DepositionModule chamber(0, &queue, config);
+    chamber.seedDefects(seed);
+    chamber.attachWaferMaps(&arena, &flux);
+    PowerModule power(250000, 10000, 10000);
+    ProfiledMutex powerMutex("power_mutex");
+    std::atomic<int> orbitState(0);
+
+    PhaseOutcome out;
+    for (int t = 0; t < 200;) {
+        power.update(t, "sunlight");
+        const bool running = chamber.carrierLoad() > 0 && !chamber.isCalibrating() && !chamber.hasCompletedTask();
+        if (jump && running) {
+            const int n = chamber.fastForward(1000);
+            if (wafer.phase[0].defective && out.defectAt < 0) out.defectAt = t + n - 1;
+            if (wafer.phase[0].isDone()) out.completedAt = t + n - 1;
+            t += n;
+            continue;
+        }
+        chamber.update(t, power, logger, &powerMutex, &orbitState);
+        if (running && wafer.phase[0].defective && out.defectAt < 0) out.defectAt = t;
+        if (running && wafer.phase[0].isDone() && out.completedAt < 0) out.completedAt = t;
+        if (out.completedAt >= 0 && chamber.carrierLoad() == 0) break;   // unloaded: the map is summarised
+        ++t;
+    }
+    out.thickness = wafer.phase[0].meanThickness;
+    out.nonUniformity = wafer.phase[0].nonUniformity;
+    out.contaminatedCells = wafer.phase[0].contaminatedCells;
+    return out;
+}
+
+void checkFastForwardEquivalence() {
+    namespace fs = std::filesystem;
+    const fs::path scratch = fs::temp_directory_path() / "spaceforge_module_checks";
+    fs::create_directories(scratch / "debugLogs");   // runOneMinute appends there
+    const fs::path cwd = fs::current_path();
+    fs::current_path(scratch);
+    NullBuffer nullBuffer;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&nullBuffer);
+
+    const FluxMap flux = FluxMap::radial();
+    Logger logger((scratch / "log.csv").string());
+    int mismatches = 0, defects = 0;
+    std::string first;
+    for (std::uint64_t seed = 1; seed <= 100; ++seed) {
+        const PhaseOutcome stepped = runPhase(seed, false, flux, logger);
+        const PhaseOutcome jumped  = runPhase(seed, true, flux, logger);
+        defects += stepped.defectAt >= 0;
+        const bool same = stepped.completedAt > 0 && stepped.thickness > 0.0 &&
+                          stepped.completedAt == jumped.completedAt && stepped.defectAt == jumped.defectAt &&
+                          std::fabs(stepped.thickness - jumped.thickness) <= 1e-4 * stepped.thickness &&
+                          std::fabs(stepped.nonUniformity - jumped.nonUniformity) <= 1e-4;
+        if (!same && mismatches++ == 0) {
+            first = "seed " + std::to_string(seed) + ": completed " + std::to_string(stepped.completedAt) + " vs " +
+                    std::to_string(jumped.completedAt) + ", defect " + std::to_string(stepped.defectAt) + " vs " +
+                    std::to_string(jumped.defectAt) + ", " + std::to_string(stepped.thickness) + " vs " +
+                    std::to_string(jumped.thickness) + " nm";
+        }
+    }
+
+    std::cout.rdbuf(coutBuffer);
+    fs::current_path(cwd);
+    check("deposition.fastforward", mismatches == 0 && defects > 0,
+          std::to_string(mismatches) + "/100 seeds differ, " + std::to_string(defects) + " with a defect" +
+          (first.empty() ? "" : "; first: " + first));
+}
+
+void checkShieldContamination() {
+    namespace fs = std::filesystem;
+    const fs::path scratch = fs::temp_directory_path() / "spaceforge_module_checks";
+    fs::create_directories(scratch / "debugLogs");   // runOneMinute appends there
+    const fs::path cwd = fs::current_path();
+    fs::current_path(scratch);
+    NullBuffer nullBuffer;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&nullBuffer);
+
+    const FluxMap shielded = FluxMap::fromShield();
+    Logger logger((scratch / "log.csv").string());
+    const PhaseOutcome underShield = runPhase(1, false, shielded, logger);
+    const PhaseOutcome unshielded = runPhase(1, false, FluxMap::radial(), logger);
+
+    std::cout.rdbuf(coutBuffer);
+    fs::current_path(cwd);
+    const double base = 0.02;   // runPhase's defectChance
+    const double chance = FluxHazard(base, wafermap::meanContamination(shielded)).probability(0);
+    check("wafermap.contamination", underShield.completedAt > 0 && underShield.contaminatedCells > 0 &&
+                                    unshielded.contaminatedCells == 0 && chance > base,
+          std::to_string(underShield.contaminatedCells) + " cells under the shield vs " +
+          std::to_string(unshielded.contaminatedCells) + " without, defect chance " + std::to_string(chance) +
+          " per minute vs base " + std::to_string(base));
+}
+
+void checkIonDoseKept() {
+    namespace fs = std::filesystem;
+    const fs::path scratch = fs::temp_directory_path() / "spaceforge_module_checks";
+    fs::create_directories(scratch);
+    NullBuffer nullBuffer;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&nullBuffer);
+
+    StageQueue queue;
+    Task wafer;
+    wafer.id = "check";
+    queue.push(&wafer);
+    IonImplantationModule implanter(&queue);
+    implanter.seed(1);
+    Logger logger((scratch / "ion_log.csv").string());
+    PowerModule power(250000, 10000, 10000);
+    ProfiledMutex powerMutex("power_mutex");
+    std::atomic<int> orbitState(0);
+
+    // trip the beam every 5 beam minutes: both trips the wafer may resume from, then it finishes
+    double doseAtLastTrip = 0.0;
+    int trips = 0;
+    for (int t = 0; t < 200 && implanter.implantStats().completed == 0; ++t) {
+        power.update(t, "sunlight");
+        implanter.update(t, power, logger, &powerMutex, &orbitState);
+        const int beamMinutes = implanter.implantStats().beamMinutes;
+        if (trips < implanter.implantConfig().maxRetries && beamMinutes == 5 * (trips + 1)) {
+            doseAtLastTrip = wafer.phase[1].dose;
+            implanter.setDown(true);
+            implanter.setDown(false);
+            trips++;
+        }
+    }
+    std::cout.rdbuf(coutBuffer);
+
+    const ImplantStats& stats = implanter.implantStats();
+    check("ion.dosekept", stats.completed == 1 && stats.resumed == 2 && doseAtLastTrip > 0.0 &&
+                          std::fabs(stats.doseKept - doseAtLastTrip) <= 1e-9 * doseAtLastTrip &&
+                          stats.doseKept <= stats.doseDelivered,
+          std::to_string(stats.resumed) + " resumes, kept " + std::to_string(stats.doseKept) + " vs " +
+          std::to_string(doseAtLastTrip) + " carried, " + std::to_string(stats.doseDelivered) + " delivered");
+}
+
+void checkLineFailures() {
+    Task good, grownBad, scrapped, gated;
+    good.id = "good";
+    grownBad.id = "grownBad";
+    grownBad.phase[2].defective = true;   // passed deposition and implantation
+    scrapped.id = "scrapped";
+    scrapped.scrapped = true;
+    gated.id = "gated";
+    gated.lot = grownBad.lot = "L";
+    gated.after = {"grownBad"};
+
+    analytics::YieldAnalytics yield;
+    for (const Task* wafer : {&good, &grownBad, &scrapped}) yield.record(*wafer, 10);
+    const analytics::RecipeStats& stats = yield.recipes().at("default");
+
+    lots::TaskGraph graph;
+    std::string error;
+    const bool built = graph.build({&good, &grownBad, &scrapped, &gated}, error);
+    std::vector<Task*> released;
+    graph.complete(&grownBad, 10, released);
+
+    check("line.failed", stats.completed == 3 && stats.defective == 2 && built && released.empty(),
+          std::to_string(stats.defective) + "/" + std::to_string(stats.completed) + " defective, " +
+          std::to_string(released.size()) + " released behind a failed wafer" + (built ? "" : "; " + error));
+}
+
+void checkChamberFaultTarget() {
+    namespace fs = std::filesystem;
+    const fs::path path = fs::temp_directory_path() / "module_checks_faults.txt";
+    const auto load = [&](const std::string& text, std::vector<faults::FaultSpec>& specs, std::string& error) {
+        std::ofstream(path) << text << "\n";
+        return faults::loadSpecs(path.string(), specs, error);
+    };
+    std::vector<faults::FaultSpec> untargeted, targeted;
+    std::string untargetedError, targetedError;
+    const bool untargetedLoaded = load("kind=chamber at=5 repair=10", untargeted, untargetedError);
+    const bool targetedLoaded = load("kind=chamber target=0 at=5 repair=40.5", targeted, targetedError);
+    fs::remove(path);
+
+    std::ostringstream report;
+    if (targetedLoaded) faults::FaultInjector(targeted, 1).report(report, 100);
+    check("faults.chambertarget", !untargetedLoaded && targetedLoaded && report.str().find("| 40.5 |") != std::string::npos,
+          std::string("untargeted ") + (untargetedLoaded ? "accepted" : "rejected (" + untargetedError + ")") +
+          ", targeted " + (targetedLoaded ? "loaded" : "rejected (" + targetedError + ")"));
+}
+
+void checkJournalRealParam() {
+    namespace fs = std::filesystem;
+    const std::string path = (fs::temp_directory_path() / "module_checks_journal.sfj").string();
+    const double values[] = {300.7, 0.1, 1.0 / 3.0, 0.0};
+    journal::RunInputs inputs;
+    for (std::size_t i = 0; i < 4; ++i) inputs.setRealParam("real" + std::to_string(i), values[i]);
+    {
+        journal::Journal recording;
+        recording.startRecording(path, inputs);
+        recording.close();
+    }
+    journal::Journal replay;
+    const bool loaded = replay.loadReplay(path);
+    int exact = 0;
+    for (std::size_t i = 0; i < 4; ++i) exact += replay.inputs().realParam("real" + std::to_string(i), -1.0) == values[i];
+    fs::remove(path);
+    check("journal.realparam", loaded && exact == 4,
+          std::string(loaded ? "loaded" : "not loaded") + ", " + std::to_string(exact) + "/4 bit-exact");
+}
+
+void checkLockWait() {
+    ProfiledMutex mutex("check");
+    std::atomic<bool> started(false);
+    mutex.lock();
+    std::thread waiter([&]() {
+        usage::beginThread("lockwait.check");
+        started = true;
+        std::lock_guard<ProfiledMutex> lock(mutex);
+        usage::endThread();
+    });
+    while (!started) std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));   // the waiter is blocked by now
+    mutex.unlock();
+    waiter.join();
+
+    const std::vector<usage::ThreadStats> threads = usage::threads();
+    const auto waiterStats = std::find_if(threads.begin(), threads.end(),
+                                          [](const usage::ThreadStats& th) { return th.name == "lockwait.check"; });
+    const std::uint64_t waited = waiterStats == threads.end() ? 0 : waiterStats->lockWaitNs;
+    check("usage.lockwait", waited >= 5'000'000, "waited " + std::to_string(waited / 1000) + " us of ~20000");
+}
+
+void checkCrystalEclipsePause() {
+    namespace fs = std::filesystem;
+    const fs::path scratch = fs::temp_directory_path() / "spaceforge_module_checks";
+    fs::create_directories(scratch);
+    NullBuffer nullBuffer;
+    std::streambuf* coutBuffer = std::cout.rdbuf(&nullBuffer);
+
+    StageQueue queue;
+    Task wafer;
+    wafer.id = "check";
+    wafer.phase[2].requiredTime = 120;
+    queue.push(&wafer);
+    GrowthConfig config;
+    config.policy = PausePolicy::Eclipse;
+    CrystalGrowthModule furnace(&queue, config);
+    furnace.seed(1);
+    Logger logger((scratch / "crystal_log.csv").string());
+    PowerModule power(250000, 300, 0);   // main's bus: the battery carries the eclipse hold
+    ProfiledMutex powerMutex("power_mutex");
+    std::atomic<int> orbitState(0);
+
+    // step the orbit as main does until the wafer is grown (120 minutes span several orbits)
+    int eclipseGrowth = 0, eclipseReheat = 0, lastGrowth = -1;
+    for (int t = 0; t < 10 * 90 && furnace.growthStats().completed == 0; ++t) {
+        const bool eclipse = t % 90 >= config.sunlightMinutes;
+        orbitState.store(eclipse ? 1 : 0);
+        power.update(t, eclipse ? "eclipse" : "sunlight");
+        const GrowthStats before = furnace.growthStats();
+        furnace.update(t, power, logger, &powerMutex, &orbitState);
+        const GrowthStats& after = furnace.growthStats();
+        if (after.growthMinutes > before.growthMinutes) {
+            lastGrowth = t;
+            eclipseGrowth += eclipse;
+        }
+        eclipseReheat += eclipse && after.reheatMinutes > before.reheatMinutes;
+    }
+    std::cout.rdbuf(coutBuffer);
+
+    const GrowthStats& stats = furnace.growthStats();
+    check("crystal.eclipse", stats.completed == 1 && stats.growthMinutes == 120 && eclipseGrowth == 0 && eclipseReheat == 0,
+          std::to_string(eclipseGrowth) + " growth and " + std::to_string(eclipseReheat) + " reheat minutes in eclipse, " +
+          std::to_string(stats.pauses) + " pauses, last growth minute " + std::to_string(lastGrowth) +
+          (stats.completed ? "" : ", not finished"));
+}
+
+}  // namespace
+
+int main() {
+    checkWaferMapNonUniformity();
+    checkShieldContamination();
+    checkFastForwardEquivalence();
+    checkIonDoseKept();
+    checkLineFailures();
+    checkChamberFaultTarget();
+    checkJournalRealParam();
+    checkLockWait();
+    checkCrystalEclipsePause();
+    std::cout << (failures ? std::to_string(failures) + " check(s) failed\n" : std::string("all checks passed\n"));
+    return failures;
+}
@@ -0,0 +1,35 @@
+"""
+export_grids.py - dump the per-scene wafer grids from grids_mc{N}.parquet to CSV
+
+The native tracer benchmark (cpp_core/bench/tracer_bench.cpp) compares its grids
+against these, but C++ has no parquet reader without pulling in Arrow, so we
+stream the g0000..g2499 columns out to grids_mc{N}.csv once.
+
+usage: python export_grids.py 1 2 3 4 5
+"""
+import sys
+from pathlib import Path
+
+import pyarrow.parquet as pq
+
+DATA_DIR = Path(__file__).parent / "mc_data"
+
+
+def export(run: int) -> None:
+    src = DATA_DIR / f"grids_mc{run}.parquet"
+    dst = DATA_DIR / f"grids_mc{run}.csv"
+    pf = pq.ParquetFile(src)
+    grid_cols = [c for c in pf.schema_arrow.names if c.startswith("g") and c[1:].isdigit()]
+
+    with open(dst, "w") as f:
+        f.write(",".join(grid_cols) + "\n")
+        for batch in pf.iter_batches(columns=grid_cols, batch_size=500):
+            cols = [batch.column(i).to_pylist() for i in range(batch.num_columns)]
+            for row in zip(*cols):
+                f.write(",".join(str(v) for v in row) + "\n")
+    print(f"Wrote {dst}")
+
+
+if __name__ == "__main__":
+    for arg in sys.argv[1:] or ["1"]:
+        export(int(arg))